@@ -0,0 +1,69 @@
+#pragma once
+
+// Replaces the global operator new/delete to count heap allocations. Include
+// it in exactly one source file of a benchmark.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace bench
+{
+
+struct AllocStats
+{
+    size_t allocations = 0; // operator new calls
+    size_t frees = 0;       // operator delete calls
+    size_t bytes = 0;       // Bytes requested by all operator new calls
+    size_t liveBytes = 0;   // Bytes allocated and not freed yet
+};
+
+static std::atomic<size_t> g_allocations{0};
+static std::atomic<size_t> g_frees{0};
+static std::atomic<size_t> g_bytes{0};
+static std::atomic<size_t> g_liveBytes{0};
+
+inline AllocStats Snapshot()
+{
+    AllocStats stats;
+    stats.allocations = g_allocations.load();
+    stats.frees = g_frees.load();
+    stats.bytes = g_bytes.load();
+    stats.liveBytes = g_liveBytes.load();
+    return stats;
+}
+
+// Every block starts with its size, padded to keep the alignment of malloc.
+static const size_t kHeaderSize = alignof(std::max_align_t);
+
+inline void* Allocate(size_t size)
+{
+    char* block = static_cast<char*>(std::malloc(size + kHeaderSize));
+    if (!block)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+    g_allocations++;
+    g_bytes += size;
+    g_liveBytes += size;
+    return block + kHeaderSize;
+}
+
+inline void Free(void* p)
+{
+    if (!p)
+        return;
+    char* block = static_cast<char*>(p) - kHeaderSize;
+    g_frees++;
+    g_liveBytes -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+} // namespace bench
+
+void* operator new(size_t size) { return bench::Allocate(size); }
+void* operator new[](size_t size) { return bench::Allocate(size); }
+void operator delete(void* p) noexcept { bench::Free(p); }
+void operator delete[](void* p) noexcept { bench::Free(p); }
+void operator delete(void* p, size_t) noexcept { bench::Free(p); }
+void operator delete[](void* p, size_t) noexcept { bench::Free(p); }
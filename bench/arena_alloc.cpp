@@ -0,0 +1,135 @@
+// Heap allocations of loading and freeing a large scene, with the Model
+// allocated from the heap and from a tinygltf::Arena.
+//
+// Build from this directory. tinygltf needs the same TINYGLTF_USE_ARENA flag,
+// adding TINYGLTF_COMPACT_NODE keeps the node transforms off the heap too:
+//   g++ -std=c++11 -O2 -DTINYGLTF_USE_ARENA -I../libs arena_alloc.cpp
+//       ../libs/tinygltf/tinygltf.cpp ../libs/tinygltf/stb.cpp -lpthread
+//       -o arena_alloc
+//
+// Usage: arena_alloc [node count, default 100000]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+#include "alloc_counter.hpp"
+
+#ifndef TINYGLTF_USE_ARENA
+#error "Build with -DTINYGLTF_USE_ARENA"
+#endif
+
+// A scene of `nodeCount` named nodes with transforms and extras, sharing 100
+// meshes with a few attributes each.
+static std::string MakeScene(int nodeCount)
+{
+    const int meshCount = 100;
+    std::string json;
+    json += "{\"asset\":{\"version\":\"2.0\"},";
+    // One triangle, all zero.
+    json += "\"buffers\":[{\"byteLength\":36,\"uri\":\"data:application/"
+            "octet-stream;base64,AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+            "AAAA\"}],";
+    json += "\"bufferViews\":[{\"buffer\":0,\"byteLength\":36}],";
+    json += "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,"
+            "\"count\":3,\"type\":\"VEC3\"}],";
+
+    json += "\"meshes\":[";
+    for (int i = 0; i < meshCount; ++i)
+    {
+        if (i)
+            json += ",";
+        json += "{\"name\":\"mesh_" + std::to_string(i) + "_level_of_detail_0\","
+                "\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":0,"
+                "\"TEXCOORD_0\":0,\"_BATCH_ID\":0}}]}";
+    }
+    json += "],";
+
+    json += "\"nodes\":[";
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (i)
+            json += ",";
+        json += "{\"name\":\"scene_root/group_" + std::to_string(i / 100) +
+                "/node_" + std::to_string(i) + "\",\"mesh\":" +
+                std::to_string(i % meshCount) +
+                ",\"translation\":[1,2,3],\"rotation\":[0,0,0,1],"
+                "\"extras\":{\"id\":" + std::to_string(i) +
+                ",\"layer\":\"background_geometry\",\"tags\":[\"static\","
+                "\"shadow_caster\"],\"lod\":{\"distance\":25.5}}}";
+    }
+    json += "],";
+
+    json += "\"scenes\":[{\"nodes\":[";
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (i)
+            json += ",";
+        json += std::to_string(i);
+    }
+    json += "]}],\"scene\":0}";
+    return json;
+}
+
+static double Milliseconds(std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static bool Run(const std::string& json, bool useArena)
+{
+    tinygltf::Arena arena;
+    tinygltf::TinyGLTF loader;
+    loader.SetArena(useArena ? &arena : nullptr);
+    std::unique_ptr<tinygltf::Model> model(new tinygltf::Model);
+    std::string err;
+    std::string warn;
+
+    const bench::AllocStats before = bench::Snapshot();
+    const auto start = std::chrono::steady_clock::now();
+    if (!loader.LoadASCIIFromString(model.get(), &err, &warn, json.data(),
+                                    static_cast<unsigned int>(json.size()), ""))
+    {
+        std::printf("load failed: %s\n", err.c_str());
+        return false;
+    }
+    const auto loadedTime = std::chrono::steady_clock::now();
+    const bench::AllocStats loaded = bench::Snapshot();
+
+    model.reset();
+    arena.Release();
+    const auto freedTime = std::chrono::steady_clock::now();
+    const bench::AllocStats freed = bench::Snapshot();
+
+    // Heap blocks which the loaded Model held, i.e. the frees of its teardown.
+    const size_t held = (loaded.allocations - loaded.frees) -
+                        (before.allocations - before.frees);
+    std::printf("%-6s load: %9zu allocations %8.1f MB %8.1f ms | "
+                "model holds %8zu blocks | teardown: %8zu frees %7.1f ms\n",
+                useArena ? "arena" : "heap",
+                loaded.allocations - before.allocations,
+                double(loaded.bytes - before.bytes) / (1024.0 * 1024.0),
+                Milliseconds(start, loadedTime), held,
+                freed.frees - loaded.frees, Milliseconds(loadedTime, freedTime));
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const int nodeCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const std::string json = MakeScene(nodeCount);
+    std::printf("%d nodes, %.1f MB of JSON\n", nodeCount,
+                double(json.size()) / (1024.0 * 1024.0));
+
+    // Each mode runs twice, the first run warms up the allocator.
+    for (int round = 0; round < 2; ++round)
+    {
+        if (!Run(json, false) || !Run(json, true))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+// Memory held by the extras and extensions Value trees of a Model, compared
+// with the layout Value had before it became a tagged union (all members side
+// by side).
+//
+// Build from this directory:
+//   g++ -std=c++11 -O2 -I../libs value_memory.cpp ../libs/tinygltf/tinygltf.cpp
+//       ../libs/tinygltf/stb.cpp -lpthread -o value_memory
+//
+// Usage: value_memory [file.gltf|file.glb ...]
+// Without arguments a scene of 20000 nodes with heavy extras is generated.
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+#include "alloc_counter.hpp"
+
+// The members of tinygltf::Value before the tagged union.
+struct LegacyValue
+{
+    int type = 0;
+    int intValue = 0;
+    double realValue = 0.0;
+    std::string stringValue;
+    std::vector<unsigned char> binaryValue;
+    std::vector<LegacyValue> arrayValue;
+    std::map<std::string, LegacyValue> objectValue;
+    bool booleanValue = false;
+};
+
+static void ToLegacy(const tinygltf::Value& value, LegacyValue* out)
+{
+    out->type = value.Type();
+    switch (value.Type())
+    {
+    case tinygltf::BOOL_TYPE:
+        out->booleanValue = value.Get<bool>();
+        break;
+    case tinygltf::INT_TYPE:
+        out->intValue = value.Get<int>();
+        break;
+    case tinygltf::REAL_TYPE:
+        out->realValue = value.Get<double>();
+        break;
+    case tinygltf::STRING_TYPE:
+        out->stringValue = value.Get<std::string>();
+        break;
+    case tinygltf::BINARY_TYPE:
+        out->binaryValue = value.Get<std::vector<unsigned char>>();
+        break;
+    case tinygltf::ARRAY_TYPE:
+        out->arrayValue.resize(value.ArrayLen());
+        for (size_t i = 0; i < value.ArrayLen(); ++i)
+            ToLegacy(value.Get(int(i)), &out->arrayValue[i]);
+        break;
+    case tinygltf::OBJECT_TYPE:
+        for (const auto& member : value.Get<tinygltf::Value::Object>())
+            ToLegacy(member.second, &out->objectValue[member.first]);
+        break;
+    default:
+        break;
+    }
+}
+
+static size_t CountValues(const tinygltf::Value& value)
+{
+    size_t count = 1;
+    if (value.IsArray())
+    {
+        for (const tinygltf::Value& v : value.Get<tinygltf::Value::Array>())
+            count += CountValues(v);
+    }
+    else if (value.IsObject())
+    {
+        for (const auto& member : value.Get<tinygltf::Value::Object>())
+            count += CountValues(member.second);
+    }
+    return count;
+}
+
+template <typename T>
+static void CollectValues(const std::vector<T>& items,
+                          std::vector<const tinygltf::Value*>* values)
+{
+    for (const T& item : items)
+    {
+        values->push_back(&item.extras);
+        for (const auto& extension : item.extensions)
+            values->push_back(&extension.second);
+    }
+}
+
+static std::vector<const tinygltf::Value*> CollectValues(
+    const tinygltf::Model& model)
+{
+    std::vector<const tinygltf::Value*> values;
+    values.push_back(&model.extras);
+    for (const auto& extension : model.extensions)
+        values.push_back(&extension.second);
+    CollectValues(model.accessors, &values);
+    CollectValues(model.animations, &values);
+    CollectValues(model.buffers, &values);
+    CollectValues(model.bufferViews, &values);
+    CollectValues(model.materials, &values);
+    CollectValues(model.meshes, &values);
+    CollectValues(model.nodes, &values);
+    CollectValues(model.textures, &values);
+    CollectValues(model.images, &values);
+    CollectValues(model.skins, &values);
+    CollectValues(model.samplers, &values);
+    CollectValues(model.cameras, &values);
+    CollectValues(model.scenes, &values);
+    CollectValues(model.lights, &values);
+    return values;
+}
+
+static std::string MakeScene(int nodeCount)
+{
+    std::string json = "{\"asset\":{\"version\":\"2.0\"},\"nodes\":[";
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (i)
+            json += ",";
+        json += "{\"name\":\"node_" + std::to_string(i) +
+                "\",\"extras\":{\"id\":" + std::to_string(i) +
+                ",\"guid\":\"3f2a9c4e-1b7d-4e8f-a6c2-" +
+                std::to_string(100000000000LL + i) +
+                "\",\"visible\":true,\"weight\":0.5,"
+                "\"tags\":[\"static\",\"shadow_caster\",\"lod0\"],"
+                "\"bounds\":{\"min\":[-1.5,0,-1.5],\"max\":[1.5,3,1.5]},"
+                "\"metadata\":{\"author\":\"pipeline\",\"revision\":12,"
+                "\"source\":\"//depot/assets/props/crate_large.fbx\"}}}";
+    }
+    json += "],\"scenes\":[{\"nodes\":[0]}],\"scene\":0}";
+    return json;
+}
+
+static bool Load(tinygltf::Model* model, const std::string& file,
+                 const std::string& json)
+{
+    tinygltf::TinyGLTF loader;
+    std::string err;
+    std::string warn;
+    bool ok;
+    if (file.empty())
+        ok = loader.LoadASCIIFromString(model, &err, &warn, json.data(),
+                                        static_cast<unsigned int>(json.size()),
+                                        "");
+    else if (file.size() > 4 && file.compare(file.size() - 4, 4, ".glb") == 0)
+        ok = loader.LoadBinaryFromFile(model, &err, &warn, file);
+    else
+        ok = loader.LoadASCIIFromFile(model, &err, &warn, file);
+    if (!ok)
+        std::printf("%s: load failed: %s\n", file.c_str(), err.c_str());
+    return ok;
+}
+
+static double Megabytes(size_t bytes)
+{
+    return double(bytes) / (1024.0 * 1024.0);
+}
+
+static void Report(const std::string& file, const std::string& json)
+{
+    const size_t before = bench::Snapshot().liveBytes;
+    std::unique_ptr<tinygltf::Model> model(new tinygltf::Model);
+    if (!Load(model.get(), file, json))
+        return;
+    const size_t modelBytes = bench::Snapshot().liveBytes - before;
+
+    const std::vector<const tinygltf::Value*> values = CollectValues(*model);
+    size_t count = 0;
+    for (const tinygltf::Value* value : values)
+        count += CountValues(*value);
+
+    // Both layouts are measured as heap allocated copies of every tree.
+    std::vector<std::unique_ptr<tinygltf::Value>> copies;
+    std::vector<std::unique_ptr<LegacyValue>> legacyCopies;
+    copies.reserve(values.size());
+    legacyCopies.reserve(values.size());
+
+    size_t start = bench::Snapshot().liveBytes;
+    for (const tinygltf::Value* value : values)
+        copies.emplace_back(new tinygltf::Value(*value));
+    const size_t valueBytes = bench::Snapshot().liveBytes - start;
+
+    start = bench::Snapshot().liveBytes;
+    for (const tinygltf::Value* value : values)
+    {
+        legacyCopies.emplace_back(new LegacyValue);
+        ToLegacy(*value, legacyCopies.back().get());
+    }
+    const size_t legacyBytes = bench::Snapshot().liveBytes - start;
+
+    std::printf("%s\n", file.empty() ? "generated scene" : file.c_str());
+    std::printf("  Model: %.2f MB, %zu Values in extras/extensions\n",
+                Megabytes(modelBytes), count);
+    std::printf("  sizeof(Value): %zu bytes, before: %zu bytes\n",
+                sizeof(tinygltf::Value), sizeof(LegacyValue));
+    std::printf("  Value trees: %.2f MB (%.1f%% of the Model), "
+                "before: %.2f MB, %.1f%% saved\n",
+                Megabytes(valueBytes),
+                modelBytes ? 100.0 * double(valueBytes) / double(modelBytes)
+                           : 0.0,
+                Megabytes(legacyBytes),
+                legacyBytes ? 100.0 * (1.0 - double(valueBytes) /
+                                                 double(legacyBytes))
+                            : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        Report("", MakeScene(20000));
+        return 0;
+    }
+    for (int i = 1; i < argc; ++i)
+        Report(argv[i], "");
+    return 0;
+}
@@ -48,44 +48,24 @@ static void CreateShader(unsigned int &id, GLenum type, std::string code){
     return;
 }
 
-std::vector<float> GetAttributeData(tinygltf::Model& model, tinygltf::Primitive& primitive, std::string target){
-
-    tinygltf::BufferView view = model.bufferViews[model.accessors[primitive.attributes.at(target)].bufferView];
-    int byteOffset = view.byteOffset;
-    int byteLength = view.byteLength;
-
-    tinygltf::Buffer buffer = model.buffers[view.buffer];
-
-    std::vector<unsigned char> data;
-    data.resize(buffer.data.size());
-    data = buffer.data;
+std::vector<float> GetAttributeData(const tinygltf::Model& model, const tinygltf::Primitive& primitive, tinygltf::AttributeKey target){
 
     std::vector<float> attributeData;
-    attributeData.resize(byteLength / sizeof(float));
 
-    std::memcpy(attributeData.data(), data.data() + byteOffset, byteLength);
+    // Validated once, then decoded in bulk honouring offset, stride, normalization and sparse values
+    tinygltf::AccessorLayout layout;
+    if (!tinygltf::GetAccessorLayout(model, primitive.attributes.at(target), &layout, nullptr))
+        return attributeData;
+
+    attributeData.resize(layout.count * layout.numComponents);
+    tinygltf::ConvertAccessor(layout, attributeData.data());
 
     return attributeData;
 }
 
-std::vector<unsigned short> GetIndexData(tinygltf::Model& model, tinygltf::Primitive& primitive){
-
-    tinygltf::BufferView view = model.bufferViews[model.accessors[primitive.indices].bufferView];
-    int byteOffset = view.byteOffset;
-    int byteLength = view.byteLength;
+std::vector<unsigned short> GetIndexData(const tinygltf::Model& model, const tinygltf::Primitive& primitive){
 
-    tinygltf::Buffer buffer = model.buffers[view.buffer];
-
-    std::vector<unsigned char> data;
-    data.resize(buffer.data.size());
-    data = buffer.data;
-
-    std::vector<unsigned short> indices;
-    indices.resize(byteLength / sizeof(unsigned short));
-
-    std::memcpy(indices.data(), data.data() + byteOffset, byteLength);
-
-    return indices;
+    return tinygltf::AccessorView<unsigned short>(model, primitive.indices).ToVector();
 }
 
 void CreateGlObjects(glWrap::Primitive &primitive){
@@ -187,7 +167,8 @@ static GLenum GetChannelType(unsigned int channels){
 }
 
 glWrap::Texture2D::Texture2D(std::string image, bool flip, GLenum filter, GLenum desiredChannels){
-    stbi_set_flip_vertically_on_load(flip);
+    // Thread-local so that images decoded on other threads are not flipped.
+    stbi_set_flip_vertically_on_load_thread(flip);
     int width, height, channels;
     unsigned char *data = stbi_load(image.c_str(), &width, &height, &channels, 0);
 
@@ -225,6 +206,9 @@ bool glWrap::loadModel(std::string path, std::vector<std::unique_ptr<Mesh>>& mes
     std::string error{};
     std::string warning{};
 
+    // Ranges and indices are checked once here, so the accessor reads below need no checks of their own
+    loader.SetValidateOnLoad(true);
+
     if (!loader.LoadASCIIFromFile(&model, &error, &warning, "assets/Triangle.gltf"))
     {
         std::cout << error << " | " << warning << '\n';
@@ -243,9 +227,9 @@ bool glWrap::loadModel(std::string path, std::vector<std::unique_ptr<Mesh>>& mes
             meshes.back().get()->m_primitives.push_back(std::make_unique<Primitive>());
             Primitive& prim = *meshes.back().get()->m_primitives.back().get();
 
-            std::vector<float> position = GetAttributeData(model, model.meshes[i].primitives[j], "POSITION");
-            std::vector<float> normal = GetAttributeData(model, model.meshes[i].primitives[j], "NORMAL");
-            std::vector<float> texCoord = GetAttributeData(model, model.meshes[i].primitives[j], "TEXCOORD_0");
+            std::vector<float> position = GetAttributeData(model, model.meshes[i].primitives[j], tinygltf::AttributeKey::POSITION);
+            std::vector<float> normal = GetAttributeData(model, model.meshes[i].primitives[j], tinygltf::AttributeKey::NORMAL);
+            std::vector<float> texCoord = GetAttributeData(model, model.meshes[i].primitives[j], {tinygltf::AttributeKey::TEXCOORD, 0});
 
             int floats = position.size() + normal.size() + texCoord.size();
 
@@ -263,8 +247,8 @@ bool glWrap::loadModel(std::string path, std::vector<std::unique_ptr<Mesh>>& mes
                 vertices[x].nor.x = normal[0 + posLoc];
                 vertices[x].nor.y = normal[1 + posLoc];
                 vertices[x].nor.z = normal[2 + posLoc];
-                vertices[x].tex.x = texCoord[0 + posLoc];
-                vertices[x].tex.y = texCoord[1 + posLoc];
+                vertices[x].tex.x = texCoord[0 + texLoc];
+                vertices[x].tex.y = texCoord[1 + texLoc];
             }
 
             prim.m_indices = GetIndexData(model, model.meshes[i].primitives[j]);
@@ -61,15 +61,32 @@
 #ifndef TINY_GLTF_H_
 #define TINY_GLTF_H_
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>  // std::fabs
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 //Auto-detect C++14 standard version
@@ -77,10 +94,6 @@
 #define TINYGLTF_USE_CPP14
 #endif
 
-#ifndef TINYGLTF_USE_CPP14
-#include <functional>
-#endif
-
 #ifdef __ANDROID__
 #ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
 #include <android/asset_manager.h>
@@ -271,6 +284,264 @@ bool IsDataURI(const std::string &in);
 bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
                    const std::string &in, size_t reqBytes, bool checkSize);
 
+///
+/// Reference counted byte payload.
+///
+/// Copies share the same storage, so copying a Buffer or Image (and therefore
+/// a Model) does not duplicate the bytes. The bytes are either owned (moved in from a
+/// std::vector) or borrowed from memory kept alive by an `owner` object, e.g.
+/// the BIN chunk of a memory-mapped GLB file.
+///
+/// Provides the subset of the std::vector interface used on `Buffer::data` and
+/// `Image::image`.
+/// Non-const accessors detach from shared or borrowed storage (copy-on-write),
+/// so prefer const access when only reading.
+///
+class SharedBytes {
+ public:
+  typedef unsigned char value_type;
+  typedef unsigned char *iterator;
+  typedef const unsigned char *const_iterator;
+
+  SharedBytes() = default;
+  SharedBytes(const std::vector<unsigned char> &v)  // NOLINT
+      : vec_(std::make_shared<std::vector<unsigned char>>(v)) {}
+  SharedBytes(std::vector<unsigned char> &&v)  // NOLINT
+      : vec_(std::make_shared<std::vector<unsigned char>>(std::move(v))) {}
+
+  // Borrow `n` bytes at `p`. `owner` must keep the memory alive.
+  SharedBytes(const unsigned char *p, size_t n,
+              std::shared_ptr<const void> owner)
+      : owner_(std::move(owner)), ptr_(p), size_(n) {}
+
+  DEFAULT_METHODS(SharedBytes)
+
+  size_t size() const { return vec_ ? vec_->size() : size_; }
+  bool empty() const { return size() == 0; }
+
+  const unsigned char *data() const { return vec_ ? vec_->data() : ptr_; }
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + size(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  const unsigned char &operator[](size_t i) const { return data()[i]; }
+  // Like std::vector::at, throws std::out_of_range (or aborts when exceptions
+  // are disabled) if `i` is past the end.
+  const unsigned char &at(size_t i) const {
+    if (i >= size()) {
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+      throw std::out_of_range("tinygltf::SharedBytes::at");
+#else
+      std::abort();
+#endif
+    }
+    return data()[i];
+  }
+
+  unsigned char *data() { return Mutable().data(); }
+  iterator begin() { return data(); }
+  iterator end() { return data() + size(); }
+  unsigned char &operator[](size_t i) { return Mutable()[i]; }
+  unsigned char &at(size_t i) { return Mutable().at(i); }
+
+  void resize(size_t n) { Mutable().resize(n); }
+  void resize(size_t n, unsigned char c) { Mutable().resize(n, c); }
+  void reserve(size_t n) { Mutable().reserve(n); }
+  void push_back(unsigned char c) { Mutable().push_back(c); }
+  void clear() { *this = SharedBytes(); }
+
+  template <typename It>
+  void assign(It first, It last) {
+    *this = SharedBytes(std::vector<unsigned char>(first, last));
+  }
+
+  template <typename It>
+  iterator insert(const_iterator pos, It first, It last) {
+    std::ptrdiff_t offset = pos - cbegin();
+    std::vector<unsigned char> &v = Mutable();
+    std::vector<unsigned char>::iterator it =
+        v.insert(v.begin() + offset, first, last);
+    return v.data() + (it - v.begin());
+  }
+
+  void swap(SharedBytes &other) TINYGLTF_NOEXCEPT {
+    vec_.swap(other.vec_);
+    owner_.swap(other.owner_);
+    std::swap(ptr_, other.ptr_);
+    std::swap(size_, other.size_);
+  }
+
+  // Borrow `n` bytes starting at `offset`, sharing ownership of the storage.
+  SharedBytes Slice(size_t offset, size_t n) const {
+    assert(offset + n <= size());
+    std::shared_ptr<const void> owner =
+        vec_ ? std::shared_ptr<const void>(vec_) : owner_;
+    return SharedBytes(data() + offset, n, std::move(owner));
+  }
+
+  // Copy the bytes out into a std::vector.
+  std::vector<unsigned char> ToVector() const {
+    return std::vector<unsigned char>(begin(), end());
+  }
+
+  // True when the bytes point into memory owned by someone else.
+  bool IsBorrowed() const { return !vec_ && ptr_ != nullptr; }
+
+  bool operator==(const SharedBytes &other) const {
+    return size() == other.size() &&
+           (data() == other.data() || size() == 0 ||
+            std::memcmp(data(), other.data(), size()) == 0);
+  }
+  bool operator!=(const SharedBytes &other) const { return !(*this == other); }
+
+ private:
+  // Returns a uniquely owned vector, copying the bytes if they are shared
+  // with another SharedBytes or borrowed.
+  std::vector<unsigned char> &Mutable() {
+    if (!vec_ || vec_.use_count() != 1) {
+      const SharedBytes &self = *this;
+      vec_ = std::make_shared<std::vector<unsigned char>>(self.begin(),
+                                                          self.end());
+      owner_.reset();
+      ptr_ = nullptr;
+      size_ = 0;
+    }
+    return *vec_;
+  }
+
+  std::shared_ptr<std::vector<unsigned char>> vec_;
+  std::shared_ptr<const void> owner_;
+  const unsigned char *ptr_ = nullptr;
+  size_t size_ = 0;
+};
+
+#ifdef TINYGLTF_USE_ARENA
+///
+/// Monotonic memory arena for Model storage, enabled with TINYGLTF_USE_ARENA.
+///
+/// Loads on a TinyGLTF with SetArena() allocate the Value trees (extras and
+/// extensions), the Primitive attribute maps and the names of the Model from
+/// large blocks of the arena. Freeing that storage is a no-op; the blocks are
+/// given back all at once by Release() or the destructor, so the arena must
+/// outlive the Models loaded into it. A copy of such a Model allocates from
+/// the heap and does not depend on the arena. Allocation is thread-safe.
+///
+class Arena {
+ public:
+  explicit Arena(size_t block_size = 1024 * 1024) : block_size_(block_size) {}
+  ~Arena() { Release(); }
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  ///
+  /// `alignment` must not exceed alignof(std::max_align_t).
+  ///
+  void *Allocate(size_t size, size_t alignment);
+
+  ///
+  /// Give back all blocks. Nothing allocated from the arena may be used
+  /// afterwards.
+  ///
+  void Release();
+
+  /// Bytes handed out by Allocate() since the last Release().
+  size_t BytesUsed() const;
+  /// Blocks taken from the heap since the last Release().
+  size_t NumBlocks() const;
+
+  ///
+  /// The arena which Model storage constructed on the calling thread comes
+  /// from, or nullptr for the heap. TinyGLTF sets it for the duration of a
+  /// load, and ThreadPool::ParallelFor passes it on to its helper tasks.
+  ///
+  static Arena *Current();
+
+  /// Makes `arena` the Current() arena of the thread while in scope.
+  class Scope {
+   public:
+    explicit Scope(Arena *arena) : previous_(Current()) { SetCurrent(arena); }
+    ~Scope() { SetCurrent(previous_); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    Arena *previous_;
+  };
+
+ private:
+  static void SetCurrent(Arena *arena);
+
+  const size_t block_size_;
+  mutable std::mutex mutex_;
+  std::vector<void *> blocks_;
+  char *cursor_ = nullptr;
+  char *end_ = nullptr;
+  size_t bytes_used_ = 0;
+};
+
+///
+/// Allocator of the arena backed Model containers. A container allocates from
+/// the Arena::Current() of the thread which constructed it, or from the heap
+/// if there was none. Moving a container moves its allocator along, copying
+/// one picks the Current() arena again.
+///
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  ArenaAllocator() : arena_(Arena::Current()) {}
+  explicit ArenaAllocator(Arena *arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other)  // NOLINT
+      : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    void *p = arena_ ? arena_->Allocate(n * sizeof(T), alignof(T))
+                     : ::operator new(n * sizeof(T));
+    return static_cast<T *>(p);
+  }
+  void deallocate(T *p, size_t) {
+    if (!arena_) {
+      ::operator delete(p);
+    }
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const {
+    return ArenaAllocator();
+  }
+
+  Arena *arena() const { return arena_; }
+
+ private:
+  Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() == b.arena();
+}
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() != b.arena();
+}
+
+template <typename T>
+using ModelAllocator = ArenaAllocator<T>;
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>
+    NameString;
+#else
+template <typename T>
+using ModelAllocator = std::allocator<T>;
+typedef std::string NameString;
+#endif
+
 #ifdef __clang__
 #pragma clang diagnostic push
 // Suppress warning for : static Value null_value
@@ -279,44 +550,121 @@ bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
 #endif
 
 // Simple class to represent JSON object
+//
+// Only the member matching Type() is alive: numbers and booleans share one
+// small scalar slot and string/binary/array/object live in a union, so a
+// Value costs little more than its largest alternative. Short strings use
+// std::string's inline storage and never touch the heap.
 class Value {
  public:
-  typedef std::vector<Value> Array;
-  typedef std::map<std::string, Value> Object;
+  typedef std::vector<Value, ModelAllocator<Value>> Array;
+  typedef std::map<std::string, Value, std::less<std::string>,
+                   ModelAllocator<std::pair<const std::string, Value>>>
+      Object;
 
-  Value()
-      : type_(NULL_TYPE),
-        int_value_(0),
-        real_value_(0.0),
-        boolean_value_(false) {}
+  Value() : type_(NULL_TYPE) { new (&scalar_) Scalar(); }
 
-  explicit Value(bool b) : type_(BOOL_TYPE) { boolean_value_ = b; }
+  explicit Value(bool b) : type_(BOOL_TYPE) {
+    new (&scalar_) Scalar();
+    scalar_.boolean_value = b;
+  }
   explicit Value(int i) : type_(INT_TYPE) {
-    int_value_ = i;
-    real_value_ = i;
+    new (&scalar_) Scalar();
+    scalar_.int_value = i;
+    scalar_.real_value = i;
+  }
+  explicit Value(double n) : type_(REAL_TYPE) {
+    new (&scalar_) Scalar();
+    scalar_.real_value = n;
   }
-  explicit Value(double n) : type_(REAL_TYPE) { real_value_ = n; }
   explicit Value(const std::string &s) : type_(STRING_TYPE) {
-    string_value_ = s;
+    new (&string_value_) std::string(s);
+  }
+  explicit Value(std::string &&s) : type_(STRING_TYPE) {
+    new (&string_value_) std::string(std::move(s));
   }
-  explicit Value(std::string &&s)
-      : type_(STRING_TYPE), string_value_(std::move(s)) {}
   explicit Value(const unsigned char *p, size_t n) : type_(BINARY_TYPE) {
-    binary_value_.resize(n);
-    memcpy(binary_value_.data(), p, n);
+    new (&binary_value_) std::vector<unsigned char>(p, p + n);
   }
   explicit Value(std::vector<unsigned char> &&v) noexcept
-      : type_(BINARY_TYPE),
-        binary_value_(std::move(v)) {}
-  explicit Value(const Array &a) : type_(ARRAY_TYPE) { array_value_ = a; }
-  explicit Value(Array &&a) noexcept : type_(ARRAY_TYPE),
-                                       array_value_(std::move(a)) {}
+      : type_(BINARY_TYPE) {
+    new (&binary_value_) std::vector<unsigned char>(std::move(v));
+  }
+  explicit Value(const Array &a) : type_(ARRAY_TYPE) {
+    new (&array_value_) Array(a);
+  }
+  explicit Value(Array &&a) noexcept : type_(ARRAY_TYPE) {
+    new (&array_value_) Array(std::move(a));
+  }
+
+  explicit Value(const Object &o) : type_(OBJECT_TYPE) {
+    new (&object_value_) Object(o);
+  }
+  explicit Value(Object &&o) noexcept : type_(OBJECT_TYPE) {
+    new (&object_value_) Object(std::move(o));
+  }
+
+  ~Value() { Destroy(); }
+
+  Value(const Value &other) : type_(other.type_) {
+    switch (other.type_) {
+      case STRING_TYPE:
+        new (&string_value_) std::string(other.string_value_);
+        break;
+      case BINARY_TYPE:
+        new (&binary_value_)
+            std::vector<unsigned char>(other.binary_value_);
+        break;
+      case ARRAY_TYPE:
+        new (&array_value_) Array(other.array_value_);
+        break;
+      case OBJECT_TYPE:
+        new (&object_value_) Object(other.object_value_);
+        break;
+      default:
+        new (&scalar_) Scalar(other.scalar_);
+        break;
+    }
+  }
+
+  // Moving steals the heap storage of the source, which keeps its type but
+  // is left empty.
+  Value(Value &&other) TINYGLTF_NOEXCEPT { MoveConstruct(std::move(other)); }
 
-  explicit Value(const Object &o) : type_(OBJECT_TYPE) { object_value_ = o; }
-  explicit Value(Object &&o) noexcept : type_(OBJECT_TYPE),
-                                        object_value_(std::move(o)) {}
+  Value &operator=(const Value &other) {
+    if (this != &other) {
+      Value tmp(other);
+      *this = std::move(tmp);
+    }
+    return *this;
+  }
 
-  DEFAULT_METHODS(Value)
+  Value &operator=(Value &&other) TINYGLTF_NOEXCEPT {
+    if (this == &other) return *this;
+    if (type_ == other.type_) {
+      switch (type_) {
+        case STRING_TYPE:
+          string_value_ = std::move(other.string_value_);
+          break;
+        case BINARY_TYPE:
+          binary_value_ = std::move(other.binary_value_);
+          break;
+        case ARRAY_TYPE:
+          array_value_ = std::move(other.array_value_);
+          break;
+        case OBJECT_TYPE:
+          object_value_ = std::move(other.object_value_);
+          break;
+        default:
+          scalar_ = other.scalar_;
+          break;
+      }
+      return *this;
+    }
+    Destroy();
+    MoveConstruct(std::move(other));
+    return *this;
+  }
 
   char Type() const { return static_cast<char>(type_); }
 
@@ -339,9 +687,9 @@ class Value {
   // Use this function if you want to have number value as double.
   double GetNumberAsDouble() const {
     if (type_ == INT_TYPE) {
-      return double(int_value_);
+      return double(scalar_.int_value);
     } else {
-      return real_value_;
+      return HasScalar() ? scalar_.real_value : 0.0;
     }
   }
 
@@ -349,13 +697,19 @@ class Value {
   // TODO(syoyo): Support int value larger than 32 bits
   int GetNumberAsInt() const {
     if (type_ == REAL_TYPE) {
-      return int(real_value_);
+      return int(scalar_.real_value);
     } else {
-      return int_value_;
+      return HasScalar() ? scalar_.int_value : 0;
     }
   }
 
   // Accessor
+  //
+  // Both versions return an empty value when `T` does not match the stored
+  // type, and never change the stored value. For the non-const version that
+  // is a per-thread scratch `T`, so writes through a mismatched reference are
+  // not kept. bool, int and double share storage with null, so they are
+  // readable and writable for any of null, bool, int and real.
   template <typename T>
   const T &Get() const;
   template <typename T>
@@ -366,7 +720,7 @@ class Value {
     static Value null_value;
     assert(IsArray());
     assert(idx >= 0);
-    return (static_cast<size_t>(idx) < array_value_.size())
+    return (IsArray() && static_cast<size_t>(idx) < array_value_.size())
                ? array_value_[static_cast<size_t>(idx)]
                : null_value;
   }
@@ -375,6 +729,7 @@ class Value {
   const Value &Get(const std::string &key) const {
     static Value null_value;
     assert(IsObject());
+    if (!IsObject()) return null_value;
     Object::const_iterator it = object_value_.find(key);
     return (it != object_value_.end()) ? it->second : null_value;
   }
@@ -396,6 +751,7 @@ class Value {
     std::vector<std::string> keys;
     if (!IsObject()) return keys;  // empty
 
+    keys.reserve(object_value_.size());
     for (Object::const_iterator it = object_value_.begin();
          it != object_value_.end(); ++it) {
       keys.push_back(it->first);
@@ -404,42 +760,115 @@ class Value {
     return keys;
   }
 
-  size_t Size() const { return (IsArray() ? ArrayLen() : Keys().size()); }
+  size_t Size() const {
+    return (IsArray() ? ArrayLen() : (IsObject() ? object_value_.size() : 0));
+  }
 
   bool operator==(const tinygltf::Value &other) const;
 
  protected:
-  int type_ = NULL_TYPE;
-
-  int int_value_ = 0;
-  double real_value_ = 0.0;
-  std::string string_value_;
-  std::vector<unsigned char> binary_value_;
-  Array array_value_;
-  Object object_value_;
-  bool boolean_value_ = false;
+  struct Scalar {
+    double real_value = 0.0;
+    int int_value = 0;
+    bool boolean_value = false;
+  };
+
+  // NULL, REAL, INT and BOOL values all keep `scalar_` alive.
+  bool HasScalar() const { return type_ <= BOOL_TYPE; }
+
+  template <typename T>
+  static const T &EmptyValue() {
+    static const T empty_value{};
+    return empty_value;
+  }
+
+  template <typename T>
+  static T &ScratchValue() {
+    static thread_local T scratch_value;
+    scratch_value = T();
+    return scratch_value;
+  }
+
+  template <typename T>
+  static void DestroyMember(T &member) {
+    member.~T();
+  }
+
+  void Destroy() {
+    switch (type_) {
+      case STRING_TYPE:
+        DestroyMember(string_value_);
+        break;
+      case BINARY_TYPE:
+        DestroyMember(binary_value_);
+        break;
+      case ARRAY_TYPE:
+        DestroyMember(array_value_);
+        break;
+      case OBJECT_TYPE:
+        DestroyMember(object_value_);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void MoveConstruct(Value &&other) TINYGLTF_NOEXCEPT {
+    type_ = other.type_;
+    switch (other.type_) {
+      case STRING_TYPE:
+        new (&string_value_) std::string(std::move(other.string_value_));
+        break;
+      case BINARY_TYPE:
+        new (&binary_value_)
+            std::vector<unsigned char>(std::move(other.binary_value_));
+        break;
+      case ARRAY_TYPE:
+        new (&array_value_) Array(std::move(other.array_value_));
+        break;
+      case OBJECT_TYPE:
+        new (&object_value_) Object(std::move(other.object_value_));
+        break;
+      default:
+        new (&scalar_) Scalar(other.scalar_);
+        break;
+    }
+  }
+
+  union {
+    Scalar scalar_;
+    std::string string_value_;
+    std::vector<unsigned char> binary_value_;
+    Array array_value_;
+    Object object_value_;
+  };
+  unsigned char type_;
 };
 
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
 
-#define TINYGLTF_VALUE_GET(ctype, var)            \
-  template <>                                     \
-  inline const ctype &Value::Get<ctype>() const { \
-    return var;                                   \
-  }                                               \
-  template <>                                     \
-  inline ctype &Value::Get<ctype>() {             \
-    return var;                                   \
-  }
-TINYGLTF_VALUE_GET(bool, boolean_value_)
-TINYGLTF_VALUE_GET(double, real_value_)
-TINYGLTF_VALUE_GET(int, int_value_)
-TINYGLTF_VALUE_GET(std::string, string_value_)
-TINYGLTF_VALUE_GET(std::vector<unsigned char>, binary_value_)
-TINYGLTF_VALUE_GET(Value::Array, array_value_)
-TINYGLTF_VALUE_GET(Value::Object, object_value_)
+#define TINYGLTF_VALUE_GET(ctype, var, type)                         \
+  template <>                                                        \
+  inline const ctype &Value::Get<ctype>() const {                    \
+    return (type <= BOOL_TYPE ? HasScalar() : (type_ == type))       \
+               ? var                                                 \
+               : EmptyValue<ctype>();                                \
+  }                                                                  \
+  template <>                                                        \
+  inline ctype &Value::Get<ctype>() {                                \
+    return (type <= BOOL_TYPE ? HasScalar() : (type_ == type))       \
+               ? var                                                 \
+               : ScratchValue<ctype>();                              \
+  }
+TINYGLTF_VALUE_GET(bool, scalar_.boolean_value, BOOL_TYPE)
+TINYGLTF_VALUE_GET(double, scalar_.real_value, REAL_TYPE)
+TINYGLTF_VALUE_GET(int, scalar_.int_value, INT_TYPE)
+TINYGLTF_VALUE_GET(std::string, string_value_, STRING_TYPE)
+TINYGLTF_VALUE_GET(std::vector<unsigned char>, binary_value_, BINARY_TYPE)
+TINYGLTF_VALUE_GET(Value::Array, array_value_, ARRAY_TYPE)
+TINYGLTF_VALUE_GET(Value::Object, object_value_, OBJECT_TYPE)
 #undef TINYGLTF_VALUE_GET
 
 #ifdef __clang__
@@ -543,7 +972,7 @@ struct Parameter {
 #endif
 
 typedef std::map<std::string, Parameter> ParameterMap;
-typedef std::map<std::string, Value> ExtensionMap;
+typedef Value::Object ExtensionMap;
 
 struct AnimationChannel {
   int sampler;              // required
@@ -583,7 +1012,7 @@ struct AnimationSampler {
 };
 
 struct Animation {
-  std::string name;
+  NameString name;
   std::vector<AnimationChannel> channels;
   std::vector<AnimationSampler> samplers;
   Value extras;
@@ -599,7 +1028,7 @@ struct Animation {
 };
 
 struct Skin {
-  std::string name;
+  NameString name;
   int inverseBindMatrices;  // required here but not in the spec
   int skeleton;             // The index of the node used as a skeleton root
   std::vector<int> joints;  // Indices of skeleton nodes
@@ -620,7 +1049,7 @@ struct Skin {
 };
 
 struct Sampler {
-  std::string name;
+  NameString name;
   // glTF 2.0 spec does not define default value for `minFilter` and
   // `magFilter`. Set -1 in TinyGLTF(issue #186)
   int minFilter =
@@ -655,14 +1084,14 @@ struct Sampler {
 };
 
 struct Image {
-  std::string name;
+  NameString name;
   int width;
   int height;
   int component;
   int bits;        // bit depth per channel. 8(byte), 16 or 32.
   int pixel_type;  // pixel type(TINYGLTF_COMPONENT_TYPE_***). usually
                    // UBYTE(bits = 8) or USHORT(bits = 16)
-  std::vector<unsigned char> image;
+  SharedBytes image;
   int bufferView;        // (required if no uri)
   std::string mimeType;  // (required if no uri) ["image/jpeg", "image/png",
                          // "image/bmp", "image/gif"]
@@ -678,9 +1107,9 @@ struct Image {
   // When this flag is true, data is stored to `image` in as-is format(e.g. jpeg
   // compressed for "image/jpeg" mime) This feature is good if you use custom
   // image loader function. (e.g. delayed decoding of images for faster glTF
-  // parsing) Default parser for Image does not provide as-is loading feature at
-  // the moment. (You can manipulate this by providing your own LoadImageData
-  // function)
+  // parsing) The default loader provides this with
+  // TinyGLTF::SetLazyImageDecoding(); use TinyGLTF::DecodeImage() to decode
+  // later. (You can also provide your own LoadImageData function)
   bool as_is;
 
   Image() : as_is(false) {
@@ -697,7 +1126,7 @@ struct Image {
 };
 
 struct Texture {
-  std::string name;
+  NameString name;
 
   int sampler;
   int source;
@@ -796,7 +1225,7 @@ struct PbrMetallicRoughness {
 // members not in the values could be included in the ParameterMap
 // to keep a single material model
 struct Material {
-  std::string name;
+  NameString name;
 
   std::vector<double> emissiveFactor;  // length 3. default [0, 0, 0]
   std::string alphaMode;               // default "OPAQUE"
@@ -828,7 +1257,7 @@ struct Material {
 };
 
 struct BufferView {
-  std::string name;
+  NameString name;
   int buffer{-1};        // Required
   size_t byteOffset{0};  // minimum 0, default 0
   size_t byteLength{0};  // required, minimum 1. 0 = invalid
@@ -859,7 +1288,7 @@ struct BufferView {
 struct Accessor {
   int bufferView;  // optional in spec but required here since sparse accessor
                    // are not supported
-  std::string name;
+  NameString name;
   size_t byteOffset;
   bool normalized;    // optional.
   int componentType;  // (required) One of TINYGLTF_COMPONENT_TYPE_***
@@ -984,7 +1413,7 @@ struct OrthographicCamera {
 
 struct Camera {
   std::string type;  // required. "perspective" or "orthographic"
-  std::string name;
+  NameString name;
 
   PerspectiveCamera perspective;
   OrthographicCamera orthographic;
@@ -1001,16 +1430,253 @@ struct Camera {
   std::string extensions_json_string;
 };
 
+// Name of a primitive attribute (POSITION, NORMAL, TEXCOORD_n, ...).
+//
+// The standard semantics are encoded as (semantic << 16) | set_index, so
+// comparing two keys is a single integer compare and building one from a
+// Semantic needs no string at all. Any other name, e.g. an application
+// specific "_FOO", is kept by the key itself next to a hash of it, so there
+// is no global name table to grow or lock. Custom keys compare by hash first
+// and only fall back to the names when the hashes are equal.
+class AttributeKey {
+ public:
+  enum Semantic {
+    CUSTOM = 0,
+    POSITION,
+    NORMAL,
+    TANGENT,
+    TEXCOORD,
+    COLOR,
+    JOINTS,
+    WEIGHTS
+  };
+
+  AttributeKey() = default;
+  // `set_index` must be in [0, 0xffff]. Other values give the key Find()
+  // returns for unknown names.
+  AttributeKey(Semantic semantic, int set_index = 0)  // NOLINT
+      : id_(Encode(semantic, set_index)) {}
+  // String keys are accepted implicitly so `attributes["TEXCOORD_0"] = idx`
+  // keeps working.
+  AttributeKey(const std::string &name);  // NOLINT
+  AttributeKey(const char *name);         // NOLINT
+
+  AttributeKey(const AttributeKey &other)
+      : id_(other.id_),
+        custom_(other.custom_ ? new std::string(*other.custom_) : nullptr) {}
+  AttributeKey(AttributeKey &&other) = default;
+  AttributeKey &operator=(const AttributeKey &other) {
+    if (this != &other) *this = AttributeKey(other);
+    return *this;
+  }
+  AttributeKey &operator=(AttributeKey &&other) = default;
+
+  // Same as constructing a key from `name`.
+  static AttributeKey Find(const std::string &name);
+  static AttributeKey Find(const char *name);
+
+  uint32_t Id() const { return id_; }
+
+  Semantic GetSemantic() const {
+    return (id_ & kCustomBit) ? CUSTOM : Semantic(id_ >> 16);
+  }
+
+  // Set index of TEXCOORD_n, COLOR_n, JOINTS_n and WEIGHTS_n.
+  int GetSetIndex() const {
+    return (id_ & kCustomBit) ? 0 : int(id_ & 0xffffu);
+  }
+
+  // The attribute name as it appears in glTF JSON.
+  std::string Name() const;
+  operator std::string() const { return Name(); }  // NOLINT
+
+  bool operator==(const AttributeKey &other) const {
+    return id_ == other.id_ && SameCustomName(other);
+  }
+  bool operator!=(const AttributeKey &other) const { return !(*this == other); }
+  bool operator<(const AttributeKey &other) const {
+    return (id_ != other.id_) ? (id_ < other.id_) : CustomNameLess(other);
+  }
+
+ private:
+  static const uint32_t kCustomBit = 0x80000000u;
+  // Has no name, so it differs from every custom key with the same hash.
+  static const uint32_t kNotFound = 0xffffffffu;
+
+  static uint32_t Encode(Semantic semantic, int set_index) {
+    assert((set_index >= 0) && (set_index <= 0xffff));
+    if ((set_index < 0) || (set_index > 0xffff)) return kNotFound;
+    return (uint32_t(semantic) << 16) | uint32_t(set_index);
+  }
+
+  void SetName(const char *name, size_t len);
+
+  bool SameCustomName(const AttributeKey &other) const {
+    if (!custom_ || !other.custom_) return !custom_ && !other.custom_;
+    return *custom_ == *other.custom_;
+  }
+  bool CustomNameLess(const AttributeKey &other) const {
+    if (!custom_ || !other.custom_) return !custom_ && other.custom_;
+    return *custom_ < *other.custom_;
+  }
+
+  uint32_t id_ = 0;
+  // The name of a custom key, null for the standard semantics.
+  std::unique_ptr<const std::string> custom_;
+};
+
+// Small sorted map from AttributeKey to accessor index.
+//
+// Primitives rarely have more than a handful of attributes, so a sorted
+// vector beats a node based std::map on both memory and lookup time. The
+// interface mirrors the parts of std::map that tinygltf users rely on.
+class AttributeMap {
+ public:
+  typedef AttributeKey key_type;
+  typedef int mapped_type;
+  typedef std::pair<AttributeKey, int> value_type;
+  typedef std::vector<value_type, ModelAllocator<value_type>> Entries;
+  typedef Entries::iterator iterator;
+  typedef Entries::const_iterator const_iterator;
+
+  AttributeMap() = default;
+  AttributeMap(std::initializer_list<value_type> init) {
+    entries_.reserve(init.size());
+    for (const value_type &v : init) insert(v);
+  }
+  DEFAULT_METHODS(AttributeMap)
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  void clear() { entries_.clear(); }
+  void reserve(size_t n) { entries_.reserve(n); }
+
+  iterator find(const AttributeKey &key) {
+    iterator it = LowerBound(key);
+    return (it != end() && it->first == key) ? it : end();
+  }
+  const_iterator find(const AttributeKey &key) const {
+    const_iterator it = LowerBound(key);
+    return (it != end() && it->first == key) ? it : end();
+  }
+  size_t count(const AttributeKey &key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  // Lookups by name, e.g. `attributes.at("POSITION")`. Standard names are
+  // looked up without allocating.
+  template <typename Name>
+  using IfName = typename std::enable_if<
+      std::is_convertible<const Name &, std::string>::value &&
+      !std::is_same<Name, AttributeKey>::value>::type;
+
+  template <typename Name, typename = IfName<Name>>
+  iterator find(const Name &name) {
+    return find(AttributeKey::Find(name));
+  }
+  template <typename Name, typename = IfName<Name>>
+  const_iterator find(const Name &name) const {
+    return find(AttributeKey::Find(name));
+  }
+  template <typename Name, typename = IfName<Name>>
+  size_t count(const Name &name) const {
+    return count(AttributeKey::Find(name));
+  }
+  template <typename Name, typename = IfName<Name>>
+  int &at(const Name &name) {
+    return at(AttributeKey::Find(name));
+  }
+  template <typename Name, typename = IfName<Name>>
+  const int &at(const Name &name) const {
+    return at(AttributeKey::Find(name));
+  }
+  template <typename Name, typename = IfName<Name>>
+  size_t erase(const Name &name) {
+    return erase(AttributeKey::Find(name));
+  }
+
+  // Like std::map::at, throws std::out_of_range (or aborts when exceptions
+  // are disabled) if `key` is not present.
+  int &at(const AttributeKey &key) {
+    iterator it = find(key);
+    if (it == end()) OutOfRange();
+    return it->second;
+  }
+  const int &at(const AttributeKey &key) const {
+    const_iterator it = find(key);
+    if (it == end()) OutOfRange();
+    return it->second;
+  }
+
+  int &operator[](const AttributeKey &key) {
+    return emplace(key, 0).first->second;
+  }
+
+  std::pair<iterator, bool> emplace(const AttributeKey &key, int value) {
+    iterator it = LowerBound(key);
+    if (it != end() && it->first == key) return std::make_pair(it, false);
+    return std::make_pair(entries_.insert(it, value_type(key, value)), true);
+  }
+  std::pair<iterator, bool> insert(const value_type &v) {
+    return emplace(v.first, v.second);
+  }
+
+  size_t erase(const AttributeKey &key) {
+    iterator it = find(key);
+    if (it == end()) return 0;
+    entries_.erase(it);
+    return 1;
+  }
+  iterator erase(const_iterator pos) {
+    return entries_.erase(begin() + (pos - entries_.cbegin()));
+  }
+
+  bool operator==(const AttributeMap &other) const {
+    return entries_ == other.entries_;
+  }
+  bool operator!=(const AttributeMap &other) const {
+    return !(*this == other);
+  }
+
+ private:
+  static bool KeyLess(const value_type &entry, const AttributeKey &key) {
+    return entry.first < key;
+  }
+  iterator LowerBound(const AttributeKey &key) {
+    return std::lower_bound(entries_.begin(), entries_.end(), key, KeyLess);
+  }
+  const_iterator LowerBound(const AttributeKey &key) const {
+    return std::lower_bound(entries_.begin(), entries_.end(), key, KeyLess);
+  }
+
+  static void OutOfRange() {
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+    throw std::out_of_range("tinygltf::AttributeMap::at");
+#else
+    std::abort();
+#endif
+  }
+
+  Entries entries_;
+};
+
 struct Primitive {
-  std::map<std::string, int> attributes;  // (required) A dictionary object of
-                                          // integer, where each integer
-                                          // is the index of the accessor
-                                          // containing an attribute.
+  AttributeMap attributes;  // (required) A dictionary object of
+                            // integer, where each integer
+                            // is the index of the accessor
+                            // containing an attribute.
   int material;  // The index of the material to apply to this primitive
                  // when rendering.
   int indices;   // The index of the accessor that contains the indices.
   int mode;      // one of TINYGLTF_MODE_***
-  std::vector<std::map<std::string, int> > targets;  // array of morph targets,
+  std::vector<AttributeMap> targets;  // array of morph targets,
   // where each target is a dict with attributes in ["POSITION, "NORMAL",
   // "TANGENT"] pointing
   // to their corresponding accessors
@@ -1031,7 +1697,7 @@ struct Primitive {
 };
 
 struct Mesh {
-  std::string name;
+  NameString name;
   std::vector<Primitive> primitives;
   std::vector<double> weights;  // weights to be applied to the Morph Targets
   ExtensionMap extensions;
@@ -1046,6 +1712,91 @@ struct Mesh {
   bool operator==(const Mesh &) const;
 };
 
+#ifdef TINYGLTF_COMPACT_NODE
+// With TINYGLTF_COMPACT_NODE the transform of a Node is stored inline instead
+// of in heap allocated vectors. TINYGLTF_COMPACT_NODE_FLOAT additionally
+// stores it in single precision.
+#ifdef TINYGLTF_COMPACT_NODE_FLOAT
+typedef float NodeScalar;
+#else
+typedef double NodeScalar;
+#endif
+
+///
+/// Fixed-capacity array stored inline, with the part of the std::vector
+/// interface needed for Node transforms. An empty array means the property is
+/// not present.
+///
+template <typename T, size_t N>
+class InlineArray {
+ public:
+  typedef T value_type;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+
+  InlineArray() = default;
+  InlineArray(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
+  }
+  template <typename U>
+  InlineArray(const std::vector<U> &values) {  // NOLINT: implicit on purpose
+    assign(values.begin(), values.end());
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t max_size() const { return N; }
+  size_t capacity() const { return N; }
+
+  T *data() { return values_; }
+  const T *data() const { return values_; }
+  iterator begin() { return values_; }
+  iterator end() { return values_ + size_; }
+  const_iterator begin() const { return values_; }
+  const_iterator end() const { return values_ + size_; }
+
+  T &operator[](size_t i) { return values_[i]; }
+  const T &operator[](size_t i) const { return values_[i]; }
+
+  void clear() { size_ = 0; }
+  void reserve(size_t) {}  // The capacity is fixed.
+  void resize(size_t n, T value = T()) {
+    assert(n <= N);
+    n = (std::min)(n, N);
+    for (size_t i = size_; i < n; i++) {
+      values_[i] = value;
+    }
+    size_ = static_cast<unsigned char>(n);
+  }
+  void push_back(T value) {
+    assert(size_ < N);
+    if (size_ < N) {
+      values_[size_++] = value;
+    }
+  }
+  template <typename It>
+  void assign(It first, It last) {
+    clear();
+    for (; (first != last) && (size_ < N); ++first) {
+      values_[size_++] = static_cast<T>(*first);
+    }
+  }
+
+  std::vector<double> ToVector() const {
+    return std::vector<double>(begin(), end());
+  }
+
+  bool operator==(const InlineArray &other) const {
+    return (size_ == other.size_) && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const InlineArray &other) const { return !(*this == other); }
+
+ private:
+  T values_[N] = {};
+  unsigned char size_ = 0;
+};
+#endif
+
 class Node {
  public:
   Node() : camera(-1), skin(-1), mesh(-1) {}
@@ -1056,14 +1807,21 @@ class Node {
 
   int camera;  // the index of the camera referenced by this node
 
-  std::string name;
+  NameString name;
   int skin;
   int mesh;
   std::vector<int> children;
+#ifdef TINYGLTF_COMPACT_NODE
+  InlineArray<NodeScalar, 4> rotation;
+  InlineArray<NodeScalar, 3> scale;
+  InlineArray<NodeScalar, 3> translation;
+  InlineArray<NodeScalar, 16> matrix;
+#else
   std::vector<double> rotation;     // length must be 0 or 4
   std::vector<double> scale;        // length must be 0 or 3
   std::vector<double> translation;  // length must be 0 or 3
   std::vector<double> matrix;       // length must be 0 or 16
+#endif
   std::vector<double> weights;  // The weights of the instantiated Morph Target
 
   ExtensionMap extensions;
@@ -1075,8 +1833,8 @@ class Node {
 };
 
 struct Buffer {
-  std::string name;
-  std::vector<unsigned char> data;
+  NameString name;
+  SharedBytes data;
   std::string
       uri;  // considered as required here but not in the spec (need to clarify)
             // uri is not decoded(e.g. whitespace may be represented as %20)
@@ -1110,7 +1868,7 @@ struct Asset {
 };
 
 struct Scene {
-  std::string name;
+  NameString name;
   std::vector<int> nodes;
 
   ExtensionMap extensions;
@@ -1142,7 +1900,7 @@ struct SpotLight {
 };
 
 struct Light {
-  std::string name;
+  NameString name;
   std::vector<double> color;
   double intensity{1.0};
   std::string type;
@@ -1196,6 +1954,12 @@ class Model {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set by ValidateModel() when it succeeds, cleared when it fails or a load
+  // starts. Only a record for the application: editing the Model does not
+  // clear it, so the accessor readers never skip a check because of it.
+  // Not part of operator==.
+  bool validated = false;
 };
 
 enum SectionCheck {
@@ -1210,6 +1974,17 @@ enum SectionCheck {
   REQUIRE_ALL = 0x7f
 };
 
+///
+/// Sections a load can leave out, see TinyGLTF::SetSkipSections().
+///
+enum SectionSkip {
+  SKIP_NONE = 0x00,
+  SKIP_IMAGES = 0x01,
+  SKIP_ANIMATIONS = 0x02,
+  SKIP_SKINS = 0x04,
+  SKIP_EXTRAS_AND_EXTENSIONS = 0x08
+};
+
 ///
 /// URIEncodeFunction type. Signature for custom URI encoding of external
 /// resources such as .bin and image files. Used by tinygltf to re-encode the
@@ -1333,41 +2108,640 @@ bool ReadWholeFile(std::vector<unsigned char> *out, std::string *err,
 
 bool WriteWholeFile(std::string *err, const std::string &filepath,
                     const std::vector<unsigned char> &contents, void *);
-#endif
 
 ///
-/// glTF Parser/Serializer context.
+/// Map the whole file read-only into memory.
 ///
-class TinyGLTF {
- public:
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wc++98-compat"
+/// On success the mapped bytes are returned in `data`/`size` together with an
+/// owner handle which unmaps the file once its last reference goes away.
+/// Returns nullptr and sets `err` on failure.
+///
+std::shared_ptr<const void> MapWholeFile(const unsigned char **data,
+                                         size_t *size, std::string *err,
+                                         const std::string &filepath);
 #endif
 
-  TinyGLTF() : bin_data_(nullptr), bin_size_(0), is_binary_(false) {}
+///
+/// Fixed-size pool of worker threads used by the optional parallel stages of
+/// TinyGLTF. One pool can be shared by several TinyGLTF instances and loads.
+///
+class ThreadPool {
+ public:
+  ///
+  /// Start `num_threads` workers. 0 uses std::thread::hardware_concurrency().
+  ///
+  explicit ThreadPool(unsigned int num_threads = 0);
+  ~ThreadPool();
 
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
 
-  ~TinyGLTF() {}
+  unsigned int Size() const {
+    return static_cast<unsigned int>(workers_.size());
+  }
 
   ///
-  /// Loads glTF ASCII asset from a file.
-  /// Set warning message to `warn` for example it fails to load asserts.
-  /// Returns false and set error string to `err` if there's an error.
+  /// Queue `task` to run on a worker thread. `task` must not throw; wrap it
+  /// in a std::packaged_task (as LoadMany does) to get its exceptions.
   ///
-  bool LoadASCIIFromFile(Model *model, std::string *err, std::string *warn,
-                         const std::string &filename,
-                         unsigned int check_sections = REQUIRE_VERSION);
+  void Enqueue(std::function<void()> task);
 
   ///
-  /// Loads glTF ASCII asset from string(memory).
-  /// `length` = strlen(str);
-  /// `base_dir` is a search path of glTF asset(e.g. images). Path Must be an
-  /// expanded path (e.g. no tilde(`~`), no environment variables). Set warning
-  /// message to `warn` for example it fails to load asserts. Returns false and
+  /// Call `fn(i)` for every i in [0, n) and wait for all calls to finish.
+  /// The calling thread takes part in the work, so ParallelFor may be used
+  /// from inside a pool task without deadlocking. If a call throws, the
+  /// items not started yet are skipped and the first exception is rethrown
+  /// on the calling thread once the running calls have returned.
+  ///
+  template <typename Fn>
+  void ParallelFor(size_t n, const Fn &fn);
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_{false};
+};
+
+template <typename Fn>
+void ThreadPool::ParallelFor(size_t n, const Fn &fn) {
+  if ((n <= 1) || workers_.empty()) {
+    for (size_t i = 0; i < n; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  struct State {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;  // First exception of `fn`, under `mutex`.
+
+    // Counts `count` items as done and wakes the caller after the last one.
+    void Finish(size_t count, size_t n) {
+      if (done.fetch_add(count) + count == n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_all();
+      }
+    }
+  };
+  std::shared_ptr<State> state = std::make_shared<State>();
+
+  // Helpers which get to run after all items were claimed return without
+  // touching `fn`, so it only has to outlive this call. Exceptions are
+  // caught here, so that neither a worker nor the caller leaves while
+  // other calls of `fn` are still running.
+  const Fn *func = &fn;
+#ifdef TINYGLTF_USE_ARENA
+  Arena *arena = Arena::Current();
+  auto run = [state, func, n, arena]() {
+    Arena::Scope arena_scope(arena);
+#else
+  auto run = [state, func, n]() {
+#endif
+    size_t i;
+    while ((i = state->next.fetch_add(1)) < n) {
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+      try {
+        (*func)(i);
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->error) state->error = std::current_exception();
+        }
+        // Claim the items nobody has started and count them as done.
+        const size_t unclaimed = state->next.exchange(n);
+        if (unclaimed < n) {
+          state->Finish(n - unclaimed, n);
+        }
+      }
+#else
+      (*func)(i);
+#endif
+      state->Finish(1, n);
+    }
+  };
+
+  const size_t helpers = std::min(n - 1, workers_.size());
+  for (size_t h = 0; h < helpers; h++) {
+    Enqueue(run);
+  }
+  run();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&state, n]() { return state->done.load() == n; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+///
+/// Resolved memory layout of an accessor, see GetAccessorLayout().
+///
+struct AccessorLayout {
+  const unsigned char *data = nullptr;  // First element. nullptr when the
+                                        // accessor has no bufferView, in
+                                        // which case all elements are zero.
+  size_t count = 0;
+  size_t stride = 0;       // Bytes from one element to the next.
+  int componentType = -1;  // One of TINYGLTF_COMPONENT_TYPE_***
+  int numComponents = 0;
+  bool normalized = false;
+
+  // Sparse overlay. `sparseCount` is 0 for dense accessors. The indices are
+  // strictly increasing and less than `count`; the values are tightly packed
+  // elements of the same component type as the accessor.
+  size_t sparseCount = 0;
+  const unsigned char *sparseIndices = nullptr;
+  int sparseIndicesComponentType = -1;
+  const unsigned char *sparseValues = nullptr;
+
+  size_t ElementSize() const {
+    return size_t(GetComponentSizeInBytes(uint32_t(componentType))) *
+           size_t(numComponents);
+  }
+
+  size_t SparseIndex(size_t i) const {
+    const unsigned char *p = sparseIndices;
+    if (sparseIndicesComponentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
+      return p[i];
+    } else if (sparseIndicesComponentType ==
+               TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
+      uint16_t v;
+      memcpy(&v, p + i * sizeof(v), sizeof(v));
+      return v;
+    } else {
+      uint32_t v;
+      memcpy(&v, p + i * sizeof(v), sizeof(v));
+      return v;
+    }
+  }
+};
+
+///
+/// Resolve where the elements of `model.accessors[accessorIndex]` (and its
+/// sparse overlay) live, checking the accessor, bufferView and buffer ranges
+/// and the sparse indices once so that readers can index without checks.
+/// Returns false and appends to `err` if anything is out of range.
+///
+bool GetAccessorLayout(const Model &model, int accessorIndex,
+                       AccessorLayout *layout, std::string *err);
+
+///
+/// Bulk conversion of an accessor into a caller provided array of
+/// count * components tightly packed values, honoring byteStride, the
+/// sparse overlay and (for float and half output) normalized. Runs SSE4.1 or
+/// AVX2 kernels when the CPU has them; interleaved input is gathered in
+/// cache sized batches first.
+///
+/// - float: glTF normalization for normalized integers, a plain conversion
+///   otherwise.
+/// - half: as float, then rounded to IEEE 754 binary16 bit patterns.
+/// - int32: the raw component values, floats truncated toward zero.
+///
+/// The Model overloads validate the accessor with GetAccessorLayout() and
+/// return false with `err` filled when it is out of range.
+///
+void ConvertAccessor(const AccessorLayout &layout, float *out);
+void ConvertAccessor(const AccessorLayout &layout, int32_t *out);
+void ConvertAccessorToHalf(const AccessorLayout &layout, uint16_t *out);
+bool ConvertAccessor(const Model &model, int accessorIndex, float *out,
+                     std::string *err);
+bool ConvertAccessor(const Model &model, int accessorIndex, int32_t *out,
+                     std::string *err);
+bool ConvertAccessorToHalf(const Model &model, int accessorIndex,
+                           uint16_t *out, std::string *err);
+
+///
+/// Write an accessor as count * ElementSize() tightly packed bytes in its own
+/// component type: the elements of the base bufferView (or zeros when it has
+/// none) with the sparse values scattered over them. Works for dense
+/// accessors too, where it is a packed copy.
+///
+void MaterializeSparseAccessor(const AccessorLayout &layout,
+                               unsigned char *out);
+bool MaterializeSparseAccessor(const Model &model, int accessorIndex,
+                               std::vector<unsigned char> *out,
+                               std::string *err);
+
+///
+/// Overlay only the sparse values onto `dense`, which already holds the
+/// accessor's base elements, e.g. morph target deltas converted earlier.
+/// `dense` is either packed raw elements (as MaterializeSparseAccessor()
+/// writes) or the float / int32 / half output of ConvertAccessor(). Only
+/// the sparse elements are touched. No-op for dense accessors.
+///
+void ApplySparseOverlay(const AccessorLayout &layout, unsigned char *dense);
+void ApplySparseOverlay(const AccessorLayout &layout, float *dense);
+void ApplySparseOverlay(const AccessorLayout &layout, int32_t *dense);
+void ApplySparseOverlayToHalf(const AccessorLayout &layout, uint16_t *dense);
+
+///
+/// Per-component minimum and maximum of an accessor as glTF defines
+/// Accessor::minValues / maxValues: raw component values (normalized is not
+/// applied) with the sparse values substituted. Runs SIMD min/max kernels
+/// over the packed or gathered components. Returns false for an empty
+/// accessor.
+///
+bool ComputeAccessorBounds(const AccessorLayout &layout,
+                           std::vector<double> *minValues,
+                           std::vector<double> *maxValues);
+bool ComputeAccessorBounds(const Model &model, int accessorIndex,
+                           std::vector<double> *minValues,
+                           std::vector<double> *maxValues, std::string *err);
+
+///
+/// Compute the bounds of every accessor and store them in minValues /
+/// maxValues, so later stages can rely on them without another pass.
+/// Accessors are processed in parallel on `pool` when given. Returns false
+/// if an accessor is out of range (see GetAccessorLayout()).
+///
+bool UpdateAccessorBounds(Model *model, std::string *err,
+                          ThreadPool *pool = nullptr);
+
+///
+/// Check the minValues / maxValues present in the model against the data.
+/// Float bounds only have to round to the computed float. Returns false and
+/// describes each mismatch in `err`.
+///
+bool VerifyAccessorBounds(const Model &model, std::string *err,
+                          ThreadPool *pool = nullptr);
+
+///
+/// Check once, after loading, everything the accessor readers would
+/// otherwise have to check on every access: bufferView and buffer ranges,
+/// accessor ranges and sparse indices, the attribute counts of each
+/// primitive and that no index is past the vertex count (the largest index
+/// is found with the SIMD bounds kernels). Accessors are checked in parallel
+/// on `pool` when given. Sets `model->validated` on success. The accessor
+/// readers still check what they rely on (e.g. GetAccessorLayout() walks the
+/// sparse indices), so a stale flag cannot cause out-of-bounds access.
+///
+bool ValidateModel(Model *model, std::string *err, ThreadPool *pool = nullptr);
+
+///
+/// Describes how AccessorView<T> stores one element: `component_type` and
+/// the number of components. Specialize it to read straight into your own
+/// vector types, e.g. glm::vec3.
+///
+template <typename T, typename Enable = void>
+struct AccessorElementTraits;
+
+template <typename T>
+struct AccessorElementTraits<
+    T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+  typedef T component_type;
+  static const int kNumComponents = 1;
+  static component_type *Components(T &v) { return &v; }
+};
+
+template <typename U, size_t N>
+struct AccessorElementTraits<std::array<U, N>> {
+  typedef U component_type;
+  static const int kNumComponents = int(N);
+  static component_type *Components(std::array<U, N> &v) { return v.data(); }
+};
+
+template <typename T>
+class AccessorView;
+
+///
+/// Contiguous sub-range [first, last) of an AccessorView, e.g. one chunk of a
+/// ThreadPool::ParallelFor.
+///
+template <typename T>
+class AccessorRange {
+ public:
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef T reference;
+
+    const_iterator() = default;
+    const_iterator(const AccessorView<T> *view, size_t index)
+        : view_(view), index_(index) {}
+
+    T operator*() const { return (*view_)[index_]; }
+    const_iterator &operator++() {
+      index_++;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator it = *this;
+      index_++;
+      return it;
+    }
+    bool operator==(const const_iterator &other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return index_ != other.index_;
+    }
+    size_t Index() const { return index_; }
+
+   private:
+    const AccessorView<T> *view_ = nullptr;
+    size_t index_ = 0;
+  };
+
+  AccessorRange(const AccessorView<T> *view, size_t first, size_t last)
+      : view_(view), first_(first), last_(last) {}
+
+  const_iterator begin() const { return const_iterator(view_, first_); }
+  const_iterator end() const { return const_iterator(view_, last_); }
+  size_t size() const { return last_ - first_; }
+  bool empty() const { return first_ == last_; }
+
+  ///
+  /// Call `fn(index, value)` for every element in order. The component type
+  /// is resolved once for the whole range, so the inner loop is a
+  /// straight-line conversion the compiler can vectorize.
+  ///
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    view_->ForEachInRange(first_, last_, fn);
+  }
+
+ private:
+  const AccessorView<T> *view_;
+  size_t first_;
+  size_t last_;
+};
+
+///
+/// Typed, zero-copy view of an accessor's elements.
+///
+/// Reads in place from the buffer honoring byteOffset, byteStride,
+/// normalized (per the glTF spec when T has floating point components) and
+/// the sparse overlay. All ranges are checked once by the constructor; an
+/// invalid accessor yields an empty view with IsValid() == false.
+///
+///   AccessorView<std::array<float, 3>> positions(model, accessorIndex, &err);
+///   for (const auto &p : positions) { ... }
+///
+template <typename T>
+class AccessorView {
+ public:
+  typedef AccessorElementTraits<T> Traits;
+  typedef typename Traits::component_type component_type;
+  static const int kNumComponents = Traits::kNumComponents;
+  typedef typename AccessorRange<T>::const_iterator const_iterator;
+
+  AccessorView() = default;
+
+  AccessorView(const Model &model, int accessorIndex,
+               std::string *err = nullptr) {
+    if (!GetAccessorLayout(model, accessorIndex, &layout_, err)) {
+      layout_ = AccessorLayout();
+      return;
+    }
+    if (layout_.numComponents != kNumComponents) {
+      if (err) {
+        (*err) += "accessor[" + std::to_string(accessorIndex) + "] has " +
+                  std::to_string(layout_.numComponents) +
+                  " components per element but the view expects " +
+                  std::to_string(kNumComponents) + ".\n";
+      }
+      layout_ = AccessorLayout();
+      return;
+    }
+    valid_ = true;
+  }
+
+  bool IsValid() const { return valid_; }
+  const AccessorLayout &Layout() const { return layout_; }
+
+  size_t size() const { return layout_.count; }
+  bool empty() const { return layout_.count == 0; }
+
+  T operator[](size_t i) const {
+    assert(i < size());
+    T value{};
+    auto store = [&value](size_t, const T &v) { value = v; };
+    ForEachInRange(i, i + 1, store);
+    return value;
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+
+  AccessorRange<T> Range(size_t first, size_t last) const {
+    assert(first <= last && last <= size());
+    return AccessorRange<T>(this, first, last);
+  }
+
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    ForEachInRange(0, size(), fn);
+  }
+
+  /// Convert every element into `out`, which must hold size() elements.
+  /// Elements made of packed float or int32 components use the bulk
+  /// ConvertAccessor() kernels.
+  void CopyTo(T *out) const {
+    typedef std::integral_constant<
+        bool, sizeof(T) == sizeof(component_type) * kNumComponents &&
+                  (std::is_same<component_type, float>::value ||
+                   std::is_same<component_type, int32_t>::value)>
+        bulk;
+    CopyTo(out, bulk());
+  }
+
+  std::vector<T> ToVector() const {
+    std::vector<T> out(size());
+    CopyTo(out.data());
+    return out;
+  }
+
+ private:
+  friend class AccessorRange<T>;
+
+  void CopyTo(T *out, std::true_type) const {
+    ConvertAccessor(layout_, reinterpret_cast<component_type *>(out));
+  }
+  void CopyTo(T *out, std::false_type) const {
+    ForEach([out](size_t i, const T &v) { out[i] = v; });
+  }
+
+  template <typename Fn>
+  void ForEachInRange(size_t first, size_t last, Fn &fn) const {
+    if (first >= last) return;
+    switch (layout_.componentType) {
+      case TINYGLTF_COMPONENT_TYPE_BYTE:
+        ForEachAs<int8_t>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        ForEachAs<uint8_t>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_SHORT:
+        ForEachAs<int16_t>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        ForEachAs<uint16_t>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_INT:
+        ForEachAs<int32_t>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        ForEachAs<uint32_t>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        ForEachAs<float>(first, last, fn);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+        ForEachAs<double>(first, last, fn);
+        break;
+      default:
+        break;
+    }
+  }
+
+  template <typename Src, typename Fn>
+  void ForEachAs(size_t first, size_t last, Fn &fn) const {
+    if (layout_.normalized) {
+      ForEachImpl<Src, true>(first, last, fn);
+    } else {
+      ForEachImpl<Src, false>(first, last, fn);
+    }
+  }
+
+  template <typename Src, bool kNormalized, typename Fn>
+  void ForEachImpl(size_t first, size_t last, Fn &fn) const {
+    // First sparse entry at or after `first`.
+    size_t lo = 0;
+    size_t hi = layout_.sparseCount;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (layout_.SparseIndex(mid) < first) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    size_t s = lo;
+
+    const size_t element_size = sizeof(Src) * size_t(kNumComponents);
+    size_t i = first;
+    while (i < last) {
+      const size_t next =
+          (s < layout_.sparseCount) ? std::min(last, layout_.SparseIndex(s))
+                                    : last;
+      if (layout_.data) {
+        const unsigned char *p = layout_.data + i * layout_.stride;
+        for (; i < next; i++, p += layout_.stride) {
+          T value;
+          Decode<Src, kNormalized>(p, &value);
+          fn(i, value);
+        }
+      } else {
+        const T zero{};
+        for (; i < next; i++) {
+          fn(i, zero);
+        }
+      }
+      if (i < last) {
+        T value;
+        Decode<Src, kNormalized>(layout_.sparseValues + s * element_size,
+                                 &value);
+        fn(i, value);
+        i++;
+        s++;
+      }
+    }
+  }
+
+  template <typename Src, bool kNormalized>
+  static void Decode(const unsigned char *p, T *out) {
+    typedef std::integral_constant<
+        bool, kNormalized && std::is_integral<Src>::value &&
+                  std::is_floating_point<component_type>::value>
+        normalize;
+    component_type *c = Traits::Components(*out);
+    for (int k = 0; k < kNumComponents; k++) {
+      Src v;
+      memcpy(&v, p + size_t(k) * sizeof(Src), sizeof(Src));
+      c[k] = Convert(v, normalize());
+    }
+  }
+
+  template <typename Src>
+  static component_type Convert(Src v, std::false_type) {
+    return static_cast<component_type>(v);
+  }
+
+  // glTF normalization: c / max for unsigned, max(c / max, -1) for signed.
+  template <typename Src>
+  static component_type Convert(Src v, std::true_type) {
+    const component_type r = static_cast<component_type>(v) /
+                             static_cast<component_type>(
+                                 std::numeric_limits<Src>::max());
+    return (r < component_type(-1)) ? component_type(-1) : r;
+  }
+
+  AccessorLayout layout_;
+  bool valid_ = false;
+};
+
+///
+/// Result of one file loaded by TinyGLTF::LoadMany().
+///
+struct LoadResult {
+  std::string filename;
+  Model model;
+  bool success = false;
+  std::string err;
+  std::string warn;
+
+  size_t files_read = 0;  // The glTF itself plus external buffers and images.
+  size_t bytes_read = 0;  // Bytes read through FsCallbacks (or mapped).
+  double wait_seconds = 0.0;   // Time spent queued before the load started.
+  double read_seconds = 0.0;   // Time spent in file reads.
+  double total_seconds = 0.0;  // Time from the start to the end of the load.
+};
+
+///
+/// glTF Parser/Serializer context.
+///
+class TinyGLTF {
+ public:
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wc++98-compat"
+#endif
+
+  TinyGLTF() {}
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+  ~TinyGLTF() {}
+
+  ///
+  /// Loads glTF ASCII asset from a file.
+  /// Set warning message to `warn` for example it fails to load asserts.
+  /// Returns false and set error string to `err` if there's an error.
+  ///
+  bool LoadASCIIFromFile(Model *model, std::string *err, std::string *warn,
+                         const std::string &filename,
+                         unsigned int check_sections = REQUIRE_VERSION);
+
+  ///
+  /// Loads glTF ASCII asset from string(memory).
+  /// `length` = strlen(str);
+  /// `base_dir` is a search path of glTF asset(e.g. images). Path Must be an
+  /// expanded path (e.g. no tilde(`~`), no environment variables). Set warning
+  /// message to `warn` for example it fails to load asserts. Returns false and
   /// set error string to `err` if there's an error.
   ///
   bool LoadASCIIFromString(Model *model, std::string *err, std::string *warn,
@@ -1384,6 +2758,18 @@ class TinyGLTF {
                           const std::string &filename,
                           unsigned int check_sections = REQUIRE_VERSION);
 
+  ///
+  /// Loads only the metadata of a glTF binary file: reads the 20 byte header
+  /// and the JSON chunk (with pread when the default filesystem callbacks are
+  /// used, so the BIN chunk is never read) and parses the JSON. Buffers and
+  /// images get their properties but no payload: `Buffer::data` and
+  /// `Image::image` stay empty and no external file is opened. Meant for
+  /// indexing names, counts, accessor min/max and extras of many files.
+  ///
+  bool ProbeBinaryFromFile(Model *model, std::string *err, std::string *warn,
+                           const std::string &filename,
+                           unsigned int check_sections = REQUIRE_VERSION);
+
   ///
   /// Loads glTF binary asset from memory.
   /// `length` = strlen(str);
@@ -1398,6 +2784,20 @@ class TinyGLTF {
                             const std::string &base_dir = "",
                             unsigned int check_sections = REQUIRE_VERSION);
 
+  ///
+  /// Loads several glTF files (ASCII or binary, detected from the GLB magic)
+  /// as tasks on `pool` (GetThreadPool() when null), so that file reads of
+  /// one file overlap with JSON parsing and image decoding of the others.
+  /// Returns one future per file, in the order of `filenames`. Without a
+  /// pool (or with an empty one) the files are loaded on the calling thread
+  /// before LoadMany returns. This TinyGLTF must outlive the futures and must
+  /// not be reconfigured until they are ready.
+  ///
+  std::vector<std::future<LoadResult>> LoadMany(
+      const std::vector<std::string> &filenames,
+      unsigned int check_sections = REQUIRE_VERSION,
+      ThreadPool *pool = nullptr);
+
   ///
   /// Write glTF to stream, buffers and images will be embedded
   ///
@@ -1411,10 +2811,32 @@ class TinyGLTF {
                             bool embedImages, bool embedBuffers,
                             bool prettyPrint, bool writeBinary);
 
+  ///
+  /// Write glTF binary (GLB) with every buffer in the BIN chunk: the buffers
+  /// are laid out one after another (4 byte aligned) as a single buffer and
+  /// the bufferViews are rebased onto it, together with the buffer of their
+  /// EXT_meshopt_compression extension. BufferViews with other extensions
+  /// which reference a buffer are rejected. The merged buffer only has a
+  /// byteLength: the names, extras and extensions of the source buffers are
+  /// not written. The chunk headers, the JSON and the buffer bytes are
+  /// written straight from the Model as a list of segments (writev() for
+  /// files on POSIX), so the file is never assembled in memory. Images not
+  /// stored in a bufferView are embedded as data URIs. Returns false and
+  /// appends to `err` on failure, e.g. when the file would exceed the 4 GB
+  /// limit of GLB.
+  ///
+  bool WriteGlbSceneToStream(const Model *model, std::ostream &stream,
+                             std::string *err = nullptr);
+  bool WriteGlbSceneToFile(const Model *model, const std::string &filename,
+                           std::string *err = nullptr);
+
   ///
   /// Set callback to use for loading image data
+  /// Set `thread_safe` if the callback may be called concurrently, which lets
+  /// parallel image decoding (SetParallelImageDecoding) use it.
   ///
-  void SetImageLoader(LoadImageDataFunction LoadImageData, void *user_data);
+  void SetImageLoader(LoadImageDataFunction LoadImageData, void *user_data,
+                      bool thread_safe = false);
 
   ///
   /// Unset(remove) callback of loading image data
@@ -1474,74 +2896,291 @@ class TinyGLTF {
 
   bool GetPreserveImageChannels() const { return preserve_image_channels_; }
 
- private:
   ///
-  /// Loads glTF asset from string(memory).
-  /// `length` = strlen(str);
-  /// Set warning message to `warn` for example it fails to load asserts
-  /// Returns false and set error string to `err` if there's an error.
+  /// Memory-map the file in `LoadBinaryFromFile` instead of reading it.
+  /// The JSON chunk is parsed in place and buffers stored in the BIN chunk
+  /// reference the mapping instead of being copied into `Buffer::data`.
+  /// The mapping stays alive as long as a Buffer (or Model) references it.
+  /// (Only effective with the default filesystem callbacks)
   ///
-  bool LoadFromString(Model *model, std::string *err, std::string *warn,
-                      const char *str, const unsigned int length,
-                      const std::string &base_dir, unsigned int check_sections);
-
-  const unsigned char *bin_data_ = nullptr;
-  size_t bin_size_ = 0;
-  bool is_binary_ = false;
+  void SetMemoryMapBinaryFiles(bool onoff) {
+    memory_map_binary_files_ = onoff;
+  }
 
-  bool serialize_default_values_ = false;  ///< Serialize default values?
+  bool GetMemoryMapBinaryFiles() const { return memory_map_binary_files_; }
 
-  bool store_original_json_for_extras_and_extensions_ = false;
+  ///
+  /// Keep the text of data URIs in `Buffer::uri` and `Image::uri`.
+  /// By default data URIs are decoded straight from the JSON and their
+  /// (possibly very large) text is not stored.
+  ///
+  void SetStoreDataURIs(bool onoff) { store_data_uris_ = onoff; }
 
-  bool preserve_image_channels_ = false;  /// Default false(expand channels to
-                                          /// RGBA) for backward compatibility.
+  bool GetStoreDataURIs() const { return store_data_uris_; }
 
-  // Warning & error messages
-  std::string warn_;
-  std::string err_;
+  ///
+  /// Set the thread pool used by the parallel load stages. Not owned; it
+  /// must outlive this TinyGLTF. When no pool is set, enabling a parallel
+  /// stage creates one owned by this TinyGLTF.
+  ///
+  void SetThreadPool(ThreadPool *pool) { thread_pool_ = pool; }
 
-  FsCallbacks fs = {
-#ifndef TINYGLTF_NO_FS
-      &tinygltf::FileExists, &tinygltf::ExpandFilePath,
-      &tinygltf::ReadWholeFile, &tinygltf::WriteWholeFile,
+  ThreadPool *GetThreadPool() const {
+    return thread_pool_ ? thread_pool_ : owned_thread_pool_.get();
+  }
 
-      nullptr  // Fs callback user data
-#else
-      nullptr, nullptr, nullptr, nullptr,
+#ifdef TINYGLTF_USE_ARENA
+  ///
+  /// Allocate the Value trees, attribute maps and names of loaded Models from
+  /// `arena` (see Arena). Not owned; it must outlive those Models. nullptr,
+  /// the default, allocates them from the heap.
+  ///
+  void SetArena(Arena *arena) { arena_ = arena; }
 
-      nullptr  // Fs callback user data
+  Arena *GetArena() const { return arena_; }
 #endif
-  };
 
-  URICallbacks uri_cb = {
-      // Use paths as-is by default. This will use JSON string escaping.
-      nullptr,
-      // Decode all URIs before using them as paths as the application may have
-      // percent encoded them.
-      &tinygltf::URIDecode,
-      // URI callback user data
-      nullptr};
+  ///
+  /// Decode images on the thread pool while loading. `Model::images` and the
+  /// error and warning messages come out in the same order as with the
+  /// sequential decode. A user supplied image loader is only called in
+  /// parallel when it was registered as thread-safe.
+  ///
+  void SetParallelImageDecoding(bool onoff) {
+    parallel_image_decoding_ = onoff;
+    if (onoff && !thread_pool_ && !owned_thread_pool_) {
+      owned_thread_pool_ = std::make_shared<ThreadPool>();
+    }
+  }
 
-  LoadImageDataFunction LoadImageData =
-#ifndef TINYGLTF_NO_STB_IMAGE
-      &tinygltf::LoadImageData;
-#else
-      nullptr;
-#endif
-  void *load_image_user_data_{nullptr};
-  bool user_image_loader_{false};
+  bool GetParallelImageDecoding() const { return parallel_image_decoding_; }
 
-  WriteImageDataFunction WriteImageData =
-#ifndef TINYGLTF_NO_STB_IMAGE_WRITE
-      &tinygltf::WriteImageData;
-#else
-      nullptr;
-#endif
-  void *write_image_user_data_{nullptr};
-};
+  ///
+  /// Parse large top-level arrays (accessors, nodes, meshes, materials, ...)
+  /// in parallel chunks on the thread pool. `Model` and the error messages
+  /// come out the same as with the sequential parse. Meshes are parsed
+  /// sequentially when TINYGLTF_ENABLE_DRACO is defined.
+  ///
+  void SetParallelSectionParsing(bool onoff) {
+    parallel_section_parsing_ = onoff;
+    if (onoff && !thread_pool_ && !owned_thread_pool_) {
+      owned_thread_pool_ = std::make_shared<ThreadPool>();
+    }
+  }
 
-#ifdef __clang__
-#pragma clang diagnostic pop  // -Wpadded
+  bool GetParallelSectionParsing() const { return parallel_section_parsing_; }
+
+  ///
+  /// Serialize large top-level arrays (accessors, nodes, meshes, bufferViews,
+  /// materials, animations, ...) in parallel chunks on the thread pool when
+  /// writing glTF. The chunks are spliced in order, so the output is the
+  /// same as with the sequential write. Large embedded buffers are base64
+  /// encoded in parallel pieces as well.
+  ///
+  void SetParallelSerialization(bool onoff) {
+    parallel_serialization_ = onoff;
+    if (onoff && !thread_pool_ && !owned_thread_pool_) {
+      owned_thread_pool_ = std::make_shared<ThreadPool>();
+    }
+  }
+
+  bool GetParallelSerialization() const { return parallel_serialization_; }
+
+  ///
+  /// Do not decode images while loading. `Image::image` keeps the encoded
+  /// file bytes instead (`Image::as_is` is set), borrowed from the buffer for
+  /// bufferView images. Only width, height, component and bits are read from
+  /// the image header (when stb_image is available). `component` and `bits`
+  /// describe the pixels DecodeImage() will produce.
+  ///
+  void SetLazyImageDecoding(bool onoff) { lazy_image_decoding_ = onoff; }
+
+  bool GetLazyImageDecoding() const { return lazy_image_decoding_; }
+
+  ///
+  /// Parse the JSON with a SAX parser which hands each element of the
+  /// top-level arrays (except `images`) to the section parser as soon as it
+  /// has been read, instead of building the DOM of the whole document first.
+  /// This lowers peak memory for large .gltf files. The resulting Model is
+  /// the same, but invalid elements are reported in document order rather
+  /// than section order. No effect with TINYGLTF_USE_RAPIDJSON.
+  ///
+  void SetStreamingJSONParse(bool onoff) { streaming_json_parse_ = onoff; }
+
+  bool GetStreamingJSONParse() const { return streaming_json_parse_; }
+
+  ///
+  /// Run ValidateModel() at the end of each load, on the thread pool when
+  /// one is set. A model which fails validation fails to load. The accessors
+  /// and bufferViews a section skip or scene filter left default constructed
+  /// are not checked.
+  ///
+  void SetValidateOnLoad(bool onoff) { validate_on_load_ = onoff; }
+
+  bool GetValidateOnLoad() const { return validate_on_load_; }
+
+  ///
+  /// Leave the sections in `sections` (a mask of SectionSkip) out of the
+  /// loaded Model. Their JSON is dropped while it is parsed (extras and
+  /// extensions only with the default JSON backend) and buffers which only
+  /// they use are not read. Indices into a skipped section, e.g.
+  /// Texture::source with SKIP_IMAGES, are kept as they are.
+  /// While a section skip or a scene filter is set, accessors, bufferViews
+  /// and buffers which nothing loaded references (extensions of loaded nodes,
+  /// meshes and primitives included) are left default constructed, and the
+  /// streaming JSON parse is not used.
+  ///
+  void SetSkipSections(unsigned int sections) { skip_sections_ = sections; }
+
+  unsigned int GetSkipSections() const { return skip_sections_; }
+
+  ///
+  /// Load only what scene `scene` reaches: its nodes and their children,
+  /// meshes, skins, cameras, materials, textures, images, the animations
+  /// targeting them and the accessors, bufferViews and buffers behind all of
+  /// these. The other elements are left default constructed so that indices
+  /// stay valid, and buffers nothing loaded references are never read.
+  /// `Model::defaultScene` is set to `scene`. -1 (the default) loads all
+  /// scenes.
+  ///
+  void SetSceneFilter(int scene) { scene_filter_ = scene; }
+
+  int GetSceneFilter() const { return scene_filter_; }
+
+  ///
+  /// Decode image `idx` of a model loaded with lazy image decoding, using the
+  /// configured image loader. Images which are already decoded are skipped.
+  ///
+  bool DecodeImage(Model *model, int idx, std::string *err,
+                   std::string *warn);
+
+  ///
+  /// Decode all lazily loaded images of `model`. Runs on `pool` when given,
+  /// unless a user image loader was not registered as thread-safe.
+  /// Errors and warnings are reported in image order.
+  ///
+  bool DecodeAllImages(Model *model, std::string *err, std::string *warn,
+                       ThreadPool *pool = nullptr);
+
+ private:
+  ///
+  /// Per-load state. It lives on the stack of each Load* call so that one
+  /// TinyGLTF instance can serve concurrent loads from several threads.
+  ///
+  struct LoadContext {
+    const unsigned char *bin_data = nullptr;
+    size_t bin_size = 0;
+    bool is_binary = false;
+    std::shared_ptr<const void> bin_owner;  // Keeps `bin_data` alive when set.
+    FsCallbacks *fs = nullptr;  // Overrides `fs` for external files when set.
+    bool metadata_only = false;  // No buffer or image payloads are read.
+  };
+
+  ///
+  /// Loads glTF asset from string(memory).
+  /// `length` = strlen(str);
+  /// Set warning message to `warn` for example it fails to load asserts
+  /// Returns false and set error string to `err` if there's an error.
+  ///
+  bool LoadFromString(Model *model, std::string *err, std::string *warn,
+                      const char *str, const unsigned int length,
+                      const std::string &base_dir, unsigned int check_sections,
+                      const LoadContext &ctx);
+
+  ///
+  /// Loads glTF binary asset from memory. `ctx.bin_owner` (may be null) keeps
+  /// `bytes` alive; buffers then borrow the BIN chunk instead of copying it.
+  ///
+  bool LoadBinaryFromMemory(Model *model, std::string *err, std::string *warn,
+                            const unsigned char *bytes, unsigned int length,
+                            const std::string &base_dir,
+                            unsigned int check_sections, LoadContext ctx);
+
+  struct GlbSegments;
+
+  ///
+  /// Serializes `model` for WriteGlbSceneTo* into `glb`.
+  ///
+  bool BuildMergedGlb(const Model *model, GlbSegments *glb, std::string *err);
+
+  ///
+  /// Loads one file for LoadMany(), reading through `file_fs`.
+  ///
+  void LoadOne(LoadResult *result, unsigned int check_sections,
+               FsCallbacks *file_fs);
+
+  bool serialize_default_values_ = false;  ///< Serialize default values?
+
+  bool store_original_json_for_extras_and_extensions_ = false;
+
+  bool preserve_image_channels_ = false;  /// Default false(expand channels to
+                                          /// RGBA) for backward compatibility.
+
+  bool memory_map_binary_files_ = false;
+
+  bool store_data_uris_ = false;
+
+  bool parallel_image_decoding_ = false;
+  bool parallel_section_parsing_ = false;
+  bool parallel_serialization_ = false;
+  bool lazy_image_decoding_ = false;
+  bool streaming_json_parse_ = false;
+  bool validate_on_load_ = false;
+  unsigned int skip_sections_ = SKIP_NONE;
+  int scene_filter_ = -1;
+  ThreadPool *thread_pool_ = nullptr;
+  std::shared_ptr<ThreadPool> owned_thread_pool_;
+#ifdef TINYGLTF_USE_ARENA
+  Arena *arena_ = nullptr;
+#endif
+
+  // Warning & error messages
+  std::string warn_;
+  std::string err_;
+
+  FsCallbacks fs = {
+#ifndef TINYGLTF_NO_FS
+      &tinygltf::FileExists, &tinygltf::ExpandFilePath,
+      &tinygltf::ReadWholeFile, &tinygltf::WriteWholeFile,
+
+      nullptr  // Fs callback user data
+#else
+      nullptr, nullptr, nullptr, nullptr,
+
+      nullptr  // Fs callback user data
+#endif
+  };
+
+  URICallbacks uri_cb = {
+      // Use paths as-is by default. This will use JSON string escaping.
+      nullptr,
+      // Decode all URIs before using them as paths as the application may have
+      // percent encoded them.
+      &tinygltf::URIDecode,
+      // URI callback user data
+      nullptr};
+
+  LoadImageDataFunction LoadImageData =
+#ifndef TINYGLTF_NO_STB_IMAGE
+      &tinygltf::LoadImageData;
+#else
+      nullptr;
+#endif
+  void *load_image_user_data_{nullptr};
+  bool user_image_loader_{false};
+  bool user_image_loader_thread_safe_{false};
+
+  WriteImageDataFunction WriteImageData =
+#ifndef TINYGLTF_NO_STB_IMAGE_WRITE
+      &tinygltf::WriteImageData;
+#else
+      nullptr;
+#endif
+  void *write_image_user_data_{nullptr};
+};
+
+#ifdef __clang__
+#pragma clang diagnostic pop  // -Wpadded
 #endif
 
 }  // namespace tinygltf
@@ -1697,6 +3336,34 @@ class TinyGLTF {
 //#include <wordexp.h>
 #endif
 
+// SIMD kernels are compiled with per-function target attributes and selected
+// at runtime, so no special compiler flags are required.
+// Define TINYGLTF_NO_SIMD to always use the scalar code paths.
+#if !defined(TINYGLTF_NO_SIMD) &&                          \
+    (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+     defined(_M_IX86))
+#define TINYGLTF_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TINYGLTF_TARGET_SSE41
+#define TINYGLTF_TARGET_AVX2
+#else
+#define TINYGLTF_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TINYGLTF_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+#endif
+
+#if !defined(_WIN32) && !defined(TINYGLTF_NO_FS)
+// MapWholeFile, ReadGlbJsonChunk, WriteGlbSceneToFile
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 #if defined(__sparcv9) || defined(__powerpc__)
 // Big endian
 #else
@@ -1722,12 +3389,13 @@ rapidjson::CrtAllocator s_CrtAllocator;  // stateless and thread safe
 rapidjson::CrtAllocator &GetAllocator() { return s_CrtAllocator; }
 #else
 // This uses the default RapidJSON MemoryPoolAllocator.  It is very fast, but
-// not thread safe. Only a single JsonDocument may be active at any one time,
-// meaning only a single gltf load/save can be active any one time.
+// not thread safe. Only a single JsonDocument may be active at any one time
+// per thread, meaning only a single gltf load/save can be active at any one
+// time on each thread.
 using json = rapidjson::Value;
 using json_const_iterator = json::ConstMemberIterator;
 using json_const_array_iterator = json const *;
-rapidjson::Document *s_pActiveDocument = nullptr;
+thread_local rapidjson::Document *s_pActiveDocument = nullptr;
 rapidjson::Document::AllocatorType &GetAllocator() {
   assert(s_pActiveDocument);  // Root json node must be JsonDocument type
   return s_pActiveDocument->GetAllocator();
@@ -1743,8 +3411,9 @@ struct JsonDocument : public rapidjson::Document {
   JsonDocument() {
     assert(s_pActiveDocument ==
            nullptr);  // When using default allocator, only one document can be
-                      // active at a time, if you need multiple active at once,
-                      // define TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
+                      // active at a time on each thread, if you need multiple
+                      // active at once, define
+                      // TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
     s_pActiveDocument = this;
   }
   JsonDocument(const JsonDocument &) = delete;
@@ -1776,15 +3445,189 @@ using json_const_array_iterator = json_const_iterator;
 using JsonDocument = json;
 #endif
 
+///
+/// Returns true for the object members JsonParse should leave out of the
+/// DOM. `depth` is the number of enclosing containers, 1 for the members of
+/// the root object.
+///
+using JsonKeyFilter = std::function<bool(int depth, const std::string &key)>;
+
 void JsonParse(JsonDocument &doc, const char *str, size_t length,
-               bool throwExc = false) {
+               bool throwExc = false,
+               const JsonKeyFilter &drop_key = nullptr) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   (void)throwExc;
+  (void)drop_key;
   doc.Parse(str, length);
 #else
-  doc = detail::json::parse(str, str + length, nullptr, throwExc);
+  if (drop_key) {
+    // The callback parser never builds the values of dropped members.
+    doc = detail::json::parse(
+        str, str + length,
+        [&drop_key](int depth, json::parse_event_t event, json &parsed) {
+          return (event != json::parse_event_t::key) ||
+                 !drop_key(depth, parsed.get_ref<const std::string &>());
+        },
+        throwExc);
+  } else {
+    doc = detail::json::parse(str, str + length, nullptr, throwExc);
+  }
 #endif
 }
+
+#ifndef TINYGLTF_USE_RAPIDJSON
+///
+/// SAX handler which builds the root DOM like JsonParse does, except for the
+/// elements of the top-level arrays selected by `is_streamed`. Each of those
+/// elements is built on its own and handed to `on_element` as soon as it is
+/// complete, then released, so only one element is held in memory at a time.
+/// The streamed arrays are left empty in the root DOM.
+///
+class StreamingJsonParser {
+ public:
+  using IsStreamedFunction = std::function<bool(const std::string &)>;
+  using ElementFunction =
+      std::function<bool(const std::string &section, const json &element)>;
+
+  StreamingJsonParser(JsonDocument &doc, IsStreamedFunction is_streamed,
+                      ElementFunction on_element)
+      : root_parser_(doc, false),
+        is_streamed_(std::move(is_streamed)),
+        on_element_(std::move(on_element)) {}
+
+  // Returns true when parsing failed because of malformed JSON, as opposed
+  // to `on_element` rejecting an element.
+  bool HasParseError() const { return has_parse_error_; }
+  const std::string &GetParseError() const { return parse_error_; }
+
+  bool null() { return Value([](Parser &p) { return p.null(); }); }
+
+  bool boolean(bool val) {
+    return Value([val](Parser &p) { return p.boolean(val); });
+  }
+
+  bool number_integer(json::number_integer_t val) {
+    return Value([val](Parser &p) { return p.number_integer(val); });
+  }
+
+  bool number_unsigned(json::number_unsigned_t val) {
+    return Value([val](Parser &p) { return p.number_unsigned(val); });
+  }
+
+  bool number_float(json::number_float_t val, const json::string_t &s) {
+    return Value([val, &s](Parser &p) { return p.number_float(val, s); });
+  }
+
+  bool string(json::string_t &val) {
+    return Value([&val](Parser &p) { return p.string(val); });
+  }
+
+  bool binary(json::binary_t &val) {
+    return Value([&val](Parser &p) { return p.binary(val); });
+  }
+
+  bool start_object(std::size_t len) {
+    if (InElements()) {
+      BeginElement();
+    }
+    ++depth_;
+    return Target().start_object(len);
+  }
+
+  bool key(json::string_t &val) {
+    if (depth_ == 1) {
+      key_ = val;
+    }
+    return Target().key(val);
+  }
+
+  bool end_object() {
+    const bool ret = Target().end_object();
+    --depth_;
+    return ret && EndContainer();
+  }
+
+  bool start_array(std::size_t len) {
+    if (InElements()) {
+      BeginElement();
+    } else if ((depth_ == 1) && !key_.empty() && is_streamed_(key_)) {
+      // Keep an empty array in the root DOM so the section is still present.
+      streaming_ = true;
+      ++depth_;
+      return root_parser_.start_array(0);
+    }
+    ++depth_;
+    return Target().start_array(len);
+  }
+
+  bool end_array() {
+    if (streaming_ && (depth_ == 2)) {
+      streaming_ = false;
+      --depth_;
+      return root_parser_.end_array();
+    }
+    const bool ret = Target().end_array();
+    --depth_;
+    return ret && EndContainer();
+  }
+
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &ex) {
+    has_parse_error_ = true;
+    parse_error_ = ex.what();
+    return false;
+  }
+
+ private:
+  using Parser = nlohmann::detail::json_sax_dom_parser<json>;
+
+  // True while directly inside a streamed array.
+  bool InElements() const { return streaming_ && (depth_ == 2); }
+
+  Parser &Target() { return element_parser_ ? *element_parser_ : root_parser_; }
+
+  void BeginElement() {
+    element_ = json();
+    element_parser_.reset(new Parser(element_, false));
+  }
+
+  bool EndElement() {
+    element_parser_.reset();
+    const bool ret = on_element_(key_, element_);
+    element_ = json();
+    return ret;
+  }
+
+  // Called after a container was closed.
+  bool EndContainer() {
+    if (element_parser_ && InElements()) {
+      return EndElement();
+    }
+    return true;
+  }
+
+  template <typename Fn>
+  bool Value(const Fn &fn) {
+    if (InElements()) {
+      // A scalar element; the section parser reports it as invalid.
+      BeginElement();
+      return fn(*element_parser_) && EndElement();
+    }
+    return fn(Target());
+  }
+
+  Parser root_parser_;
+  std::unique_ptr<Parser> element_parser_;
+  json element_;
+  IsStreamedFunction is_streamed_;
+  ElementFunction on_element_;
+  std::string key_;
+  int depth_ = 0;
+  bool streaming_ = false;
+  bool has_parse_error_ = false;
+  std::string parse_error_;
+};
+#endif
 }  // namespace
 }
 
@@ -1826,8 +3669,8 @@ static bool Equals(const tinygltf::Value &one, const tinygltf::Value &other) {
     case INT_TYPE:
       return one.Get<int>() == other.Get<int>();
     case OBJECT_TYPE: {
-      auto oneObj = one.Get<tinygltf::Value::Object>();
-      auto otherObj = other.Get<tinygltf::Value::Object>();
+      const auto &oneObj = one.Get<tinygltf::Value::Object>();
+      const auto &otherObj = other.Get<tinygltf::Value::Object>();
       if (oneObj.size() != otherObj.size()) return false;
       for (auto &it : oneObj) {
         auto otherIt = otherObj.find(it.first);
@@ -1865,6 +3708,17 @@ static bool Equals(const std::vector<double> &one,
   return true;
 }
 
+#ifdef TINYGLTF_COMPACT_NODE
+template <typename T, size_t N>
+static bool Equals(const InlineArray<T, N> &one, const InlineArray<T, N> &other) {
+  if (one.size() != other.size()) return false;
+  for (size_t i = 0; i < one.size(); ++i) {
+    if (!TINYGLTF_DOUBLE_EQUAL(one[i], other[i])) return false;
+  }
+  return true;
+}
+#endif
+
 bool Accessor::operator==(const Accessor &other) const {
   return this->bufferView == other.bufferView &&
          this->byteOffset == other.byteOffset &&
@@ -2069,86 +3923,354 @@ bool Value::operator==(const Value &other) const {
   return Equals(*this, other);
 }
 
-static void swap4(unsigned int *val) {
-#ifdef TINYGLTF_LITTLE_ENDIAN
-  (void)val;
-#else
-  unsigned int tmp = *val;
-  unsigned char *dst = reinterpret_cast<unsigned char *>(val);
-  unsigned char *src = reinterpret_cast<unsigned char *>(&tmp);
+static const char *const kAttributeSemanticNames[] = {
+    "", "POSITION", "NORMAL", "TANGENT", "TEXCOORD", "COLOR", "JOINTS", "WEIGHTS"};
 
-  dst[0] = src[3];
-  dst[1] = src[2];
-  dst[2] = src[1];
-  dst[3] = src[0];
-#endif
-}
+// Encodes the standard glTF semantics. POSITION, NORMAL and TANGENT take no
+// set index, the others need a "_<n>" suffix without leading zeros so that
+// the name round-trips through AttributeKey::Name().
+static bool ParseStandardAttributeName(const char *name, size_t len,
+                                       uint32_t *id) {
+  for (uint32_t semantic = AttributeKey::POSITION;
+       semantic <= AttributeKey::WEIGHTS; semantic++) {
+    const char *prefix = kAttributeSemanticNames[semantic];
+    const size_t prefix_len = strlen(prefix);
+    if (len < prefix_len || memcmp(name, prefix, prefix_len) != 0) continue;
 
-static std::string JoinPath(const std::string &path0,
-                            const std::string &path1) {
-  if (path0.empty()) {
-    return path1;
-  } else {
-    // check '/'
-    char lastChar = *path0.rbegin();
-    if (lastChar != '/') {
-      return path0 + std::string("/") + path1;
-    } else {
-      return path0 + path1;
+    if (semantic <= AttributeKey::TANGENT) {
+      if (len != prefix_len) return false;
+      (*id) = semantic << 16;
+      return true;
+    }
+
+    const char *digits = name + prefix_len + 1;
+    const size_t num_digits = len - prefix_len - 1;
+    if (len <= prefix_len + 1 || name[prefix_len] != '_' || num_digits > 5 ||
+        (digits[0] == '0' && num_digits > 1)) {
+      return false;
     }
+    uint32_t set_index = 0;
+    for (size_t i = 0; i < num_digits; i++) {
+      if (digits[i] < '0' || digits[i] > '9') return false;
+      set_index = set_index * 10 + uint32_t(digits[i] - '0');
+    }
+    if (set_index > 0xffffu) return false;
+    (*id) = (semantic << 16) | set_index;
+    return true;
   }
+  return false;
 }
 
-static std::string FindFile(const std::vector<std::string> &paths,
-                            const std::string &filepath, FsCallbacks *fs) {
-  if (fs == nullptr || fs->ExpandFilePath == nullptr ||
-      fs->FileExists == nullptr) {
-    // Error, fs callback[s] missing
-    return std::string();
-  }
+void AttributeKey::SetName(const char *name, size_t len) {
+  if (ParseStandardAttributeName(name, len, &id_)) return;
 
-  for (size_t i = 0; i < paths.size(); i++) {
-    std::string absPath =
-        fs->ExpandFilePath(JoinPath(paths[i], filepath), fs->user_data);
-    if (fs->FileExists(absPath, fs->user_data)) {
-      return absPath;
-    }
+  // 31 bit FNV-1a, the top bit marks the key as custom.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
   }
-
-  return std::string();
+  id_ = kCustomBit | (hash & ~kCustomBit);
+  custom_.reset(new std::string(name, len));
 }
 
-static std::string GetFilePathExtension(const std::string &FileName) {
-  if (FileName.find_last_of(".") != std::string::npos)
-    return FileName.substr(FileName.find_last_of(".") + 1);
-  return "";
+AttributeKey::AttributeKey(const std::string &name) {
+  SetName(name.data(), name.size());
 }
 
-static std::string GetBaseDir(const std::string &filepath) {
-  if (filepath.find_last_of("/\\") != std::string::npos)
-    return filepath.substr(0, filepath.find_last_of("/\\"));
-  return "";
+AttributeKey::AttributeKey(const char *name) {
+  SetName(name ? name : "", name ? strlen(name) : 0);
 }
 
-static std::string GetBaseFilename(const std::string &filepath) {
-  auto idx = filepath.find_last_of("/\\");
-  if (idx != std::string::npos) return filepath.substr(idx + 1);
-  return filepath;
+AttributeKey AttributeKey::Find(const std::string &name) {
+  return AttributeKey(name);
 }
 
-std::string base64_encode(unsigned char const *, unsigned int len);
-std::string base64_decode(std::string const &s);
-
-/*
-   base64.cpp and base64.h
+AttributeKey AttributeKey::Find(const char *name) { return AttributeKey(name); }
 
-   Copyright (C) 2004-2008 René Nyffenegger
+std::string AttributeKey::Name() const {
+  if (id_ & kCustomBit) return custom_ ? *custom_ : std::string();
 
-   This source code is provided 'as-is', without any express or implied
-   warranty. In no event will the author be held liable for any damages
-   arising from the use of this software.
+  const uint32_t semantic = id_ >> 16;
+  if (semantic > WEIGHTS) return std::string();
+  std::string name = kAttributeSemanticNames[semantic];
+  if (semantic > TANGENT) {
+    name += "_" + std::to_string(id_ & 0xffffu);
+  }
+  return name;
+}
 
-   Permission is granted to anyone to use this software for any purpose,
+bool GetAccessorLayout(const Model &model, int accessorIndex,
+                       AccessorLayout *layout, std::string *err) {
+  const std::string prefix = "accessor[" + std::to_string(accessorIndex) + "] ";
+  if (accessorIndex < 0 || size_t(accessorIndex) >= model.accessors.size()) {
+    if (err) {
+      (*err) += prefix + "does not exist.\n";
+    }
+    return false;
+  }
+  const Accessor &accessor = model.accessors[size_t(accessorIndex)];
+
+  AccessorLayout out;
+  out.count = accessor.count;
+  out.componentType = accessor.componentType;
+  out.numComponents =
+      GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+  out.normalized = accessor.normalized;
+  const int component_size =
+      GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+  if (component_size <= 0 || out.numComponents <= 0) {
+    if (err) {
+      (*err) += prefix + "has an invalid componentType or type.\n";
+    }
+    return false;
+  }
+  // Matrix columns of 1 and 2 byte components are padded to 4 bytes, which
+  // the packed element model below does not describe.
+  if ((accessor.type == TINYGLTF_TYPE_MAT2 && component_size == 1) ||
+      (accessor.type == TINYGLTF_TYPE_MAT3 && component_size <= 2)) {
+    if (err) {
+      (*err) += prefix + "uses a padded matrix layout, which is unsupported.\n";
+    }
+    return false;
+  }
+  const size_t element_size = out.ElementSize();
+
+  // Returns the bytes of `model.bufferViews[index]`, or nullptr.
+  auto ViewBytes = [&model](int index,
+                            size_t *length) -> const unsigned char * {
+    if (index < 0 || size_t(index) >= model.bufferViews.size()) return nullptr;
+    const BufferView &view = model.bufferViews[size_t(index)];
+    if (view.buffer < 0 || size_t(view.buffer) >= model.buffers.size()) {
+      return nullptr;
+    }
+    const Buffer &buffer = model.buffers[size_t(view.buffer)];
+    if (view.byteOffset > buffer.data.size() ||
+        view.byteLength > buffer.data.size() - view.byteOffset) {
+      return nullptr;
+    }
+    (*length) = view.byteLength;
+    return buffer.data.data() + view.byteOffset;
+  };
+
+  if (accessor.bufferView >= 0) {
+    size_t view_length = 0;
+    const unsigned char *view_data =
+        ViewBytes(accessor.bufferView, &view_length);
+    if (!view_data) {
+      if (err) {
+        (*err) += prefix + "references an invalid bufferView or buffer " +
+                  "range.\n";
+      }
+      return false;
+    }
+    const int stride = accessor.ByteStride(
+        model.bufferViews[size_t(accessor.bufferView)]);
+    if (stride <= 0) {
+      if (err) {
+        (*err) += prefix + "has an invalid byteStride.\n";
+      }
+      return false;
+    }
+    out.stride = size_t(stride);
+    if (out.count > 0) {
+      const bool fits =
+          accessor.byteOffset <= view_length &&
+          element_size <= view_length - accessor.byteOffset &&
+          (out.count - 1) <=
+              (view_length - accessor.byteOffset - element_size) / out.stride;
+      if (!fits) {
+        if (err) {
+          (*err) += prefix + "range exceeds its bufferView.\n";
+        }
+        return false;
+      }
+    }
+    out.data = view_data + accessor.byteOffset;
+  } else {
+    out.stride = element_size;
+  }
+
+  if (accessor.sparse.isSparse) {
+    const size_t sparse_count =
+        accessor.sparse.count > 0 ? size_t(accessor.sparse.count) : 0;
+    const int index_type = accessor.sparse.indices.componentType;
+    const int index_size =
+        GetComponentSizeInBytes(static_cast<uint32_t>(index_type));
+    if (sparse_count == 0 || sparse_count > out.count ||
+        (index_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE &&
+         index_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT &&
+         index_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)) {
+      if (err) {
+        (*err) += prefix + "has an invalid sparse count or indices type.\n";
+      }
+      return false;
+    }
+
+    size_t indices_length = 0;
+    size_t values_length = 0;
+    const unsigned char *indices =
+        ViewBytes(accessor.sparse.indices.bufferView, &indices_length);
+    const unsigned char *values =
+        ViewBytes(accessor.sparse.values.bufferView, &values_length);
+    const size_t indices_offset =
+        size_t(std::max(accessor.sparse.indices.byteOffset, 0));
+    const size_t values_offset =
+        size_t(std::max(accessor.sparse.values.byteOffset, 0));
+    if (!indices || !values || indices_offset > indices_length ||
+        (indices_length - indices_offset) / size_t(index_size) <
+            sparse_count ||
+        values_offset > values_length ||
+        (values_length - values_offset) / element_size < sparse_count) {
+      if (err) {
+        (*err) += prefix + "sparse range exceeds its bufferView.\n";
+      }
+      return false;
+    }
+    out.sparseCount = sparse_count;
+    out.sparseIndices = indices + indices_offset;
+    out.sparseIndicesComponentType = index_type;
+    out.sparseValues = values + values_offset;
+
+    // Always walked, even for a validated model: the writes of the sparse
+    // overlay rely on them and the walk is only O(sparse count).
+    for (size_t i = 0; i < sparse_count; i++) {
+      const size_t index = out.SparseIndex(i);
+      if (index >= out.count || (i > 0 && index <= out.SparseIndex(i - 1))) {
+        if (err) {
+          (*err) += prefix + "sparse indices must be increasing and less " +
+                    "than count.\n";
+        }
+        return false;
+      }
+    }
+  }
+
+  if (layout) (*layout) = out;
+  return true;
+}
+
+static void swap4(unsigned int *val) {
+#ifdef TINYGLTF_LITTLE_ENDIAN
+  (void)val;
+#else
+  unsigned int tmp = *val;
+  unsigned char *dst = reinterpret_cast<unsigned char *>(val);
+  unsigned char *src = reinterpret_cast<unsigned char *>(&tmp);
+
+  dst[0] = src[3];
+  dst[1] = src[2];
+  dst[2] = src[1];
+  dst[3] = src[0];
+#endif
+}
+
+static std::string JoinPath(const std::string &path0,
+                            const std::string &path1) {
+  if (path0.empty()) {
+    return path1;
+  } else {
+    // check '/'
+    char lastChar = *path0.rbegin();
+    if (lastChar != '/') {
+      return path0 + std::string("/") + path1;
+    } else {
+      return path0 + path1;
+    }
+  }
+}
+
+static std::string FindFile(const std::vector<std::string> &paths,
+                            const std::string &filepath, FsCallbacks *fs) {
+  if (fs == nullptr || fs->ExpandFilePath == nullptr ||
+      fs->FileExists == nullptr) {
+    // Error, fs callback[s] missing
+    return std::string();
+  }
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    std::string absPath =
+        fs->ExpandFilePath(JoinPath(paths[i], filepath), fs->user_data);
+    if (fs->FileExists(absPath, fs->user_data)) {
+      return absPath;
+    }
+  }
+
+  return std::string();
+}
+
+static std::string GetFilePathExtension(const std::string &FileName) {
+  if (FileName.find_last_of(".") != std::string::npos)
+    return FileName.substr(FileName.find_last_of(".") + 1);
+  return "";
+}
+
+static std::string GetBaseDir(const std::string &filepath) {
+  if (filepath.find_last_of("/\\") != std::string::npos)
+    return filepath.substr(0, filepath.find_last_of("/\\"));
+  return "";
+}
+
+static std::string GetBaseFilename(const std::string &filepath) {
+  auto idx = filepath.find_last_of("/\\");
+  if (idx != std::string::npos) return filepath.substr(idx + 1);
+  return filepath;
+}
+
+#ifdef TINYGLTF_X86_SIMD
+enum SimdLevel { kSimdNone = 0, kSimdSSE41 = 1, kSimdAVX2 = 2 };
+
+static int DetectSimdLevel() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  if (max_leaf < 1) {
+    return kSimdNone;
+  }
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  const bool f16c = (info[2] & (1 << 29)) != 0;
+  bool avx2 = false;
+  // AVX2 also requires the OS to save the YMM registers.
+  if ((max_leaf >= 7) && osxsave && avx && f16c &&
+      ((_xgetbv(0) & 6) == 6)) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+#else
+  __builtin_cpu_init();
+  const bool sse41 = __builtin_cpu_supports("sse4.1");
+  // Every AVX2 CPU also has F16C; the AVX2 kernels rely on both.
+  const bool avx2 =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+  return avx2 ? kSimdAVX2 : (sse41 ? kSimdSSE41 : kSimdNone);
+}
+
+// Instruction set available on the running CPU. Detected once.
+static int GetSimdLevel() {
+  static const int level = DetectSimdLevel();
+  return level;
+}
+#endif
+
+std::string base64_encode(unsigned char const *, unsigned int len);
+size_t base64_encode(const unsigned char *in, size_t len, char *out);
+std::string base64_decode(std::string const &s);
+size_t base64_decode(const char *in, size_t len, unsigned char *out);
+
+/*
+   base64.cpp and base64.h
+
+   Copyright (C) 2004-2008 René Nyffenegger
+
+   This source code is provided 'as-is', without any express or implied
+   warranty. In no event will the author be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
    including commercial applications, and to alter it and redistribute it
    freely, subject to the following restrictions:
 
@@ -2172,108 +4294,1569 @@ std::string base64_decode(std::string const &s);
 #pragma clang diagnostic ignored "-Wconversion"
 #endif
 
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
+// Modified: the encoder below writes into a pre-sized buffer and has
+// SSE4.1/AVX2 kernels. Its output is that of the original encoder.
+
+static const char kBase64EncodeTable[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+#ifdef TINYGLTF_X86_SIMD
+// Vectorized encoding after W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions". 12 input bytes are spread over the four
+// 32-bit words of a register, split into sextets and mapped to characters by
+// adding a per range offset.
+TINYGLTF_TARGET_SSE41
+static void base64_encode_sse41(const unsigned char *in, size_t len,
+                                char *out, size_t *in_pos, size_t *out_pos) {
+  const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10,
+                                       9, 11, 10);
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  size_t i = *in_pos;
+  size_t o = *out_pos;
+  // 16 bytes are loaded for the 12 which are encoded.
+  while (i + 16 <= len) {
+    const __m128i words = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), spread);
+    const __m128i ac =
+        _mm_mulhi_epu16(_mm_and_si128(words, _mm_set1_epi32(0x0fc0fc00)),
+                        _mm_set1_epi32(0x04000040));
+    const __m128i bd =
+        _mm_mullo_epi16(_mm_and_si128(words, _mm_set1_epi32(0x003f03f0)),
+                        _mm_set1_epi32(0x01000010));
+    const __m128i sextets = _mm_or_si128(ac, bd);
+
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12, which
+    // selects the offset from sextet to character.
+    __m128i range = _mm_subs_epu8(sextets, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), sextets);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    const __m128i chars =
+        _mm_add_epi8(sextets, _mm_shuffle_epi8(offsets, range));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o), chars);
+    i += 12;
+    o += 16;
+  }
+  *in_pos = i;
+  *out_pos = o;
+}
+
+TINYGLTF_TARGET_AVX2
+static void base64_encode_avx2(const unsigned char *in, size_t len,
+                               char *out, size_t *in_pos, size_t *out_pos) {
+  const __m256i spread = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5,
+      4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i offsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  size_t i = *in_pos;
+  size_t o = *out_pos;
+  // Each 128-bit lane encodes 12 bytes, loaded as 16.
+  while (i + 28 <= len) {
+    const __m256i block = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12)), 1);
+    const __m256i words = _mm256_shuffle_epi8(block, spread);
+    const __m256i ac = _mm256_mulhi_epu16(
+        _mm256_and_si256(words, _mm256_set1_epi32(0x0fc0fc00)),
+        _mm256_set1_epi32(0x04000040));
+    const __m256i bd = _mm256_mullo_epi16(
+        _mm256_and_si256(words, _mm256_set1_epi32(0x003f03f0)),
+        _mm256_set1_epi32(0x01000010));
+    const __m256i sextets = _mm256_or_si256(ac, bd);
+
+    __m256i range = _mm256_subs_epu8(sextets, _mm256_set1_epi8(51));
+    const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), sextets);
+    range =
+        _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    const __m256i chars =
+        _mm256_add_epi8(sextets, _mm256_shuffle_epi8(offsets, range));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + o), chars);
+    i += 24;
+    o += 32;
+  }
+  *in_pos = i;
+  *out_pos = o;
+}
+#endif
+
+// Number of characters base64_encode() writes for `len` bytes.
+static inline size_t base64_encoded_size(size_t len) {
+  return ((len + 2) / 3) * 4;
+}
+
+// Encodes `len` bytes into `out`, which must have room for
+// base64_encoded_size(len) characters. Returns the number of characters
+// written.
+size_t base64_encode(const unsigned char *in, size_t len, char *out) {
+  size_t i = 0;
+  size_t o = 0;
+
+#ifdef TINYGLTF_X86_SIMD
+  const int simd = GetSimdLevel();
+  if (simd >= kSimdAVX2) {
+    base64_encode_avx2(in, len, out, &i, &o);
+  }
+  if (simd >= kSimdSSE41) {
+    base64_encode_sse41(in, len, out, &i, &o);
+  }
+#endif
+
+  const char *table = kBase64EncodeTable;
+  while (i + 3 <= len) {
+    const unsigned int bits =
+        (unsigned(in[i]) << 16) | (unsigned(in[i + 1]) << 8) | in[i + 2];
+    out[o] = table[bits >> 18];
+    out[o + 1] = table[(bits >> 12) & 0x3f];
+    out[o + 2] = table[(bits >> 6) & 0x3f];
+    out[o + 3] = table[bits & 0x3f];
+    i += 3;
+    o += 4;
+  }
+
+  // Trailing partial group, padded with '='.
+  if (i < len) {
+    const bool two = (i + 2 == len);
+    const unsigned int bits =
+        (unsigned(in[i]) << 16) | (two ? (unsigned(in[i + 1]) << 8) : 0u);
+    out[o] = table[bits >> 18];
+    out[o + 1] = table[(bits >> 12) & 0x3f];
+    out[o + 2] = two ? table[(bits >> 6) & 0x3f] : '=';
+    out[o + 3] = '=';
+    o += 4;
+  }
+
+  return o;
+}
+
+// Like base64_encode(), with large inputs split into pieces which are encoded
+// on `pool` if set.
+static size_t base64_encode(const unsigned char *in, size_t len, char *out,
+                            ThreadPool *pool) {
+  // A multiple of 3, so that only the last piece can be padded.
+  const size_t kPieceSize = 3 * 256 * 1024;
+  const size_t num_pieces = (len + kPieceSize - 1) / kPieceSize;
+  if (!pool || (num_pieces <= 1)) {
+    return base64_encode(in, len, out);
+  }
+  pool->ParallelFor(num_pieces, [&](size_t p) {
+    const size_t offset = p * kPieceSize;
+    base64_encode(in + offset, (std::min)(kPieceSize, len - offset),
+                  out + base64_encoded_size(offset));
+  });
+  return base64_encoded_size(len);
 }
 
 std::string base64_encode(unsigned char const *bytes_to_encode,
                           unsigned int in_len) {
   std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
+  ret.resize(base64_encoded_size(in_len));
+  if (!ret.empty()) {
+    base64_encode(bytes_to_encode, in_len, &ret[0]);
+  }
+  return ret;
+}
 
-  const char *base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
+// Modified: the decoder below is table driven and has SSE4.1/AVX2 kernels.
+// It keeps the semantics of the original decoder: decoding stops at the first
+// '=' or non-base64 character and a trailing partial quantum of `n` characters
+// yields `n - 1` bytes.
+
+// Sextet value of each base64 character, 255 for any other byte.
+static const unsigned char kBase64DecodeTable[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255,
+    255, 255, 255, 255, 255, 0, 1, 2, 3, 4, 5, 6,
+    7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+    19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
+    255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
+    37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
+    49, 50, 51, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255,
+};
 
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] =
-          ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] =
-          ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
+#ifdef TINYGLTF_X86_SIMD
+// Vectorized decoding after W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions". Each kernel consumes whole blocks of
+// valid characters and stops at the first block containing anything else,
+// leaving it to the scalar code.
+TINYGLTF_TARGET_SSE41
+static void base64_decode_sse41(const unsigned char *in, size_t len,
+                                unsigned char *out, size_t *in_pos,
+                                size_t *out_pos) {
+  const __m128i lut_lo =
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi =
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_0f = _mm_set1_epi8(0x0f);
+  const __m128i slash = _mm_set1_epi8(0x2f);
+  const __m128i merge_ab = _mm_set1_epi32(0x01400140);
+  const __m128i merge_abc = _mm_set1_epi32(0x00011000);
+  const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                     -1, -1, -1, -1);
+
+  size_t i = *in_pos;
+  size_t o = *out_pos;
+  while (i + 16 <= len) {
+    const __m128i str =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_0f);
+    const __m128i lo_nibbles = _mm_and_si128(str, mask_0f);
+    const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm_testz_si128(lo, hi)) {
+      break;
+    }
 
-      for (i = 0; (i < 4); i++) ret += base64_chars[char_array_4[i]];
-      i = 0;
+    // Map characters to sextets, then pack 16 sextets into 12 bytes.
+    const __m128i roll = _mm_shuffle_epi8(
+        lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(str, slash), hi_nibbles));
+    const __m128i sextets = _mm_add_epi8(str, roll);
+    const __m128i merged =
+        _mm_madd_epi16(_mm_maddubs_epi16(sextets, merge_ab), merge_abc);
+    const __m128i bytes = _mm_shuffle_epi8(merged, pack);
+
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + o), bytes);
+    const int tail = _mm_extract_epi32(bytes, 2);
+    memcpy(out + o + 8, &tail, 4);
+
+    i += 16;
+    o += 12;
+  }
+  *in_pos = i;
+  *out_pos = o;
+}
+
+TINYGLTF_TARGET_AVX2
+static void base64_decode_avx2(const unsigned char *in, size_t len,
+                               unsigned char *out, size_t *in_pos,
+                               size_t *out_pos) {
+  const __m256i lut_lo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+      0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i lut_hi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+      -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i mask_0f = _mm256_set1_epi8(0x0f);
+  const __m256i slash = _mm256_set1_epi8(0x2f);
+  const __m256i merge_ab = _mm256_set1_epi32(0x01400140);
+  const __m256i merge_abc = _mm256_set1_epi32(0x00011000);
+  const __m256i pack = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4,
+      10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+  size_t i = *in_pos;
+  size_t o = *out_pos;
+  while (i + 32 <= len) {
+    const __m256i str =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    const __m256i hi_nibbles =
+        _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_0f);
+    const __m256i lo_nibbles = _mm256_and_si256(str, mask_0f);
+    const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) {
+      break;
     }
+
+    const __m256i roll = _mm256_shuffle_epi8(
+        lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, slash), hi_nibbles));
+    const __m256i sextets = _mm256_add_epi8(str, roll);
+    const __m256i merged = _mm256_madd_epi16(
+        _mm256_maddubs_epi16(sextets, merge_ab), merge_abc);
+    // 12 bytes per 128-bit lane, moved next to each other.
+    const __m256i bytes = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(merged, pack), compact);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o),
+                     _mm256_castsi256_si128(bytes));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + o + 16),
+                     _mm256_extracti128_si256(bytes, 1));
+
+    i += 32;
+    o += 24;
   }
+  *in_pos = i;
+  *out_pos = o;
+}
+#endif
 
-  if (i) {
-    for (j = i; j < 3; j++) char_array_3[j] = '\0';
+// Upper bound of the number of bytes decoded from `len` base64 characters.
+static inline size_t base64_decoded_size_max(size_t len) {
+  return ((len + 3) / 4) * 3;
+}
 
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] =
-        ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] =
-        ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+// Decodes `len` base64 characters into `out`, which must have room for
+// base64_decoded_size_max(len) bytes. Returns the number of bytes written.
+size_t base64_decode(const char *encoded, size_t len, unsigned char *out) {
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(encoded);
+  size_t i = 0;
+  size_t o = 0;
 
-    for (j = 0; (j < i + 1); j++) ret += base64_chars[char_array_4[j]];
+#ifdef TINYGLTF_X86_SIMD
+  const int simd = GetSimdLevel();
+  if (simd >= kSimdAVX2) {
+    base64_decode_avx2(in, len, out, &i, &o);
+  }
+  if (simd >= kSimdSSE41) {
+    base64_decode_sse41(in, len, out, &i, &o);
+  }
+#endif
 
-    while ((i++ < 3)) ret += '=';
+  const unsigned char *table = kBase64DecodeTable;
+  while (i + 4 <= len) {
+    const unsigned char a = table[in[i]];
+    const unsigned char b = table[in[i + 1]];
+    const unsigned char c = table[in[i + 2]];
+    const unsigned char d = table[in[i + 3]];
+    if ((a | b | c | d) & 0x80) {
+      break;
+    }
+    out[o] = static_cast<unsigned char>((a << 2) | (b >> 4));
+    out[o + 1] = static_cast<unsigned char>((b << 4) | (c >> 2));
+    out[o + 2] = static_cast<unsigned char>((c << 6) | d);
+    i += 4;
+    o += 3;
   }
 
-  return ret;
+  // Trailing partial quantum, up to the first invalid character.
+  unsigned char sextets[4] = {0, 0, 0, 0};
+  size_t n = 0;
+  while ((i < len) && (n < 4) && !(table[in[i]] & 0x80)) {
+    sextets[n++] = table[in[i++]];
+  }
+  if (n >= 2) {
+    out[o++] =
+        static_cast<unsigned char>((sextets[0] << 2) | (sextets[1] >> 4));
+  }
+  if (n >= 3) {
+    out[o++] =
+        static_cast<unsigned char>((sextets[1] << 4) | (sextets[2] >> 2));
+  }
+
+  return o;
 }
 
 std::string base64_decode(std::string const &encoded_string) {
-  int in_len = static_cast<int>(encoded_string.size());
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
   std::string ret;
+  ret.resize(base64_decoded_size_max(encoded_string.size()));
+  if (!ret.empty()) {
+    ret.resize(base64_decode(encoded_string.data(), encoded_string.size(),
+                             reinterpret_cast<unsigned char *>(&ret[0])));
+  }
+  return ret;
+}
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+// Bulk accessor conversion. The accessor is processed as runs of tightly
+// packed components (strided elements are gathered into a scratch buffer
+// first) which the per component type kernels below convert.
+
+// glTF normalization of one component, identical to AccessorView.
+template <typename Src>
+static float NormalizeComponent(Src v) {
+  const float r = static_cast<float>(v) /
+                  static_cast<float>(std::numeric_limits<Src>::max());
+  return (r < -1.0f) ? -1.0f : r;
+}
+
+template <typename Src>
+static void ConvertToFloatScalar(const unsigned char *in, size_t n,
+                                 bool normalized, float *out) {
+  for (size_t i = 0; i < n; i++) {
+    Src v;
+    memcpy(&v, in + i * sizeof(Src), sizeof(Src));
+    out[i] = (normalized && std::is_integral<Src>::value)
+                 ? NormalizeComponent(v)
+                 : static_cast<float>(v);
+  }
+}
+
+template <typename Src>
+static void ConvertToInt32Scalar(const unsigned char *in, size_t n,
+                                 int32_t *out) {
+  for (size_t i = 0; i < n; i++) {
+    Src v;
+    memcpy(&v, in + i * sizeof(Src), sizeof(Src));
+    out[i] = static_cast<int32_t>(v);
+  }
+}
+
+// Round to nearest even, as F16C does. After F. Giesen's float_to_half.
+static uint16_t FloatToHalf(float value) {
+  uint32_t f;
+  memcpy(&f, &value, sizeof(f));
+  const uint32_t sign = f & 0x80000000u;
+  f ^= sign;
+
+  uint32_t h;
+  if (f >= 0x47800000u) {
+    // Too large for half: Inf, or NaN kept quiet.
+    h = (f > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+  } else if (f < 0x38800000u) {
+    // Subnormal or zero: let the FPU round by adding a magic number.
+    const uint32_t magic_bits = 0x3f000000u;
+    float magic;
+    memcpy(&magic, &magic_bits, sizeof(magic));
+    float sum;
+    memcpy(&sum, &f, sizeof(sum));
+    sum += magic;
+    memcpy(&h, &sum, sizeof(h));
+    h -= magic_bits;
+  } else {
+    const uint32_t mant_odd = (f >> 13) & 1u;
+    f += 0xc8000fffu;  // Rebias the exponent and add the rounding bias.
+    f += mant_odd;
+    h = f >> 13;
+  }
+  return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+#ifdef TINYGLTF_X86_SIMD
+// Widen 4 (SSE4.1) or 8 (AVX2) components to 32 bit integers. The second
+// argument only selects the overload.
+TINYGLTF_TARGET_SSE41
+static inline __m128i LoadEpi32x4(const unsigned char *p, int8_t) {
+  int32_t v;
+  memcpy(&v, p, sizeof(v));
+  return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(v));
+}
+TINYGLTF_TARGET_SSE41
+static inline __m128i LoadEpi32x4(const unsigned char *p, uint8_t) {
+  int32_t v;
+  memcpy(&v, p, sizeof(v));
+  return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v));
+}
+TINYGLTF_TARGET_SSE41
+static inline __m128i LoadEpi32x4(const unsigned char *p, int16_t) {
+  return _mm_cvtepi16_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+}
+TINYGLTF_TARGET_SSE41
+static inline __m128i LoadEpi32x4(const unsigned char *p, uint16_t) {
+  return _mm_cvtepu16_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+}
+TINYGLTF_TARGET_SSE41
+static inline __m128i LoadEpi32x4(const unsigned char *p, int32_t) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+TINYGLTF_TARGET_SSE41
+static inline __m128i LoadEpi32x4(const unsigned char *p, uint32_t) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+TINYGLTF_TARGET_SSE41
+static inline __m128 Epi32ToFloat(__m128i v, bool is_unsigned) {
+  if (!is_unsigned) return _mm_cvtepi32_ps(v);
+  // No unsigned conversion before AVX-512: convert the 16 bit halves, which
+  // are exact, so only the final add rounds.
+  const __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+  const __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(0xffff)));
+  return _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+}
+
+TINYGLTF_TARGET_AVX2
+static inline __m256i LoadEpi32x8(const unsigned char *p, int8_t) {
+  return _mm256_cvtepi8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+}
+TINYGLTF_TARGET_AVX2
+static inline __m256i LoadEpi32x8(const unsigned char *p, uint8_t) {
+  return _mm256_cvtepu8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+}
+TINYGLTF_TARGET_AVX2
+static inline __m256i LoadEpi32x8(const unsigned char *p, int16_t) {
+  return _mm256_cvtepi16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+TINYGLTF_TARGET_AVX2
+static inline __m256i LoadEpi32x8(const unsigned char *p, uint16_t) {
+  return _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+TINYGLTF_TARGET_AVX2
+static inline __m256i LoadEpi32x8(const unsigned char *p, int32_t) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+TINYGLTF_TARGET_AVX2
+static inline __m256i LoadEpi32x8(const unsigned char *p, uint32_t) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+TINYGLTF_TARGET_AVX2
+static inline __m256 Epi32ToFloat(__m256i v, bool is_unsigned) {
+  if (!is_unsigned) return _mm256_cvtepi32_ps(v);
+  const __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16));
+  const __m256 lo =
+      _mm256_cvtepi32_ps(_mm256_and_si256(v, _mm256_set1_epi32(0xffff)));
+  return _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo);
+}
+
+// Each kernel converts whole vectors and returns how many components it
+// consumed; the scalar code finishes the tail.
+template <typename Src>
+TINYGLTF_TARGET_SSE41 static size_t ConvertToFloatSSE41(
+    const unsigned char *in, size_t n, bool normalized, float *out) {
+  const bool is_unsigned = std::is_same<Src, uint32_t>::value;
+  const __m128 scale =
+      _mm_set1_ps(static_cast<float>(std::numeric_limits<Src>::max()));
+  const __m128 minus_one = _mm_set1_ps(-1.0f);
+  size_t i = 0;
+  if (!normalized) {
+    for (; i + 4 <= n; i += 4) {
+      const __m128i v = LoadEpi32x4(in + i * sizeof(Src), Src());
+      _mm_storeu_ps(out + i, Epi32ToFloat(v, is_unsigned));
+    }
+  } else {
+    for (; i + 4 <= n; i += 4) {
+      const __m128i v = LoadEpi32x4(in + i * sizeof(Src), Src());
+      __m128 f = _mm_div_ps(Epi32ToFloat(v, is_unsigned), scale);
+      if (std::is_signed<Src>::value) f = _mm_max_ps(f, minus_one);
+      _mm_storeu_ps(out + i, f);
+    }
+  }
+  return i;
+}
+
+template <typename Src>
+TINYGLTF_TARGET_AVX2 static size_t ConvertToFloatAVX2(const unsigned char *in,
+                                                      size_t n,
+                                                      bool normalized,
+                                                      float *out) {
+  const bool is_unsigned = std::is_same<Src, uint32_t>::value;
+  const __m256 scale =
+      _mm256_set1_ps(static_cast<float>(std::numeric_limits<Src>::max()));
+  const __m256 minus_one = _mm256_set1_ps(-1.0f);
+  size_t i = 0;
+  if (!normalized) {
+    for (; i + 8 <= n; i += 8) {
+      const __m256i v = LoadEpi32x8(in + i * sizeof(Src), Src());
+      _mm256_storeu_ps(out + i, Epi32ToFloat(v, is_unsigned));
+    }
+  } else {
+    for (; i + 8 <= n; i += 8) {
+      const __m256i v = LoadEpi32x8(in + i * sizeof(Src), Src());
+      __m256 f = _mm256_div_ps(Epi32ToFloat(v, is_unsigned), scale);
+      if (std::is_signed<Src>::value) f = _mm256_max_ps(f, minus_one);
+      _mm256_storeu_ps(out + i, f);
+    }
+  }
+  return i;
+}
+
+template <typename Src>
+TINYGLTF_TARGET_SSE41 static size_t ConvertToInt32SSE41(
+    const unsigned char *in, size_t n, int32_t *out) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     LoadEpi32x4(in + i * sizeof(Src), Src()));
+  }
+  return i;
+}
+
+template <typename Src>
+TINYGLTF_TARGET_AVX2 static size_t ConvertToInt32AVX2(const unsigned char *in,
+                                                      size_t n, int32_t *out) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        LoadEpi32x8(in + i * sizeof(Src), Src()));
+  }
+  return i;
+}
+
+TINYGLTF_TARGET_SSE41
+static size_t ConvertFloatToInt32SSE41(const unsigned char *in, size_t n,
+                                       int32_t *out) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 f =
+        _mm_loadu_ps(reinterpret_cast<const float *>(in + i * sizeof(float)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_cvttps_epi32(f));
+  }
+  return i;
+}
 
-  const std::string base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
+TINYGLTF_TARGET_AVX2
+static size_t ConvertFloatToInt32AVX2(const unsigned char *in, size_t n,
+                                      int32_t *out) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 f = _mm256_loadu_ps(
+        reinterpret_cast<const float *>(in + i * sizeof(float)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_cvttps_epi32(f));
+  }
+  return i;
+}
 
-  while (in_len-- && (encoded_string[in_] != '=') &&
-         is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_];
-    in_++;
-    if (i == 4) {
-      for (i = 0; i < 4; i++)
-        char_array_4[i] =
-            static_cast<unsigned char>(base64_chars.find(char_array_4[i]));
+TINYGLTF_TARGET_AVX2
+static size_t ConvertFloatToHalfAVX2(const float *in, size_t n,
+                                     uint16_t *out) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h =
+        _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), h);
+  }
+  return i;
+}
+#endif
 
-      char_array_3[0] =
-          (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] =
-          ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+template <typename Src>
+static void ConvertToFloat(const unsigned char *in, size_t n, bool normalized,
+                           float *out) {
+  size_t i = 0;
+#ifdef TINYGLTF_X86_SIMD
+  const int simd = GetSimdLevel();
+  if (simd >= kSimdAVX2) {
+    i = ConvertToFloatAVX2<Src>(in, n, normalized, out);
+  } else if (simd >= kSimdSSE41) {
+    i = ConvertToFloatSSE41<Src>(in, n, normalized, out);
+  }
+#endif
+  ConvertToFloatScalar<Src>(in + i * sizeof(Src), n - i, normalized, out + i);
+}
+
+template <typename Src>
+static void ConvertToInt32(const unsigned char *in, size_t n, int32_t *out) {
+  size_t i = 0;
+#ifdef TINYGLTF_X86_SIMD
+  const int simd = GetSimdLevel();
+  if (simd >= kSimdAVX2) {
+    i = ConvertToInt32AVX2<Src>(in, n, out);
+  } else if (simd >= kSimdSSE41) {
+    i = ConvertToInt32SSE41<Src>(in, n, out);
+  }
+#endif
+  ConvertToInt32Scalar<Src>(in + i * sizeof(Src), n - i, out + i);
+}
 
-      for (i = 0; (i < 3); i++) ret += char_array_3[i];
-      i = 0;
+// Converts `n` tightly packed components of `componentType`.
+static void ConvertComponents(const unsigned char *in, int componentType,
+                              bool normalized, size_t n, float *out) {
+  switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+      ConvertToFloat<int8_t>(in, n, normalized, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      ConvertToFloat<uint8_t>(in, n, normalized, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+      ConvertToFloat<int16_t>(in, n, normalized, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+      ConvertToFloat<uint16_t>(in, n, normalized, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_INT:
+      ConvertToFloat<int32_t>(in, n, normalized, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      ConvertToFloat<uint32_t>(in, n, normalized, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:
+      if (n > 0) memcpy(out, in, n * sizeof(float));
+      break;
+    case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+      ConvertToFloatScalar<double>(in, n, false, out);
+      break;
+    default:
+      break;
+  }
+}
+
+static void ConvertComponents(const unsigned char *in, int componentType,
+                              bool normalized, size_t n, int32_t *out) {
+  (void)normalized;
+  switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+      ConvertToInt32<int8_t>(in, n, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      ConvertToInt32<uint8_t>(in, n, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+      ConvertToInt32<int16_t>(in, n, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+      ConvertToInt32<uint16_t>(in, n, out);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_INT:
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      if (n > 0) memcpy(out, in, n * sizeof(int32_t));
+      break;
+    case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+      size_t i = 0;
+#ifdef TINYGLTF_X86_SIMD
+      const int simd = GetSimdLevel();
+      if (simd >= kSimdAVX2) {
+        i = ConvertFloatToInt32AVX2(in, n, out);
+      } else if (simd >= kSimdSSE41) {
+        i = ConvertFloatToInt32SSE41(in, n, out);
+      }
+#endif
+      ConvertToInt32Scalar<float>(in + i * sizeof(float), n - i, out + i);
+    } break;
+    case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+      ConvertToInt32Scalar<double>(in, n, out);
+      break;
+    default:
+      break;
+  }
+}
+
+// Half output goes through a small float buffer so the float kernels are
+// reused.
+static void ConvertComponents(const unsigned char *in, int componentType,
+                              bool normalized, size_t n, uint16_t *out) {
+  const size_t component_size =
+      size_t(GetComponentSizeInBytes(static_cast<uint32_t>(componentType)));
+  float buf[1024];
+  for (size_t first = 0; first < n; first += 1024) {
+    const size_t count = std::min(n - first, size_t(1024));
+    ConvertComponents(in + first * component_size, componentType, normalized,
+                      count, buf);
+    size_t i = 0;
+#ifdef TINYGLTF_X86_SIMD
+    if (GetSimdLevel() >= kSimdAVX2) {
+      i = ConvertFloatToHalfAVX2(buf, count, out + first);
+    }
+#endif
+    for (; i < count; i++) {
+      out[first + i] = FloatToHalf(buf[i]);
     }
   }
+}
+
+// Copies `n` elements of `kSize` bytes spaced `stride` apart into `dst`.
+template <size_t kSize>
+static void GatherElements(const unsigned char *src, size_t stride, size_t n,
+                           unsigned char *dst) {
+  for (size_t i = 0; i < n; i++, src += stride, dst += kSize) {
+    memcpy(dst, src, kSize);
+  }
+}
+
+static void GatherElements(const unsigned char *src, size_t stride,
+                           size_t element_size, size_t n, unsigned char *dst) {
+  switch (element_size) {
+    case 4:
+      GatherElements<4>(src, stride, n, dst);
+      break;
+    case 6:
+      GatherElements<6>(src, stride, n, dst);
+      break;
+    case 8:
+      GatherElements<8>(src, stride, n, dst);
+      break;
+    case 12:
+      GatherElements<12>(src, stride, n, dst);
+      break;
+    case 16:
+      GatherElements<16>(src, stride, n, dst);
+      break;
+    default:
+      for (size_t i = 0; i < n; i++) {
+        memcpy(dst + i * element_size, src + i * stride, element_size);
+      }
+      break;
+  }
+}
+
+// Writes element `i` of `values` to slot `indices[i]` of `dense`. Fixed
+// element sizes turn the copy into a couple of register moves; there is no
+// hardware scatter before AVX-512, and the sparse indices are already
+// validated by GetAccessorLayout().
+template <size_t kSize, typename Index>
+static void ScatterElements(const unsigned char *values,
+                            const unsigned char *indices, size_t n,
+                            unsigned char *dense) {
+  for (size_t i = 0; i < n; i++) {
+    Index index;
+    memcpy(&index, indices + i * sizeof(Index), sizeof(Index));
+    memcpy(dense + size_t(index) * kSize, values + i * kSize, kSize);
+  }
+}
+
+template <typename Index>
+static void ScatterElements(const unsigned char *values,
+                            const unsigned char *indices,
+                            size_t element_size, size_t n,
+                            unsigned char *dense) {
+  switch (element_size) {
+    case 1:
+      ScatterElements<1, Index>(values, indices, n, dense);
+      break;
+    case 2:
+      ScatterElements<2, Index>(values, indices, n, dense);
+      break;
+    case 3:
+      ScatterElements<3, Index>(values, indices, n, dense);
+      break;
+    case 4:
+      ScatterElements<4, Index>(values, indices, n, dense);
+      break;
+    case 6:
+      ScatterElements<6, Index>(values, indices, n, dense);
+      break;
+    case 8:
+      ScatterElements<8, Index>(values, indices, n, dense);
+      break;
+    case 12:
+      ScatterElements<12, Index>(values, indices, n, dense);
+      break;
+    case 16:
+      ScatterElements<16, Index>(values, indices, n, dense);
+      break;
+    case 64:
+      ScatterElements<64, Index>(values, indices, n, dense);
+      break;
+    default:
+      for (size_t i = 0; i < n; i++) {
+        Index index;
+        memcpy(&index, indices + i * sizeof(Index), sizeof(Index));
+        memcpy(dense + size_t(index) * element_size, values + i * element_size,
+               element_size);
+      }
+      break;
+  }
+}
+
+static void ScatterElements(const unsigned char *values,
+                            const unsigned char *indices,
+                            int indicesComponentType, size_t element_size,
+                            size_t n, unsigned char *dense) {
+  if (indicesComponentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
+    ScatterElements<uint8_t>(values, indices, element_size, n, dense);
+  } else if (indicesComponentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
+    ScatterElements<uint16_t>(values, indices, element_size, n, dense);
+  } else {
+    ScatterElements<uint32_t>(values, indices, element_size, n, dense);
+  }
+}
+
+// Converts the sparse values in batches that stay in L1 and scatters them
+// over `dense`, which holds count * components converted values.
+template <typename Out>
+static void ApplySparseOverlayComponents(const AccessorLayout &layout,
+                                         Out *dense) {
+  if (layout.sparseCount == 0) return;
+  const size_t num_components = size_t(layout.numComponents);
+  const size_t element_size = layout.ElementSize();
+  const size_t index_size = size_t(GetComponentSizeInBytes(
+      static_cast<uint32_t>(layout.sparseIndicesComponentType)));
+
+  Out buf[4096];
+  const size_t batch = 4096 / num_components;
+  for (size_t first = 0; first < layout.sparseCount; first += batch) {
+    const size_t n = std::min(batch, layout.sparseCount - first);
+    ConvertComponents(layout.sparseValues + first * element_size,
+                      layout.componentType, layout.normalized,
+                      n * num_components, buf);
+    ScatterElements(reinterpret_cast<const unsigned char *>(buf),
+                    layout.sparseIndices + first * index_size,
+                    layout.sparseIndicesComponentType,
+                    num_components * sizeof(Out), n,
+                    reinterpret_cast<unsigned char *>(dense));
+  }
+}
+
+void ApplySparseOverlay(const AccessorLayout &layout, unsigned char *dense) {
+  if (layout.sparseCount == 0) return;
+  ScatterElements(layout.sparseValues, layout.sparseIndices,
+                  layout.sparseIndicesComponentType, layout.ElementSize(),
+                  layout.sparseCount, dense);
+}
+
+void ApplySparseOverlay(const AccessorLayout &layout, float *dense) {
+  ApplySparseOverlayComponents(layout, dense);
+}
 
-  if (i) {
-    for (j = i; j < 4; j++) char_array_4[j] = 0;
+void ApplySparseOverlay(const AccessorLayout &layout, int32_t *dense) {
+  ApplySparseOverlayComponents(layout, dense);
+}
 
-    for (j = 0; j < 4; j++)
-      char_array_4[j] =
-          static_cast<unsigned char>(base64_chars.find(char_array_4[j]));
+void ApplySparseOverlayToHalf(const AccessorLayout &layout, uint16_t *dense) {
+  ApplySparseOverlayComponents(layout, dense);
+}
 
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] =
-        ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+void MaterializeSparseAccessor(const AccessorLayout &layout,
+                               unsigned char *out) {
+  const size_t element_size = layout.ElementSize();
+  if (!layout.data) {
+    if (layout.count > 0) memset(out, 0, layout.count * element_size);
+  } else if (layout.stride == element_size) {
+    if (layout.count > 0) memcpy(out, layout.data, layout.count * element_size);
+  } else {
+    GatherElements(layout.data, layout.stride, element_size, layout.count,
+                   out);
+  }
+  ApplySparseOverlay(layout, out);
+}
 
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+bool MaterializeSparseAccessor(const Model &model, int accessorIndex,
+                               std::vector<unsigned char> *out,
+                               std::string *err) {
+  AccessorLayout layout;
+  if (!GetAccessorLayout(model, accessorIndex, &layout, err)) return false;
+  if (out) {
+    out->resize(layout.count * layout.ElementSize());
+    MaterializeSparseAccessor(layout, out->data());
   }
+  return true;
+}
+
+// Accessor bounds. Components are processed as packed runs like the
+// conversion above. A vector register of W lanes sees component (lane % N)
+// only when W is a multiple of N, so the kernels keep lcm(N, W) / W
+// accumulators (3 for VEC3, 9 for MAT3) and fold lanes back to components
+// at the end.
+
+template <typename Src>
+static void AccessorBoundsScalar(const unsigned char *in, size_t n,
+                                 size_t num_components, double *mins,
+                                 double *maxs) {
+  for (size_t i = 0; i < n; i++) {
+    Src v;
+    memcpy(&v, in + i * sizeof(Src), sizeof(Src));
+    const double d = static_cast<double>(v);
+    const size_t c = i % num_components;
+    if (d < mins[c]) mins[c] = d;
+    if (d > maxs[c]) maxs[c] = d;
+  }
+}
+
+#ifdef TINYGLTF_X86_SIMD
+static size_t BoundsPeriod(size_t num_components, size_t lanes) {
+  size_t a = num_components;
+  size_t b = lanes;
+  while (b != 0) {
+    const size_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return num_components / a * lanes;
+}
+
+template <typename Lane>
+static void FoldBounds(const Lane *lane_min, const Lane *lane_max,
+                       size_t count, size_t first_lane, size_t num_components,
+                       double *mins, double *maxs) {
+  for (size_t j = 0; j < count; j++) {
+    const size_t c = (first_lane + j) % num_components;
+    if (double(lane_min[j]) < mins[c]) mins[c] = double(lane_min[j]);
+    if (double(lane_max[j]) > maxs[c]) maxs[c] = double(lane_max[j]);
+  }
+}
+
+// Integer sources are widened to 32 bit lanes; UNSIGNED_INT compares
+// unsigned.
+template <typename Src>
+TINYGLTF_TARGET_SSE41 static size_t AccessorBoundsIntSSE41(
+    const unsigned char *in, size_t n, size_t num_components, double *mins,
+    double *maxs) {
+  const bool is_unsigned = std::is_same<Src, uint32_t>::value;
+  const size_t period = BoundsPeriod(num_components, 4);
+  const size_t vecs = period / 4;
+  if (n < period) return 0;
+  __m128i vmin[16];
+  __m128i vmax[16];
+  for (size_t k = 0; k < vecs; k++) {
+    vmin[k] = vmax[k] = LoadEpi32x4(in + k * 4 * sizeof(Src), Src());
+  }
+  size_t i = period;
+  for (; i + period <= n; i += period) {
+    for (size_t k = 0; k < vecs; k++) {
+      const __m128i v = LoadEpi32x4(in + (i + k * 4) * sizeof(Src), Src());
+      vmin[k] = is_unsigned ? _mm_min_epu32(vmin[k], v)
+                            : _mm_min_epi32(vmin[k], v);
+      vmax[k] = is_unsigned ? _mm_max_epu32(vmax[k], v)
+                            : _mm_max_epi32(vmax[k], v);
+    }
+  }
+  for (size_t k = 0; k < vecs; k++) {
+    int32_t lo[4];
+    int32_t hi[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lo), vmin[k]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(hi), vmax[k]);
+    if (is_unsigned) {
+      FoldBounds(reinterpret_cast<const uint32_t *>(lo),
+                 reinterpret_cast<const uint32_t *>(hi), 4, k * 4,
+                 num_components, mins, maxs);
+    } else {
+      FoldBounds(lo, hi, 4, k * 4, num_components, mins, maxs);
+    }
+  }
+  return i;
+}
+
+template <typename Src>
+TINYGLTF_TARGET_AVX2 static size_t AccessorBoundsIntAVX2(
+    const unsigned char *in, size_t n, size_t num_components, double *mins,
+    double *maxs) {
+  const bool is_unsigned = std::is_same<Src, uint32_t>::value;
+  const size_t period = BoundsPeriod(num_components, 8);
+  const size_t vecs = period / 8;
+  if (n < period) return 0;
+  __m256i vmin[16];
+  __m256i vmax[16];
+  for (size_t k = 0; k < vecs; k++) {
+    vmin[k] = vmax[k] = LoadEpi32x8(in + k * 8 * sizeof(Src), Src());
+  }
+  size_t i = period;
+  for (; i + period <= n; i += period) {
+    for (size_t k = 0; k < vecs; k++) {
+      const __m256i v = LoadEpi32x8(in + (i + k * 8) * sizeof(Src), Src());
+      vmin[k] = is_unsigned ? _mm256_min_epu32(vmin[k], v)
+                            : _mm256_min_epi32(vmin[k], v);
+      vmax[k] = is_unsigned ? _mm256_max_epu32(vmax[k], v)
+                            : _mm256_max_epi32(vmax[k], v);
+    }
+  }
+  for (size_t k = 0; k < vecs; k++) {
+    int32_t lo[8];
+    int32_t hi[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lo), vmin[k]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(hi), vmax[k]);
+    if (is_unsigned) {
+      FoldBounds(reinterpret_cast<const uint32_t *>(lo),
+                 reinterpret_cast<const uint32_t *>(hi), 8, k * 8,
+                 num_components, mins, maxs);
+    } else {
+      FoldBounds(lo, hi, 8, k * 8, num_components, mins, maxs);
+    }
+  }
+  return i;
+}
+
+// minps/maxps return the second operand when either is NaN, so NaNs in the
+// data never replace a real bound (the scalar code ignores them as well).
+TINYGLTF_TARGET_SSE41
+static size_t AccessorBoundsFloatSSE41(const unsigned char *in, size_t n,
+                                       size_t num_components, double *mins,
+                                       double *maxs) {
+  const size_t period = BoundsPeriod(num_components, 4);
+  const size_t vecs = period / 4;
+  if (n < period) return 0;
+  const float *f = reinterpret_cast<const float *>(in);
+  __m128 vmin[16];
+  __m128 vmax[16];
+  for (size_t k = 0; k < vecs; k++) {
+    vmin[k] = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    vmax[k] = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+  }
+  size_t i = 0;
+  for (; i + period <= n; i += period) {
+    for (size_t k = 0; k < vecs; k++) {
+      const __m128 v = _mm_loadu_ps(f + i + k * 4);
+      vmin[k] = _mm_min_ps(v, vmin[k]);
+      vmax[k] = _mm_max_ps(v, vmax[k]);
+    }
+  }
+  for (size_t k = 0; k < vecs; k++) {
+    float lo[4];
+    float hi[4];
+    _mm_storeu_ps(lo, vmin[k]);
+    _mm_storeu_ps(hi, vmax[k]);
+    FoldBounds(lo, hi, 4, k * 4, num_components, mins, maxs);
+  }
+  return i;
+}
+
+TINYGLTF_TARGET_AVX2
+static size_t AccessorBoundsFloatAVX2(const unsigned char *in, size_t n,
+                                      size_t num_components, double *mins,
+                                      double *maxs) {
+  const size_t period = BoundsPeriod(num_components, 8);
+  const size_t vecs = period / 8;
+  if (n < period) return 0;
+  const float *f = reinterpret_cast<const float *>(in);
+  __m256 vmin[16];
+  __m256 vmax[16];
+  for (size_t k = 0; k < vecs; k++) {
+    vmin[k] = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    vmax[k] = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+  }
+  size_t i = 0;
+  for (; i + period <= n; i += period) {
+    for (size_t k = 0; k < vecs; k++) {
+      const __m256 v = _mm256_loadu_ps(f + i + k * 8);
+      vmin[k] = _mm256_min_ps(v, vmin[k]);
+      vmax[k] = _mm256_max_ps(v, vmax[k]);
+    }
+  }
+  for (size_t k = 0; k < vecs; k++) {
+    float lo[8];
+    float hi[8];
+    _mm256_storeu_ps(lo, vmin[k]);
+    _mm256_storeu_ps(hi, vmax[k]);
+    FoldBounds(lo, hi, 8, k * 8, num_components, mins, maxs);
+  }
+  return i;
+}
+#endif
+
+template <typename Src>
+static void AccessorBoundsInt(const unsigned char *in, size_t n,
+                              size_t num_components, double *mins,
+                              double *maxs) {
+  size_t i = 0;
+#ifdef TINYGLTF_X86_SIMD
+  const int simd = GetSimdLevel();
+  if (simd >= kSimdAVX2) {
+    i = AccessorBoundsIntAVX2<Src>(in, n, num_components, mins, maxs);
+  } else if (simd >= kSimdSSE41) {
+    i = AccessorBoundsIntSSE41<Src>(in, n, num_components, mins, maxs);
+  }
+#endif
+  AccessorBoundsScalar<Src>(in + i * sizeof(Src), n - i, num_components,
+                            mins, maxs);
+}
+
+// Folds `n` packed components (a whole number of elements) into the
+// running per-component bounds.
+static void AccessorBoundsComponents(const unsigned char *in,
+                                     int componentType, size_t n,
+                                     size_t num_components, double *mins,
+                                     double *maxs) {
+  switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+      AccessorBoundsInt<int8_t>(in, n, num_components, mins, maxs);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      AccessorBoundsInt<uint8_t>(in, n, num_components, mins, maxs);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+      AccessorBoundsInt<int16_t>(in, n, num_components, mins, maxs);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+      AccessorBoundsInt<uint16_t>(in, n, num_components, mins, maxs);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_INT:
+      AccessorBoundsInt<int32_t>(in, n, num_components, mins, maxs);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      AccessorBoundsInt<uint32_t>(in, n, num_components, mins, maxs);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+      size_t i = 0;
+#ifdef TINYGLTF_X86_SIMD
+      const int simd = GetSimdLevel();
+      if (simd >= kSimdAVX2) {
+        i = AccessorBoundsFloatAVX2(in, n, num_components, mins, maxs);
+      } else if (simd >= kSimdSSE41) {
+        i = AccessorBoundsFloatSSE41(in, n, num_components, mins, maxs);
+      }
+#endif
+      AccessorBoundsScalar<float>(in + i * sizeof(float), n - i,
+                                  num_components, mins, maxs);
+    } break;
+    case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+      AccessorBoundsScalar<double>(in, n, num_components, mins, maxs);
+      break;
+    default:
+      break;
+  }
+}
+
+bool ComputeAccessorBounds(const AccessorLayout &layout,
+                           std::vector<double> *minValues,
+                           std::vector<double> *maxValues) {
+  if (layout.count == 0 || layout.numComponents <= 0) return false;
+  const size_t num_components = size_t(layout.numComponents);
+  const size_t element_size = layout.ElementSize();
+  std::vector<double> mins(num_components,
+                           std::numeric_limits<double>::infinity());
+  std::vector<double> maxs(num_components,
+                           -std::numeric_limits<double>::infinity());
+
+  if (layout.sparseCount > 0) {
+    // Bounds cover the substituted values, so work on a dense copy.
+    std::vector<unsigned char> dense(layout.count * element_size);
+    MaterializeSparseAccessor(layout, dense.data());
+    AccessorBoundsComponents(dense.data(), layout.componentType,
+                             layout.count * num_components, num_components,
+                             mins.data(), maxs.data());
+  } else if (!layout.data) {
+    std::fill(mins.begin(), mins.end(), 0.0);
+    std::fill(maxs.begin(), maxs.end(), 0.0);
+  } else if (layout.stride == element_size) {
+    AccessorBoundsComponents(layout.data, layout.componentType,
+                             layout.count * num_components, num_components,
+                             mins.data(), maxs.data());
+  } else {
+    unsigned char scratch[16384];
+    const size_t batch = sizeof(scratch) / element_size;
+    for (size_t first = 0; first < layout.count; first += batch) {
+      const size_t n = std::min(batch, layout.count - first);
+      GatherElements(layout.data + first * layout.stride, layout.stride,
+                     element_size, n, scratch);
+      AccessorBoundsComponents(scratch, layout.componentType,
+                               n * num_components, num_components,
+                               mins.data(), maxs.data());
+    }
+  }
+
+  if (minValues) minValues->swap(mins);
+  if (maxValues) maxValues->swap(maxs);
+  return true;
+}
+
+bool ComputeAccessorBounds(const Model &model, int accessorIndex,
+                           std::vector<double> *minValues,
+                           std::vector<double> *maxValues, std::string *err) {
+  AccessorLayout layout;
+  if (!GetAccessorLayout(model, accessorIndex, &layout, err)) return false;
+  if (!ComputeAccessorBounds(layout, minValues, maxValues)) {
+    if (err) {
+      (*err) += "accessor[" + std::to_string(accessorIndex) +
+                "] has no elements to compute bounds from.\n";
+    }
+    return false;
+  }
+  return true;
+}
+
+// Stored bounds are compared in the component type: JSON numbers of a float
+// accessor only have to round to the right float.
+static bool SameBound(double stored, double computed, int componentType) {
+  if (componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+    return static_cast<float>(stored) == static_cast<float>(computed);
+  }
+  return stored == computed;
+}
+
+static std::string BoundsToString(const std::vector<double> &values) {
+  std::string s = "[";
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i > 0) s += ", ";
+    std::ostringstream ss;
+    ss.precision(std::numeric_limits<double>::max_digits10);
+    ss << values[i];
+    s += ss.str();
+  }
+  return s + "]";
+}
+
+// Runs `fn(accessor_index, &accessor_err)` for every accessor on `pool` and
+// appends the messages to `err` in accessor order.
+template <typename Fn>
+static bool ForEachAccessorParallel(size_t num_accessors, ThreadPool *pool,
+                                    std::string *err, const Fn &fn) {
+  std::vector<std::string> errs(num_accessors);
+  std::vector<char> ok(num_accessors, 1);
+  auto Run = [&](size_t i) { ok[i] = fn(int(i), &errs[i]) ? 1 : 0; };
+  if (pool) {
+    pool->ParallelFor(num_accessors, Run);
+  } else {
+    for (size_t i = 0; i < num_accessors; i++) Run(i);
+  }
+  bool all_ok = true;
+  for (size_t i = 0; i < num_accessors; i++) {
+    if (!ok[i]) all_ok = false;
+    if (err) (*err) += errs[i];
+  }
+  return all_ok;
+}
+
+bool UpdateAccessorBounds(Model *model, std::string *err, ThreadPool *pool) {
+  if (!model) return false;
+  return ForEachAccessorParallel(
+      model->accessors.size(), pool, err,
+      [model](int i, std::string *accessor_err) {
+        Accessor &accessor = model->accessors[size_t(i)];
+        std::vector<double> mins;
+        std::vector<double> maxs;
+        AccessorLayout layout;
+        if (!GetAccessorLayout(*model, i, &layout, accessor_err)) {
+          return false;
+        }
+        if (!ComputeAccessorBounds(layout, &mins, &maxs)) {
+          // Nothing to bound; glTF has no bounds for empty accessors.
+          accessor.minValues.clear();
+          accessor.maxValues.clear();
+          return true;
+        }
+        accessor.minValues.swap(mins);
+        accessor.maxValues.swap(maxs);
+        return true;
+      });
+}
+
+bool VerifyAccessorBounds(const Model &model, std::string *err,
+                          ThreadPool *pool) {
+  return ForEachAccessorParallel(
+      model.accessors.size(), pool, err,
+      [&model](int i, std::string *accessor_err) {
+        const Accessor &accessor = model.accessors[size_t(i)];
+        if (accessor.minValues.empty() && accessor.maxValues.empty()) {
+          return true;
+        }
+        std::vector<double> mins;
+        std::vector<double> maxs;
+        AccessorLayout layout;
+        if (!GetAccessorLayout(model, i, &layout, accessor_err)) {
+          return false;
+        }
+        if (!ComputeAccessorBounds(layout, &mins, &maxs)) return true;
+
+        bool same = true;
+        for (int pass = 0; pass < 2; pass++) {
+          const std::vector<double> &stored =
+              pass == 0 ? accessor.minValues : accessor.maxValues;
+          const std::vector<double> &computed = pass == 0 ? mins : maxs;
+          if (stored.empty()) continue;
+          bool match = stored.size() == computed.size();
+          for (size_t c = 0; match && c < stored.size(); c++) {
+            match = SameBound(stored[c], computed[c], accessor.componentType);
+          }
+          if (!match) {
+            (*accessor_err) += "accessor[" + std::to_string(i) + "] " +
+                               (pass == 0 ? "min " : "max ") +
+                               BoundsToString(stored) +
+                               " does not match the data " +
+                               BoundsToString(computed) + ".\n";
+            same = false;
+          }
+        }
+        return same;
+      });
+}
+
+// False for the elements a filtered load left default constructed, i.e. the
+// ones not set in `loaded` (null when the load was not filtered). Elements
+// appended after the filter ran (e.g. by Draco decoding) count as loaded.
+static bool IsLoaded(const std::vector<char> *loaded, size_t i) {
+  return !loaded || i >= loaded->size() || (*loaded)[i];
+}
+
+// ValidateModel() which skips the accessors and bufferViews not set in
+// `loaded_accessors` and `loaded_buffer_views`.
+static bool ValidateModel(Model *model, std::string *err, ThreadPool *pool,
+                          const std::vector<char> *loaded_accessors,
+                          const std::vector<char> *loaded_buffer_views) {
+  if (!model) return false;
+  model->validated = false;
+  bool ok = true;
+  auto Fail = [&](const std::string &msg) {
+    if (err) (*err) += msg;
+    ok = false;
+  };
+
+  for (size_t i = 0; i < model->bufferViews.size(); i++) {
+    if (!IsLoaded(loaded_buffer_views, i)) continue;
+    const BufferView &view = model->bufferViews[i];
+    const std::string prefix = "bufferView[" + std::to_string(i) + "] ";
+    if (view.buffer < 0 || size_t(view.buffer) >= model->buffers.size()) {
+      Fail(prefix + "references a buffer which does not exist.\n");
+      continue;
+    }
+    const size_t size = model->buffers[size_t(view.buffer)].data.size();
+    if (view.byteOffset > size || view.byteLength > size - view.byteOffset) {
+      Fail(prefix + "range exceeds buffer[" + std::to_string(view.buffer) +
+           "].\n");
+    }
+    if (view.byteStride != 0 &&
+        (view.byteStride < 4 || view.byteStride > 252 ||
+         (view.byteStride % 4) != 0)) {
+      Fail(prefix + "has an invalid byteStride.\n");
+    }
+  }
+
+  const size_t num_accessors = model->accessors.size();
+  std::vector<char> is_index(num_accessors, 0);
+  for (const Mesh &mesh : model->meshes) {
+    for (const Primitive &primitive : mesh.primitives) {
+      if (primitive.indices >= 0 && size_t(primitive.indices) < num_accessors) {
+        is_index[size_t(primitive.indices)] = 1;
+      }
+    }
+  }
+
+  // Accessor layouts (ranges and sparse indices) and the largest index of
+  // each index accessor, which is the expensive part for big meshes.
+  std::vector<int64_t> max_index(num_accessors, -1);
+  const Model &checked = *model;
+  const bool accessors_ok = ForEachAccessorParallel(
+      num_accessors, pool, err, [&](int i, std::string *accessor_err) {
+        if (!IsLoaded(loaded_accessors, size_t(i))) return true;
+        AccessorLayout layout;
+        if (!GetAccessorLayout(checked, i, &layout, accessor_err)) {
+          return false;
+        }
+        if (!is_index[size_t(i)]) return true;
+        if (layout.numComponents != 1 ||
+            (layout.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE &&
+             layout.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT &&
+             layout.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)) {
+          (*accessor_err) += "accessor[" + std::to_string(i) +
+                             "] is used as indices but is not an unsigned "
+                             "integer SCALAR.\n";
+          return false;
+        }
+        std::vector<double> maxs;
+        if (ComputeAccessorBounds(layout, nullptr, &maxs)) {
+          max_index[size_t(i)] = int64_t(maxs[0]);
+        }
+        return true;
+      });
+  if (!accessors_ok) ok = false;
+
+  for (size_t m = 0; m < model->meshes.size(); m++) {
+    const Mesh &mesh = model->meshes[m];
+    for (size_t p = 0; p < mesh.primitives.size(); p++) {
+      const Primitive &primitive = mesh.primitives[p];
+      const std::string prefix = "mesh[" + std::to_string(m) +
+                                 "].primitives[" + std::to_string(p) + "] ";
+
+      // All attributes and morph targets must have the same count.
+      size_t vertex_count = 0;
+      bool has_vertex_count = false;
+      auto CheckAttributes = [&](const AttributeMap &attributes) {
+        for (const auto &attribute : attributes) {
+          if (attribute.second < 0 ||
+              size_t(attribute.second) >= num_accessors) {
+            Fail(prefix + "attribute " + attribute.first.Name() +
+                 " references an accessor which does not exist.\n");
+            continue;
+          }
+          const size_t count = model->accessors[size_t(attribute.second)].count;
+          if (!has_vertex_count) {
+            vertex_count = count;
+            has_vertex_count = true;
+          } else if (count != vertex_count) {
+            Fail(prefix + "attribute " + attribute.first.Name() + " has " +
+                 std::to_string(count) + " elements, expected " +
+                 std::to_string(vertex_count) + ".\n");
+          }
+        }
+      };
+      CheckAttributes(primitive.attributes);
+      for (const AttributeMap &target : primitive.targets) {
+        CheckAttributes(target);
+      }
+
+      if (primitive.indices < 0) continue;
+      if (size_t(primitive.indices) >= num_accessors) {
+        Fail(prefix + "indices reference an accessor which does not exist.\n");
+        continue;
+      }
+      const int64_t max = max_index[size_t(primitive.indices)];
+      if (has_vertex_count && max >= 0 && uint64_t(max) >= vertex_count) {
+        Fail(prefix + "index " + std::to_string(max) +
+             " is out of range for " + std::to_string(vertex_count) +
+             " vertices.\n");
+      }
+    }
+  }
+
+  model->validated = ok;
+  return ok;
+}
+
+bool ValidateModel(Model *model, std::string *err, ThreadPool *pool) {
+  return ValidateModel(model, err, pool, nullptr, nullptr);
+}
+
+template <typename Out>
+static void ConvertAccessorComponents(const AccessorLayout &layout,
+                                      Out *out) {
+  const size_t num_components = size_t(layout.numComponents);
+  const size_t element_size = layout.ElementSize();
+  if (!layout.data) {
+    std::fill(out, out + layout.count * num_components, Out(0));
+  } else if (layout.stride == element_size) {
+    ConvertComponents(layout.data, layout.componentType, layout.normalized,
+                      layout.count * num_components, out);
+  } else {
+    // Interleaved data: gather L1 sized batches, then convert them packed.
+    unsigned char scratch[16384];
+    const size_t batch = sizeof(scratch) / element_size;
+    for (size_t first = 0; first < layout.count; first += batch) {
+      const size_t n = std::min(batch, layout.count - first);
+      GatherElements(layout.data + first * layout.stride, layout.stride,
+                     element_size, n, scratch);
+      ConvertComponents(scratch, layout.componentType, layout.normalized,
+                        n * num_components, out + first * num_components);
+    }
+  }
+
+  ApplySparseOverlayComponents(layout, out);
+}
+
+void ConvertAccessor(const AccessorLayout &layout, float *out) {
+  ConvertAccessorComponents(layout, out);
+}
+
+void ConvertAccessor(const AccessorLayout &layout, int32_t *out) {
+  ConvertAccessorComponents(layout, out);
+}
+
+void ConvertAccessorToHalf(const AccessorLayout &layout, uint16_t *out) {
+  ConvertAccessorComponents(layout, out);
+}
+
+bool ConvertAccessor(const Model &model, int accessorIndex, float *out,
+                     std::string *err) {
+  AccessorLayout layout;
+  if (!GetAccessorLayout(model, accessorIndex, &layout, err)) return false;
+  ConvertAccessor(layout, out);
+  return true;
+}
+
+bool ConvertAccessor(const Model &model, int accessorIndex, int32_t *out,
+                     std::string *err) {
+  AccessorLayout layout;
+  if (!GetAccessorLayout(model, accessorIndex, &layout, err)) return false;
+  ConvertAccessor(layout, out);
+  return true;
+}
 
-  return ret;
+bool ConvertAccessorToHalf(const Model &model, int accessorIndex,
+                           uint16_t *out, std::string *err) {
+  AccessorLayout layout;
+  if (!GetAccessorLayout(model, accessorIndex, &layout, err)) return false;
+  ConvertAccessorToHalf(layout, out);
+  return true;
 }
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
 
 // https://github.com/syoyo/tinygltf/issues/228
 // TODO(syoyo): Use uriparser https://uriparser.github.io/ for stricter Uri
@@ -2420,10 +6003,138 @@ static bool LoadExternalFile(std::vector<unsigned char> *out, std::string *err,
   return true;
 }
 
-void TinyGLTF::SetImageLoader(LoadImageDataFunction func, void *user_data) {
+#ifdef TINYGLTF_USE_ARENA
+static Arena *&CurrentArena() {
+  static thread_local Arena *arena = nullptr;
+  return arena;
+}
+
+Arena *Arena::Current() { return CurrentArena(); }
+
+void Arena::SetCurrent(Arena *arena) { CurrentArena() = arena; }
+
+void *Arena::Allocate(size_t size, size_t alignment) {
+  assert(alignment <= alignof(std::max_align_t));
+  std::lock_guard<std::mutex> lock(mutex_);
+  bytes_used_ += size;
+
+  // Large requests get a block of their own instead of wasting the rest of
+  // the current one.
+  if (size > block_size_ / 4) {
+    blocks_.reserve(blocks_.size() + 1);
+    blocks_.push_back(::operator new(size));
+    return blocks_.back();
+  }
+
+  uintptr_t p = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) &
+                ~uintptr_t(alignment - 1);
+  if (!cursor_ || (p + size > reinterpret_cast<uintptr_t>(end_))) {
+    blocks_.reserve(blocks_.size() + 1);
+    blocks_.push_back(::operator new(block_size_));
+    cursor_ = static_cast<char *>(blocks_.back());
+    end_ = cursor_ + block_size_;
+    p = reinterpret_cast<uintptr_t>(cursor_);
+  }
+  cursor_ = reinterpret_cast<char *>(p + size);
+  return reinterpret_cast<void *>(p);
+}
+
+void Arena::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (void *block : blocks_) {
+    ::operator delete(block);
+  }
+  blocks_.clear();
+  cursor_ = nullptr;
+  end_ = nullptr;
+  bytes_used_ = 0;
+}
+
+size_t Arena::BytesUsed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_used_;
+}
+
+size_t Arena::NumBlocks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return blocks_.size();
+}
+#endif
+
+ThreadPool::ThreadPool(unsigned int num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  workers_.reserve(num_threads);
+  for (unsigned int i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (size_t i = 0; i < workers_.size(); i++) {
+    workers_[i].join();
+  }
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;  // stop_ was set and all queued tasks are done.
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+// Fills in the metadata of a lazily loaded image from its encoded header,
+// as LoadImageData would report it after decoding.
+static void ReadImageInfo(Image *image, bool preserve_channels) {
+#ifndef TINYGLTF_NO_STB_IMAGE
+  const unsigned char *bytes = image->image.data();
+  const int size = static_cast<int>(image->image.size());
+  int w = 0, h = 0, comp = 0;
+  if (!stbi_info_from_memory(bytes, size, &w, &h, &comp)) {
+    return;
+  }
+  const bool is_16_bit = stbi_is_16_bit_from_memory(bytes, size) != 0;
+  image->width = w;
+  image->height = h;
+  image->component = preserve_channels ? comp : 4;
+  image->bits = is_16_bit ? 16 : 8;
+  image->pixel_type = is_16_bit ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT
+                                : TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+#else
+  (void)image;
+  (void)preserve_channels;
+#endif
+}
+
+void TinyGLTF::SetImageLoader(LoadImageDataFunction func, void *user_data,
+                              bool thread_safe) {
   LoadImageData = func;
   load_image_user_data_ = user_data;
   user_image_loader_ = true;
+  user_image_loader_thread_safe_ = thread_safe;
 }
 
 void TinyGLTF::RemoveImageLoader() {
@@ -2436,6 +6147,7 @@ void TinyGLTF::RemoveImageLoader() {
 
   load_image_user_data_ = nullptr;
   user_image_loader_ = false;
+  user_image_loader_thread_safe_ = false;
 }
 
 #ifndef TINYGLTF_NO_STB_IMAGE
@@ -2490,7 +6202,8 @@ bool LoadImageData(Image *image, const int image_idx, std::string *err,
     if (err) {
       (*err) +=
           "Unknown image format. STB cannot decode image data for image[" +
-          std::to_string(image_idx) + "] name = \"" + image->name + "\".\n";
+          std::to_string(image_idx) + "] name = \"" +
+          image->name.c_str() + "\".\n";
     }
     return false;
   }
@@ -2499,7 +6212,7 @@ bool LoadImageData(Image *image, const int image_idx, std::string *err,
     stbi_image_free(data);
     if (err) {
       (*err) += "Invalid image data for image[" + std::to_string(image_idx) +
-                "] name = \"" + image->name + "\"\n";
+                "] name = \"" + image->name.c_str() + "\"\n";
     }
     return false;
   }
@@ -2509,8 +6222,8 @@ bool LoadImageData(Image *image, const int image_idx, std::string *err,
       stbi_image_free(data);
       if (err) {
         (*err) += "Image width mismatch for image[" +
-                  std::to_string(image_idx) + "] name = \"" + image->name +
-                  "\"\n";
+                  std::to_string(image_idx) + "] name = \"" +
+                  image->name.c_str() + "\"\n";
       }
       return false;
     }
@@ -2521,8 +6234,8 @@ bool LoadImageData(Image *image, const int image_idx, std::string *err,
       stbi_image_free(data);
       if (err) {
         (*err) += "Image height mismatch. for image[" +
-                  std::to_string(image_idx) + "] name = \"" + image->name +
-                  "\"\n";
+                  std::to_string(image_idx) + "] name = \"" +
+                  image->name.c_str() + "\"\n";
       }
       return false;
     }
@@ -2538,8 +6251,7 @@ bool LoadImageData(Image *image, const int image_idx, std::string *err,
   image->component = comp;
   image->bits = bits;
   image->pixel_type = pixel_type;
-  image->image.resize(static_cast<size_t>(w * h * comp) * size_t(bits / 8));
-  std::copy(data, data + w * h * comp * (bits / 8), image->image.begin());
+  image->image.assign(data, data + w * h * comp * (bits / 8));
   stbi_image_free(data);
 
   return true;
@@ -2571,7 +6283,23 @@ bool WriteImageData(const std::string *basepath, const std::string *filename,
   std::string header;
   std::vector<unsigned char> data;
 
-  if (ext == "png") {
+  if (image->as_is) {
+    // `image` already holds the encoded file (e.g. with lazy image decoding).
+    std::string mime_type = image->mimeType;
+    if (mime_type.empty()) {
+      if (ext == "png") {
+        mime_type = "image/png";
+      } else if ((ext == "jpg") || (ext == "jpeg")) {
+        mime_type = "image/jpeg";
+      } else if (ext == "bmp") {
+        mime_type = "image/bmp";
+      } else if (ext == "gif") {
+        mime_type = "image/gif";
+      }
+    }
+    data.assign(image->image.begin(), image->image.end());
+    header = "data:" + mime_type + ";base64,";
+  } else if (ext == "png") {
     if ((image->bits != 8) ||
         (image->pixel_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)) {
       // Unsupported pixel format
@@ -2893,6 +6621,102 @@ bool WriteWholeFile(std::string *err, const std::string &filepath,
   return true;
 }
 
+std::shared_ptr<const void> MapWholeFile(const unsigned char **data,
+                                         size_t *size, std::string *err,
+                                         const std::string &filepath) {
+#ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
+  (void)data;
+  (void)size;
+  if (err) {
+    (*err) += "Memory mapping is not supported for Android assets : " +
+              filepath + "\n";
+  }
+  return nullptr;
+#elif defined(_WIN32)
+  HANDLE file = CreateFileW(UTF8ToWchar(filepath).c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+    CloseHandle(file);
+    if (err) {
+      (*err) += "File is empty : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+
+  // The mapping keeps the file open, and the view keeps the mapping alive.
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    if (err) {
+      (*err) += "File mapping error : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    if (err) {
+      (*err) += "File mapping error : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+
+  (*data) = reinterpret_cast<const unsigned char *>(view);
+  (*size) = size_t(file_size.QuadPart);
+  return std::shared_ptr<const void>(
+      view, [](const void *p) { UnmapViewOfFile(p); });
+#else
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+    close(fd);
+    if (err) {
+      (*err) += "Invalid file : " + filepath +
+                " (does the path point to a directory?)";
+    }
+    return nullptr;
+  } else if (st.st_size == 0) {
+    close(fd);
+    if (err) {
+      (*err) += "File is empty : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+
+  size_t len = size_t(st.st_size);
+  void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping stays valid after closing the descriptor.
+  if (p == MAP_FAILED) {
+    if (err) {
+      (*err) += "File mapping error : " + filepath + "\n";
+    }
+    return nullptr;
+  }
+
+  (*data) = reinterpret_cast<const unsigned char *>(p);
+  (*size) = len;
+  return std::shared_ptr<const void>(
+      p, [len](const void *q) { munmap(const_cast<void *>(q), len); });
+#endif
+}
+
 #endif  // TINYGLTF_NO_FS
 
 static std::string MimeToExt(const std::string &mimeType) {
@@ -2917,7 +6741,7 @@ static bool UpdateImageObject(const Image &image, std::string &baseDir,
   std::string filename;
   std::string ext;
   // If image has uri, use it as a filename
-  if (image.uri.size()) {
+  if (image.uri.size() && !IsDataURI(image.uri)) {
     std::string decoded_uri;
     if (!uri_cb->decode(image.uri, &decoded_uri, uri_cb->user_data)) {
       // A decode failure results in a failure to write the gltf.
@@ -2931,7 +6755,7 @@ static bool UpdateImageObject(const Image &image, std::string &baseDir,
   } else if (image.name.size()) {
     ext = MimeToExt(image.mimeType);
     // Otherwise use name as filename
-    filename = image.name + "." + ext;
+    filename = std::string(image.name.c_str()) + "." + ext;
   } else {
     ext = MimeToExt(image.mimeType);
     // Fallback to index of image as filename
@@ -2958,117 +6782,85 @@ static bool UpdateImageObject(const Image &image, std::string &baseDir,
   return true;
 }
 
-bool IsDataURI(const std::string &in) {
-  std::string header = "data:application/octet-stream;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  header = "data:image/jpeg;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  header = "data:image/png;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  header = "data:image/bmp;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  header = "data:image/gif;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  header = "data:text/plain;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  header = "data:application/gltf-buffer;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
-
-  return false;
-}
-
-bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
-                   const std::string &in, size_t reqBytes, bool checkSize) {
-  std::string header = "data:application/octet-stream;base64,";
-  std::string data;
-  if (in.find(header) == 0) {
-    data = base64_decode(in.substr(header.size()));  // cut mime string.
-  }
+// Supported data URI headers. The mime type is only reported for image and
+// text data.
+static const struct {
+  const char *header;
+  const char *mime_type;
+} kDataURIHeaders[] = {
+    {"data:application/octet-stream;base64,", nullptr},
+    {"data:image/jpeg;base64,", "image/jpeg"},
+    {"data:image/png;base64,", "image/png"},
+    {"data:image/bmp;base64,", "image/bmp"},
+    {"data:image/gif;base64,", "image/gif"},
+    {"data:text/plain;base64,", "text/plain"},
+    {"data:application/gltf-buffer;base64,", nullptr},
+};
 
-  if (data.empty()) {
-    header = "data:image/jpeg;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/jpeg";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
+// Returns the length of the supported data URI header `in` starts with, or 0.
+// Only the header is compared, never the (possibly huge) payload.
+static size_t FindDataURIHeader(const char *in, size_t len,
+                                const char **mime_type) {
+  if ((len < 5) || (memcmp(in, "data:", 5) != 0)) {
+    return 0;
   }
-
-  if (data.empty()) {
-    header = "data:image/png;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/png";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+  for (size_t i = 0; i < sizeof(kDataURIHeaders) / sizeof(kDataURIHeaders[0]);
+       i++) {
+    const size_t header_len = strlen(kDataURIHeaders[i].header);
+    if ((len >= header_len) &&
+        (memcmp(in + 5, kDataURIHeaders[i].header + 5, header_len - 5) == 0)) {
+      if (mime_type) {
+        (*mime_type) = kDataURIHeaders[i].mime_type;
+      }
+      return header_len;
     }
   }
+  return 0;
+}
 
-  if (data.empty()) {
-    header = "data:image/bmp;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/bmp";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
-  }
+static bool IsDataURI(const char *in, size_t len) {
+  return FindDataURIHeader(in, len, nullptr) != 0;
+}
 
-  if (data.empty()) {
-    header = "data:image/gif;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/gif";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
-  }
+bool IsDataURI(const std::string &in) {
+  return IsDataURI(in.data(), in.size());
+}
 
-  if (data.empty()) {
-    header = "data:text/plain;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "text/plain";
-      data = base64_decode(in.substr(header.size()));
-    }
+// Decodes the data URI `in` straight into `out`, without intermediate copies.
+static bool DecodeDataURI(std::vector<unsigned char> *out,
+                          std::string *mime_type, const char *in, size_t len,
+                          size_t reqBytes, bool checkSize) {
+  const char *mime = nullptr;
+  const size_t header_len = FindDataURIHeader(in, len, &mime);
+  if (header_len == 0) {
+    return false;
   }
 
-  if (data.empty()) {
-    header = "data:application/gltf-buffer;base64,";
-    if (in.find(header) == 0) {
-      data = base64_decode(in.substr(header.size()));
-    }
+  const char *encoded = in + header_len;
+  const size_t encoded_len = len - header_len;
+  out->resize(base64_decoded_size_max(encoded_len));
+  if (!out->empty()) {
+    out->resize(base64_decode(encoded, encoded_len, out->data()));
   }
 
   // TODO(syoyo): Allow empty buffer? #229
-  if (data.empty()) {
+  if (out->empty() || (checkSize && (out->size() != reqBytes))) {
+    out->clear();
     return false;
   }
 
-  if (checkSize) {
-    if (data.size() != reqBytes) {
-      return false;
-    }
-    out->resize(reqBytes);
-  } else {
-    out->resize(data.size());
+  if (mime) {
+    (*mime_type) = mime;
   }
-  std::copy(data.begin(), data.end(), out->begin());
   return true;
 }
 
+bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
+                   const std::string &in, size_t reqBytes, bool checkSize) {
+  return DecodeDataURI(out, &mime_type, in.data(), in.size(), reqBytes,
+                       checkSize);
+}
+
 namespace detail {
 bool GetInt(const detail::json &o, int &val) {
 #ifdef TINYGLTF_USE_RAPIDJSON
@@ -3149,6 +6941,28 @@ bool GetString(const detail::json &o, std::string &val) {
 #endif
 }
 
+// Returns the string held by the JSON value itself, without copying it.
+bool GetString(const detail::json &o, const char *&str, size_t &len) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  if (o.IsString()) {
+    str = o.GetString();
+    len = o.GetStringLength();
+    return true;
+  }
+
+  return false;
+#else
+  if (o.type() == detail::json::value_t::string) {
+    const std::string &s = o.get_ref<const std::string &>();
+    str = s.data();
+    len = s.size();
+    return true;
+  }
+
+  return false;
+#endif
+}
+
 bool IsArray(const detail::json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.IsArray();
@@ -3537,7 +7351,10 @@ static bool ParseNumberProperty(double *ret, std::string *err, const detail::jso
   return true;
 }
 
-static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
+// `Container` is std::vector<double> or, for compact Node transforms, an
+// InlineArray.
+template <typename Container>
+static bool ParseNumberArrayProperty(Container *ret, std::string *err,
                                      const detail::json &o, const std::string &property,
                                      bool required,
                                      const std::string &parent_node = "") {
@@ -3569,8 +7386,23 @@ static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
   }
 
   ret->clear();
+  auto begin = detail::ArrayBegin(detail::GetValue(it));
   auto end = detail::ArrayEnd(detail::GetValue(it));
-  for (auto i = detail::ArrayBegin(detail::GetValue(it)); i != end; ++i) {
+  const size_t count = static_cast<size_t>(std::distance(begin, end));
+  if (count > ret->max_size()) {
+    if (err) {
+      (*err) += "'" + property + "' property has more than " +
+                std::to_string(ret->max_size()) + " elements";
+      if (!parent_node.empty()) {
+        (*err) += " in " + parent_node;
+      }
+      (*err) += ".\n";
+    }
+    return false;
+  }
+  // Reserve up front: growing from empty costs 3 allocations for a vec3/vec4.
+  ret->reserve(count);
+  for (auto i = begin; i != end; ++i) {
     double numberValue;
     const bool isNumber = detail::GetNumber(*i, numberValue);
     if (!isNumber) {
@@ -3585,7 +7417,8 @@ static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
       }
       return false;
     }
-    ret->push_back(numberValue);
+    ret->push_back(
+        static_cast<typename Container::value_type>(numberValue));
   }
 
   return true;
@@ -3624,8 +7457,10 @@ static bool ParseIntegerArrayProperty(std::vector<int> *ret, std::string *err,
   }
 
   ret->clear();
+  auto begin = detail::ArrayBegin(detail::GetValue(it));
   auto end = detail::ArrayEnd(detail::GetValue(it));
-  for (auto i = detail::ArrayBegin(detail::GetValue(it)); i != end; ++i) {
+  ret->reserve(static_cast<size_t>(std::distance(begin, end)));
+  for (auto i = begin; i != end; ++i) {
     int numberValue;
     bool isNumber = detail::GetInt(*i, numberValue);
     if (!isNumber) {
@@ -3682,7 +7517,21 @@ static bool ParseStringProperty(
   return true;
 }
 
-static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
+#ifdef TINYGLTF_USE_ARENA
+static bool ParseStringProperty(
+    NameString *ret, std::string *err, const detail::json &o,
+    const std::string &property, bool required,
+    const std::string &parent_node = std::string()) {
+  std::string value;
+  if (!ParseStringProperty(&value, err, o, property, required, parent_node)) {
+    return false;
+  }
+  ret->assign(value.data(), value.size());
+  return true;
+}
+#endif
+
+static bool ParseStringIntegerProperty(AttributeMap *ret,
                                        std::string *err, const detail::json &o,
                                        const std::string &property,
                                        bool required,
@@ -3718,6 +7567,7 @@ static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
 
   detail::json_const_iterator dictIt(detail::ObjectBegin(dict));
   detail::json_const_iterator dictItEnd(detail::ObjectEnd(dict));
+  ret->reserve(size_t(std::distance(dictIt, dictItEnd)));
 
   for (; dictIt != dictItEnd; ++dictIt) {
     int intVal;
@@ -3873,10 +7723,12 @@ static bool ParseAsset(Asset *asset, std::string *err, const detail::json &o,
 static bool ParseImage(Image *image, const int image_idx, std::string *err,
                        std::string *warn, const detail::json &o,
                        bool store_original_json_for_extras_and_extensions,
-                       const std::string &basedir, FsCallbacks *fs,
-                       const URICallbacks *uri_cb,
+                       bool store_data_uri, const std::string &basedir,
+                       FsCallbacks *fs, const URICallbacks *uri_cb,
                        LoadImageDataFunction *LoadImageData = nullptr,
-                       void *load_image_user_data = nullptr) {
+                       void *load_image_user_data = nullptr,
+                       SharedBytes *encoded = nullptr,
+                       bool metadata_only = false) {
   // A glTF image must either reference a bufferView or an image uri
 
   // schema says oneOf [`bufferView`, `uri`]
@@ -3893,7 +7745,8 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
       (*err) +=
           "Only one of `bufferView` or `uri` should be defined, but both are "
           "defined for image[" +
-          std::to_string(image_idx) + "] name = \"" + image->name + "\"\n";
+          std::to_string(image_idx) + "] name = \"" +
+          image->name.c_str() + "\"\n";
     }
     return false;
   }
@@ -3901,8 +7754,8 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
   if (!hasBufferView && !hasURI) {
     if (err) {
       (*err) += "Neither required `bufferView` nor `uri` defined for image[" +
-                std::to_string(image_idx) + "] name = \"" + image->name +
-                "\"\n";
+                std::to_string(image_idx) + "] name = \"" +
+                image->name.c_str() + "\"\n";
     }
     return false;
   }
@@ -3930,8 +7783,8 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
     if (!ParseIntegerProperty(&bufferView, err, o, "bufferView", true)) {
       if (err) {
         (*err) += "Failed to parse `bufferView` for image[" +
-                  std::to_string(image_idx) + "] name = \"" + image->name +
-                  "\"\n";
+                  std::to_string(image_idx) + "] name = \"" +
+                  image->name.c_str() + "\"\n";
       }
       return false;
     }
@@ -3957,40 +7810,54 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
 
   // Parse URI & Load image data.
 
-  std::string uri;
-  std::string tmp_err;
-  if (!ParseStringProperty(&uri, &tmp_err, o, "uri", true)) {
+  // Data URIs are decoded straight from the JSON string.
+  const char *uri = nullptr;
+  size_t uri_len = 0;
+  if (!detail::FindMember(o, "uri", it) ||
+      !detail::GetString(detail::GetValue(it), uri, uri_len)) {
     if (err) {
       (*err) += "Failed to parse `uri` for image[" + std::to_string(image_idx) +
-                "] name = \"" + image->name + "\".\n";
+                "] name = \"" + image->name.c_str() + "\".\n";
     }
     return false;
   }
 
+  if (metadata_only) {
+    // Keep what the JSON says; the image is neither read nor decoded.
+    if (!IsDataURI(uri, uri_len) || store_data_uri) {
+      image->uri.assign(uri, uri_len);
+    }
+    ParseStringProperty(&image->mimeType, err, o, "mimeType", false);
+    return true;
+  }
+
   std::vector<unsigned char> img;
 
-  if (IsDataURI(uri)) {
-    if (!DecodeDataURI(&img, image->mimeType, uri, 0, false)) {
+  if (IsDataURI(uri, uri_len)) {
+    if (store_data_uri) {
+      image->uri.assign(uri, uri_len);
+    }
+    if (!DecodeDataURI(&img, &image->mimeType, uri, uri_len, 0, false)) {
       if (err) {
         (*err) += "Failed to decode 'uri' for image[" +
-                  std::to_string(image_idx) + "] name = [" + image->name +
-                  "]\n";
+                  std::to_string(image_idx) + "] name = [" +
+                  image->name.c_str() + "]\n";
       }
       return false;
     }
   } else {
     // Assume external file
     // Keep texture path (for textures that cannot be decoded)
-    image->uri = uri;
+    image->uri.assign(uri, uri_len);
 #ifdef TINYGLTF_NO_EXTERNAL_IMAGE
     return true;
 #else
     std::string decoded_uri;
-    if (!uri_cb->decode(uri, &decoded_uri, uri_cb->user_data)) {
+    if (!uri_cb->decode(image->uri, &decoded_uri, uri_cb->user_data)) {
       if (warn) {
         (*warn) += "Failed to decode 'uri' for image[" +
-                   std::to_string(image_idx) + "] name = [" + image->name +
-                   "]\n";
+                   std::to_string(image_idx) + "] name = [" +
+                   image->name.c_str() + "]\n";
       }
 
       // Image loading failure is not critical to overall gltf loading.
@@ -4002,8 +7869,8 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
                           /* checksize */ false, fs)) {
       if (warn) {
         (*warn) += "Failed to load external 'uri' for image[" +
-                   std::to_string(image_idx) + "] name = [" + image->name +
-                   "]\n";
+                   std::to_string(image_idx) + "] name = [" +
+                   image->name.c_str() + "]\n";
       }
       // If the image cannot be loaded, keep uri as image->uri.
       return true;
@@ -4012,14 +7879,20 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
     if (img.empty()) {
       if (warn) {
         (*warn) += "Image data is empty for image[" +
-                   std::to_string(image_idx) + "] name = [" + image->name +
-                   "] \n";
+                   std::to_string(image_idx) + "] name = [" +
+                   image->name.c_str() + "] \n";
       }
       return false;
     }
 #endif
   }
 
+  if (encoded) {
+    // The caller decodes the image data later.
+    (*encoded) = std::move(img);
+    return true;
+  }
+
   if (*LoadImageData == nullptr) {
     if (err) {
       (*err) += "No LoadImageData callback specified.\n";
@@ -4175,10 +8048,13 @@ static bool ParseOcclusionTextureInfo(
 
 static bool ParseBuffer(Buffer *buffer, std::string *err, const detail::json &o,
                         bool store_original_json_for_extras_and_extensions,
-                        FsCallbacks *fs, const URICallbacks *uri_cb,
-                        const std::string &basedir, bool is_binary = false,
+                        bool store_data_uri, FsCallbacks *fs,
+                        const URICallbacks *uri_cb, const std::string &basedir,
+                        bool is_binary = false,
                         const unsigned char *bin_data = nullptr,
-                        size_t bin_size = 0) {
+                        size_t bin_size = 0,
+                        const std::shared_ptr<const void> &bin_owner = nullptr,
+                        bool skip_data = false) {
   size_t byteLength;
   if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
                              "Buffer")) {
@@ -4187,10 +8063,25 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const detail::json &o,
 
   // In glTF 2.0, uri is not mandatory anymore
   buffer->uri.clear();
-  ParseStringProperty(&buffer->uri, err, o, "uri", false, "Buffer");
+
+  // Data URIs are decoded straight from the JSON string, so their text is
+  // only copied to `buffer->uri` when requested.
+  const char *uri = nullptr;
+  size_t uri_len = 0;
+  {
+    detail::json_const_iterator it;
+    if (detail::FindMember(o, "uri", it)) {
+      detail::GetString(detail::GetValue(it), uri, uri_len);
+    }
+  }
+  const bool has_uri = uri_len > 0;
+  const bool is_data_uri = has_uri && IsDataURI(uri, uri_len);
+  if (has_uri && (!is_data_uri || store_data_uri)) {
+    buffer->uri.assign(uri, uri_len);
+  }
 
   // having an empty uri for a non embedded image should not be valid
-  if (!is_binary && buffer->uri.empty()) {
+  if (!is_binary && !has_uri) {
     if (err) {
       (*err) += "'uri' is missing from non binary glTF file buffer.\n";
     }
@@ -4206,82 +8097,64 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const detail::json &o,
     }
   }
 
-  if (is_binary) {
-    // Still binary glTF accepts external dataURI.
-    if (!buffer->uri.empty()) {
-      // First try embedded data URI.
-      if (IsDataURI(buffer->uri)) {
-        std::string mime_type;
-        if (!DecodeDataURI(&buffer->data, mime_type, buffer->uri, byteLength,
-                           true)) {
-          if (err) {
-            (*err) +=
-                "Failed to decode 'uri' : " + buffer->uri + " in Buffer\n";
-          }
-          return false;
-        }
-      } else {
-        // External .bin file.
-        std::string decoded_uri;
-        if (!uri_cb->decode(buffer->uri, &decoded_uri, uri_cb->user_data)) {
-          return false;
-        }
-        if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr,
-                              decoded_uri, basedir, /* required */ true,
-                              byteLength, /* checkSize */ true, fs)) {
-          return false;
-        }
+  std::vector<unsigned char> data;
+  if (skip_data) {
+    // Metadata only load; the payload is not read.
+  } else if (is_data_uri) {
+    // Embedded data URI. Still binary glTF accepts it.
+    std::string mime_type;
+    if (!DecodeDataURI(&data, &mime_type, uri, uri_len, byteLength, true)) {
+      if (err) {
+        (*err) += "Failed to decode 'uri' : " + std::string(uri, uri_len) +
+                  " in Buffer\n";
       }
-    } else {
-      // load data from (embedded) binary data
+      return false;
+    }
+  } else if (has_uri || !is_binary) {
+    // External .bin file.
+    std::string decoded_uri;
+    if (!uri_cb->decode(buffer->uri, &decoded_uri, uri_cb->user_data)) {
+      return false;
+    }
+    if (!LoadExternalFile(&data, err, /* warn */ nullptr, decoded_uri,
+                          basedir, /* required */ true, byteLength,
+                          /* checkSize */ true, fs)) {
+      return false;
+    }
+  } else {
+    // load data from (embedded) binary data
 
-      if ((bin_size == 0) || (bin_data == nullptr)) {
-        if (err) {
-          (*err) += "Invalid binary data in `Buffer', or GLB with empty BIN chunk.\n";
-        }
-        return false;
+    if ((bin_size == 0) || (bin_data == nullptr)) {
+      if (err) {
+        (*err) += "Invalid binary data in `Buffer', or GLB with empty BIN chunk.\n";
       }
+      return false;
+    }
 
-      if (byteLength > bin_size) {
-        if (err) {
-          std::stringstream ss;
-          ss << "Invalid `byteLength'. Must be equal or less than binary size: "
-                "`byteLength' = "
-             << byteLength << ", binary size = " << bin_size << std::endl;
-          (*err) += ss.str();
-        }
-        return false;
+    if (byteLength > bin_size) {
+      if (err) {
+        std::stringstream ss;
+        ss << "Invalid `byteLength'. Must be equal or less than binary size: "
+              "`byteLength' = "
+           << byteLength << ", binary size = " << bin_size << std::endl;
+        (*err) += ss.str();
       }
-
-      // Read buffer data
-      buffer->data.resize(static_cast<size_t>(byteLength));
-      memcpy(&(buffer->data.at(0)), bin_data, static_cast<size_t>(byteLength));
+      return false;
     }
 
-  } else {
-    if (IsDataURI(buffer->uri)) {
-      std::string mime_type;
-      if (!DecodeDataURI(&buffer->data, mime_type, buffer->uri, byteLength,
-                         true)) {
-        if (err) {
-          (*err) += "Failed to decode 'uri' : " + buffer->uri + " in Buffer\n";
-        }
-        return false;
-      }
+    if (bin_owner) {
+      // Reference the BIN chunk in place; `bin_owner` keeps it alive.
+      buffer->data = SharedBytes(bin_data, byteLength, bin_owner);
     } else {
-      // Assume external .bin file.
-      std::string decoded_uri;
-      if (!uri_cb->decode(buffer->uri, &decoded_uri, uri_cb->user_data)) {
-        return false;
-      }
-      if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr, decoded_uri,
-                            basedir, /* required */ true, byteLength,
-                            /* checkSize */ true, fs)) {
-        return false;
-      }
+      // Read buffer data
+      data.assign(bin_data, bin_data + byteLength);
     }
   }
 
+  if (!data.empty()) {
+    buffer->data = std::move(data);
+  }
+
   ParseStringProperty(&buffer->name, err, o, "name", false);
 
   ParseExtensionsProperty(&buffer->extensions, err, o);
@@ -4649,7 +8522,7 @@ static bool ParseDracoExtension(Primitive *primitive, Model *model,
   int bufferView = bufferViewValue.Get<int>();
 
   BufferView &view = model->bufferViews[bufferView];
-  Buffer &buffer = model->buffers[view.buffer];
+  const Buffer &buffer = model->buffers[view.buffer];
   // BufferView has already been decoded
   if (view.dracoDecoded) return true;
   view.dracoDecoded = true;
@@ -4672,10 +8545,12 @@ static bool ParseDracoExtension(Primitive *primitive, Model *model,
   if (primitive->indices >= 0) {
     int32_t componentSize = GetComponentSizeInBytes(
         model->accessors[primitive->indices].componentType);
-    Buffer decodedIndexBuffer;
-    decodedIndexBuffer.data.resize(mesh->num_faces() * 3 * componentSize);
+    std::vector<uint8_t> indexData(mesh->num_faces() * 3 * componentSize);
+
+    DecodeIndexBuffer(mesh.get(), componentSize, indexData);
 
-    DecodeIndexBuffer(mesh.get(), componentSize, decodedIndexBuffer.data);
+    Buffer decodedIndexBuffer;
+    decodedIndexBuffer.data = std::move(indexData);
 
     model->buffers.emplace_back(std::move(decodedIndexBuffer));
 
@@ -4704,15 +8579,17 @@ static bool ParseDracoExtension(Primitive *primitive, Model *model,
         model->accessors[primitiveAttribute->second].componentType;
 
     // Create a new buffer for this decoded buffer
-    Buffer decodedBuffer;
     size_t bufferSize = mesh->num_points() * pAttribute->num_components() *
                         GetComponentSizeInBytes(componentType);
-    decodedBuffer.data.resize(bufferSize);
+    std::vector<uint8_t> attributeData(bufferSize);
 
     if (!GetAttributeForAllPoints(componentType, mesh.get(), pAttribute,
-                                  decodedBuffer.data))
+                                  attributeData))
       return false;
 
+    Buffer decodedBuffer;
+    decodedBuffer.data = std::move(attributeData);
+
     model->buffers.emplace_back(std::move(decodedBuffer));
 
     BufferView decodedBufferView;
@@ -4761,7 +8638,7 @@ static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
     auto targetsObjectEnd = detail::ArrayEnd(detail::GetValue(targetsObject));
     for (detail::json_const_array_iterator i = detail::ArrayBegin(detail::GetValue(targetsObject));
          i != targetsObjectEnd; ++i) {
-      std::map<std::string, int> targetAttribues;
+      AttributeMap targetAttribues;
 
       const detail::json &dict = *i;
       if (detail::IsObject(dict)) {
@@ -4799,7 +8676,7 @@ static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
 #ifdef TINYGLTF_ENABLE_DRACO
   auto dracoExtension =
       primitive->extensions.find("KHR_draco_mesh_compression");
-  if (dracoExtension != primitive->extensions.end()) {
+  if (model && dracoExtension != primitive->extensions.end()) {
     ParseDracoExtension(primitive, model, err, dracoExtension->second);
   }
 #else
@@ -4861,12 +8738,31 @@ static bool ParseNode(Node *node, std::string *err, const detail::json &o,
   ParseIntegerProperty(&skin, err, o, "skin", false);
   node->skin = skin;
 
+#ifdef TINYGLTF_COMPACT_NODE
+  // Inline transform arrays have a fixed capacity, so an oversized array is
+  // a hard error instead of being silently truncated.
+  std::string transform_err;
+  std::string *node_err = &transform_err;
+#else
+  std::string *node_err = err;
+#endif
+
   // Matrix and T/R/S are exclusive
-  if (!ParseNumberArrayProperty(&node->matrix, err, o, "matrix", false)) {
-    ParseNumberArrayProperty(&node->rotation, err, o, "rotation", false);
-    ParseNumberArrayProperty(&node->scale, err, o, "scale", false);
-    ParseNumberArrayProperty(&node->translation, err, o, "translation", false);
+  if (!ParseNumberArrayProperty(&node->matrix, node_err, o, "matrix", false)) {
+    ParseNumberArrayProperty(&node->rotation, node_err, o, "rotation", false);
+    ParseNumberArrayProperty(&node->scale, node_err, o, "scale", false);
+    ParseNumberArrayProperty(&node->translation, node_err, o, "translation",
+                             false);
+  }
+
+#ifdef TINYGLTF_COMPACT_NODE
+  if (!transform_err.empty()) {
+    if (err) {
+      (*err) += transform_err;
+    }
+    return false;
   }
+#endif
 
   int camera = -1;
   ParseIntegerProperty(&camera, err, o, "camera", false);
@@ -5545,98 +9441,877 @@ static bool ParseCamera(Camera *camera, std::string *err, const detail::json &o,
         camera->extras_json_string = detail::JsonToString(detail::GetValue(it));
       }
     }
-  }
+  }
+
+  return true;
+}
+
+static bool ParseLight(Light *light, std::string *err, const detail::json &o,
+                       bool store_original_json_for_extras_and_extensions) {
+  if (!ParseStringProperty(&light->type, err, o, "type", true)) {
+    return false;
+  }
+
+  if (light->type == "spot") {
+    detail::json_const_iterator spotIt;
+    if (!detail::FindMember(o, "spot", spotIt)) {
+      if (err) {
+        std::stringstream ss;
+        ss << "Spot light description not found." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
+
+    const detail::json &v = detail::GetValue(spotIt);
+    if (!detail::IsObject(v)) {
+      if (err) {
+        std::stringstream ss;
+        ss << "\"spot\" is not a JSON object." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
+
+    if (!ParseSpotLight(&light->spot, err, v,
+                        store_original_json_for_extras_and_extensions)) {
+      return false;
+    }
+  }
+
+  ParseStringProperty(&light->name, err, o, "name", false);
+  ParseNumberArrayProperty(&light->color, err, o, "color", false);
+  ParseNumberProperty(&light->range, err, o, "range", false);
+  ParseNumberProperty(&light->intensity, err, o, "intensity", false);
+  ParseExtensionsProperty(&light->extensions, err, o);
+  ParseExtrasProperty(&(light->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      detail::json_const_iterator it;
+      if (detail::FindMember(o, "extensions", it)) {
+        light->extensions_json_string = detail::JsonToString(detail::GetValue(it));
+      }
+    }
+    {
+      detail::json_const_iterator it;
+      if (detail::FindMember(o, "extras", it)) {
+        light->extras_json_string = detail::JsonToString(detail::GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+// Parses `o` with `parse` and appends the result to `out`.
+template <typename T, typename Fn>
+static bool AppendArrayElement(std::vector<T> *out, std::string *err,
+                               const detail::json &o, const Fn &parse) {
+  T element;
+  if (!parse(&element, err, o)) {
+    return false;
+  }
+  out->emplace_back(std::move(element));
+  return true;
+}
+
+// Parses the elements of the JSON array `arr` with `parse` and appends them
+// to `out`, stopping at the first element which fails. With a `pool`, large
+// arrays are parsed in parallel chunks into the pre-sized `out`. `out` and
+// the messages appended to `err` are the same as for the sequential parse.
+// Elements whose entry in `keep` is 0 are not parsed and are left default
+// constructed, so that indices into `out` stay valid.
+template <typename T, typename Fn>
+static bool ParseArrayElements(std::vector<T> *out, std::string *err,
+                               const detail::json &arr, ThreadPool *pool,
+                               const Fn &parse,
+                               const std::vector<char> *keep = nullptr) {
+  const size_t kChunkSize = 256;
+
+  const detail::json_const_array_iterator begin = detail::ArrayBegin(arr);
+  const detail::json_const_array_iterator end = detail::ArrayEnd(arr);
+  const size_t n = static_cast<size_t>(std::distance(begin, end));
+  auto Skipped = [keep](size_t i) {
+    return keep && (i < keep->size()) && !(*keep)[i];
+  };
+  if (!pool || (n <= kChunkSize)) {
+    out->reserve(out->size() + n);
+    size_t i = 0;
+    for (detail::json_const_array_iterator it = begin; it != end; ++it, ++i) {
+      if (Skipped(i)) {
+        out->emplace_back();
+      } else if (!AppendArrayElement(out, err, *it, parse)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const size_t base = out->size();
+  out->resize(base + n);
+  std::vector<std::string> errs(err ? n : 0);
+  std::atomic<size_t> first_failure(n);
+
+  pool->ParallelFor((n + kChunkSize - 1) / kChunkSize, [&](size_t chunk) {
+    const size_t chunk_end = std::min(n, (chunk + 1) * kChunkSize);
+    for (size_t i = chunk * kChunkSize; i < chunk_end; i++) {
+      if (i > first_failure.load()) {
+        return;  // Dropped anyway, as the sequential parse stops earlier.
+      }
+      if (Skipped(i)) {
+        continue;
+      }
+      const detail::json &o = *(begin + std::ptrdiff_t(i));
+      if (!parse(&(*out)[base + i], err ? &errs[i] : nullptr, o)) {
+        size_t failed = first_failure.load();
+        while ((i < failed) &&
+               !first_failure.compare_exchange_weak(failed, i)) {
+        }
+        return;
+      }
+    }
+  });
+
+  const size_t failed = first_failure.load();
+  if (err) {
+    for (size_t i = 0; i < std::min(n, failed + 1); i++) {
+      (*err) += errs[i];
+    }
+  }
+  if (failed < n) {
+    out->resize(base + failed);
+    return false;
+  }
+  return true;
+}
+
+// ParseArrayElements() for the array `member` of `v`, if there is one.
+template <typename T, typename Fn>
+static bool ParseArraySection(std::vector<T> *out, std::string *err,
+                              const detail::json &v, const char *member,
+                              ThreadPool *pool, const Fn &parse,
+                              const std::vector<char> *keep = nullptr) {
+  detail::json_const_iterator it;
+  if (detail::FindMember(v, member, it) &&
+      detail::IsArray(detail::GetValue(it))) {
+    return ParseArrayElements(out, err, detail::GetValue(it), pool, parse,
+                              keep);
+  }
+  return true;
+}
+
+// Which elements of the top-level arrays a filtered load parses (see
+// TinyGLTF::SetSkipSections and SetSceneFilter).
+struct SectionMasks {
+  std::vector<char> scenes, nodes, meshes, skins, cameras, materials,
+      textures, samplers, images, animations, accessors, bufferViews, buffers;
+};
+
+// Returns the array `member` of `o`, or nullptr.
+static const detail::json *FindArrayMember(const detail::json &o,
+                                           const char *member) {
+  detail::json_const_iterator it;
+  if (detail::FindMember(o, member, it) &&
+      detail::IsArray(detail::GetValue(it))) {
+    return &detail::GetValue(it);
+  }
+  return nullptr;
+}
+
+static size_t ArraySize(const detail::json *arr) {
+  if (!arr) return 0;
+  return size_t(
+      std::distance(detail::ArrayBegin(*arr), detail::ArrayEnd(*arr)));
+}
+
+static const detail::json &ArrayElement(const detail::json &arr, size_t i) {
+  return *(detail::ArrayBegin(arr) + std::ptrdiff_t(i));
+}
+
+// Sets mask[index]; returns true if it was not set before.
+static bool MarkIndex(std::vector<char> *mask, int index) {
+  if (index < 0 || size_t(index) >= mask->size() || (*mask)[size_t(index)]) {
+    return false;
+  }
+  (*mask)[size_t(index)] = 1;
+  return true;
+}
+
+static void MarkIntMember(const detail::json &o, const char *member,
+                          std::vector<char> *mask) {
+  detail::json_const_iterator it;
+  int index;
+  if (detail::FindMember(o, member, it) &&
+      detail::GetInt(detail::GetValue(it), index)) {
+    MarkIndex(mask, index);
+  }
+}
+
+// Marks every integer member named `member` at any depth below `o`. Used for
+// references which extensions may add, e.g. texture "index" in materials.
+static void MarkIntMembersDeep(const detail::json &o, const char *member,
+                               std::vector<char> *mask) {
+  if (detail::IsArray(o)) {
+    for (auto it = detail::ArrayBegin(o); it != detail::ArrayEnd(o); ++it) {
+      MarkIntMembersDeep(*it, member, mask);
+    }
+  } else if (detail::IsObject(o)) {
+    detail::json_const_iterator it = detail::ObjectBegin(o);
+    detail::json_const_iterator end = detail::ObjectEnd(o);
+    for (; it != end; ++it) {
+      int index;
+      if (detail::GetKey(it) == member &&
+          detail::GetInt(detail::GetValue(it), index)) {
+        MarkIndex(mask, index);
+      } else {
+        MarkIntMembersDeep(detail::GetValue(it), member, mask);
+      }
+    }
+  }
+}
+
+// Marks the integer values of all members of the object `o`, such as the
+// accessors of primitive attributes.
+static void MarkIntMemberValues(const detail::json &o,
+                                std::vector<char> *mask) {
+  if (!detail::IsObject(o)) return;
+  detail::json_const_iterator it = detail::ObjectBegin(o);
+  detail::json_const_iterator end = detail::ObjectEnd(o);
+  for (; it != end; ++it) {
+    int index;
+    if (detail::GetInt(detail::GetValue(it), index)) {
+      MarkIndex(mask, index);
+    }
+  }
+}
+
+// Marks the accessors an extension object `o` references at any depth: the
+// values of "attributes" objects (e.g. EXT_mesh_gpu_instancing) and integer
+// members named "accessor". Unknown extensions may mark more than they use,
+// which only loads an accessor too many.
+static void MarkExtensionAccessorsDeep(const detail::json &o,
+                                       std::vector<char> *mask) {
+  if (detail::IsArray(o)) {
+    for (auto it = detail::ArrayBegin(o); it != detail::ArrayEnd(o); ++it) {
+      MarkExtensionAccessorsDeep(*it, mask);
+    }
+  } else if (detail::IsObject(o)) {
+    detail::json_const_iterator it = detail::ObjectBegin(o);
+    detail::json_const_iterator end = detail::ObjectEnd(o);
+    for (; it != end; ++it) {
+      const detail::json &value = detail::GetValue(it);
+      int index;
+      if (detail::GetKey(it) == "attributes" && detail::IsObject(value)) {
+        MarkIntMemberValues(value, mask);
+      } else if (detail::GetKey(it) == "accessor" &&
+                 detail::GetInt(value, index)) {
+        MarkIndex(mask, index);
+      } else {
+        MarkExtensionAccessorsDeep(value, mask);
+      }
+    }
+  }
+}
+
+// Marks the accessors the "extensions" of `o` reference.
+static void MarkExtensionAccessors(const detail::json &o,
+                                   std::vector<char> *mask) {
+  detail::json_const_iterator it;
+  if (detail::FindMember(o, "extensions", it)) {
+    MarkExtensionAccessorsDeep(detail::GetValue(it), mask);
+  }
+}
+
+// Marks the integers of the array `member` of `o` and returns the ones which
+// were newly marked.
+static std::vector<int> MarkIntArrayMember(const detail::json &o,
+                                           const char *member,
+                                           std::vector<char> *mask) {
+  std::vector<int> marked;
+  const detail::json *arr = FindArrayMember(o, member);
+  if (!arr) return marked;
+  for (auto it = detail::ArrayBegin(*arr); it != detail::ArrayEnd(*arr);
+       ++it) {
+    int index;
+    if (detail::GetInt(*it, index) && MarkIndex(mask, index)) {
+      marked.push_back(index);
+    }
+  }
+  return marked;
+}
+
+// Marks the elements a load needs: with `scene` >= 0 only what that scene
+// reaches, otherwise every element of the sections not in `skip`. Accessors,
+// bufferViews and buffers are marked only when something loaded uses them,
+// including the extensions of loaded nodes, meshes and primitives.
+static void ComputeSectionMasks(const detail::json &v, int scene,
+                                unsigned int skip, SectionMasks *masks) {
+  const detail::json *scenes = FindArrayMember(v, "scenes");
+  const detail::json *nodes = FindArrayMember(v, "nodes");
+  const detail::json *meshes = FindArrayMember(v, "meshes");
+  const detail::json *skins =
+      (skip & SKIP_SKINS) ? nullptr : FindArrayMember(v, "skins");
+  const detail::json *materials = FindArrayMember(v, "materials");
+  const detail::json *textures = FindArrayMember(v, "textures");
+  const detail::json *images =
+      (skip & SKIP_IMAGES) ? nullptr : FindArrayMember(v, "images");
+  const detail::json *animations =
+      (skip & SKIP_ANIMATIONS) ? nullptr : FindArrayMember(v, "animations");
+  const detail::json *accessors = FindArrayMember(v, "accessors");
+  const detail::json *buffer_views = FindArrayMember(v, "bufferViews");
+
+  const bool all = scene < 0;
+  masks->scenes.assign(ArraySize(scenes), all);
+  masks->nodes.assign(ArraySize(nodes), all);
+  masks->meshes.assign(ArraySize(meshes), all);
+  masks->skins.assign(ArraySize(skins), all);
+  masks->cameras.assign(ArraySize(FindArrayMember(v, "cameras")), all);
+  masks->materials.assign(ArraySize(materials), all);
+  masks->textures.assign(ArraySize(textures), all);
+  masks->samplers.assign(ArraySize(FindArrayMember(v, "samplers")), all);
+  masks->images.assign(ArraySize(images), all);
+  masks->animations.assign(ArraySize(animations), 0);
+  masks->accessors.assign(ArraySize(accessors), 0);
+  masks->bufferViews.assign(ArraySize(buffer_views), 0);
+  masks->buffers.assign(ArraySize(FindArrayMember(v, "buffers")), 0);
+
+  // Nodes, closed over children and skin joints.
+  std::vector<int> pending;
+  if (all) {
+    for (size_t i = 0; i < masks->nodes.size(); i++) {
+      pending.push_back(int(i));
+    }
+  } else if (MarkIndex(&masks->scenes, scene)) {
+    pending = MarkIntArrayMember(ArrayElement(*scenes, size_t(scene)),
+                                 "nodes", &masks->nodes);
+  }
+  while (!pending.empty()) {
+    const detail::json &node = ArrayElement(*nodes, size_t(pending.back()));
+    pending.pop_back();
+    for (int child : MarkIntArrayMember(node, "children", &masks->nodes)) {
+      pending.push_back(child);
+    }
+    MarkIntMember(node, "mesh", &masks->meshes);
+    MarkIntMember(node, "camera", &masks->cameras);
+
+    detail::json_const_iterator it;
+    int skin;
+    if (skins && detail::FindMember(node, "skin", it) &&
+        detail::GetInt(detail::GetValue(it), skin) &&
+        MarkIndex(&masks->skins, skin)) {
+      const detail::json &o = ArrayElement(*skins, size_t(skin));
+      for (int joint : MarkIntArrayMember(o, "joints", &masks->nodes)) {
+        pending.push_back(joint);
+      }
+      int skeleton;
+      if (detail::FindMember(o, "skeleton", it) &&
+          detail::GetInt(detail::GetValue(it), skeleton) &&
+          MarkIndex(&masks->nodes, skeleton)) {
+        pending.push_back(skeleton);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < masks->skins.size(); i++) {
+    if (masks->skins[i]) {
+      MarkIntMember(ArrayElement(*skins, i), "inverseBindMatrices",
+                    &masks->accessors);
+    }
+  }
+
+  const bool extensions = !(skip & SKIP_EXTRAS_AND_EXTENSIONS);
+  for (size_t i = 0; extensions && i < masks->nodes.size(); i++) {
+    if (masks->nodes[i]) {
+      MarkExtensionAccessors(ArrayElement(*nodes, i), &masks->accessors);
+    }
+  }
+
+  for (size_t i = 0; i < masks->meshes.size(); i++) {
+    if (!masks->meshes[i]) continue;
+    const detail::json &mesh = ArrayElement(*meshes, i);
+    if (extensions) {
+      MarkExtensionAccessors(mesh, &masks->accessors);
+    }
+    const detail::json *primitives = FindArrayMember(mesh, "primitives");
+    for (size_t p = 0; p < ArraySize(primitives); p++) {
+      const detail::json &primitive = ArrayElement(*primitives, p);
+      detail::json_const_iterator it;
+      if (detail::FindMember(primitive, "attributes", it)) {
+        MarkIntMemberValues(detail::GetValue(it), &masks->accessors);
+      }
+      const detail::json *targets = FindArrayMember(primitive, "targets");
+      for (size_t t = 0; t < ArraySize(targets); t++) {
+        MarkIntMemberValues(ArrayElement(*targets, t), &masks->accessors);
+      }
+      MarkIntMember(primitive, "indices", &masks->accessors);
+      MarkIntMember(primitive, "material", &masks->materials);
+      // Compressed primitives (e.g. KHR_draco_mesh_compression).
+      if (detail::FindMember(primitive, "extensions", it)) {
+        MarkIntMembersDeep(detail::GetValue(it), "bufferView",
+                           &masks->bufferViews);
+      }
+      if (extensions) {
+        MarkExtensionAccessors(primitive, &masks->accessors);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < masks->animations.size(); i++) {
+    const detail::json &animation = ArrayElement(*animations, i);
+    bool targets_loaded_node = all;
+    const detail::json *channels = FindArrayMember(animation, "channels");
+    for (size_t c = 0; !targets_loaded_node && c < ArraySize(channels); c++) {
+      detail::json_const_iterator it;
+      int node;
+      if (detail::FindMember(ArrayElement(*channels, c), "target", it) &&
+          detail::FindMember(detail::GetValue(it), "node", it) &&
+          detail::GetInt(detail::GetValue(it), node) && node >= 0 &&
+          size_t(node) < masks->nodes.size() && masks->nodes[size_t(node)]) {
+        targets_loaded_node = true;
+      }
+    }
+    if (!targets_loaded_node) continue;
+    masks->animations[i] = 1;
+    const detail::json *samplers = FindArrayMember(animation, "samplers");
+    for (size_t s = 0; s < ArraySize(samplers); s++) {
+      MarkIntMember(ArrayElement(*samplers, s), "input", &masks->accessors);
+      MarkIntMember(ArrayElement(*samplers, s), "output", &masks->accessors);
+    }
+  }
+
+  for (size_t i = 0; i < masks->materials.size(); i++) {
+    if (masks->materials[i]) {
+      MarkIntMembersDeep(ArrayElement(*materials, i), "index",
+                         &masks->textures);
+    }
+  }
+  for (size_t i = 0; i < masks->textures.size(); i++) {
+    if (!masks->textures[i]) continue;
+    const detail::json &texture = ArrayElement(*textures, i);
+    MarkIntMembersDeep(texture, "source", &masks->images);
+    MarkIntMember(texture, "sampler", &masks->samplers);
+  }
+  for (size_t i = 0; i < masks->images.size(); i++) {
+    if (masks->images[i]) {
+      MarkIntMember(ArrayElement(*images, i), "bufferView",
+                    &masks->bufferViews);
+    }
+  }
+
+  for (size_t i = 0; i < masks->accessors.size(); i++) {
+    if (!masks->accessors[i]) continue;
+    const detail::json &accessor = ArrayElement(*accessors, i);
+    MarkIntMember(accessor, "bufferView", &masks->bufferViews);
+    detail::json_const_iterator it;
+    if (detail::FindMember(accessor, "sparse", it)) {
+      const detail::json &sparse = detail::GetValue(it);
+      if (detail::FindMember(sparse, "indices", it)) {
+        MarkIntMember(detail::GetValue(it), "bufferView", &masks->bufferViews);
+      }
+      if (detail::FindMember(sparse, "values", it)) {
+        MarkIntMember(detail::GetValue(it), "bufferView", &masks->bufferViews);
+      }
+    }
+  }
+  for (size_t i = 0; i < masks->bufferViews.size(); i++) {
+    if (masks->bufferViews[i]) {
+      // Includes the buffers of bufferView extensions such as
+      // EXT_meshopt_compression.
+      MarkIntMembersDeep(ArrayElement(*buffer_views, i), "buffer",
+                         &masks->buffers);
+    }
+  }
+}
+
+bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
+                              const char *json_str,
+                              unsigned int json_str_length,
+                              const std::string &base_dir,
+                              unsigned int check_sections,
+                              const LoadContext &ctx) {
+  FsCallbacks *load_fs = ctx.fs ? ctx.fs : &fs;
+#ifdef TINYGLTF_USE_ARENA
+  Arena::Scope arena_scope(arena_);
+#endif
+
+  if (json_str_length < 4) {
+    if (err) {
+      (*err) = "JSON string too short.\n";
+    }
+    return false;
+  }
+
+  auto ResetModel = [model]() {
+    model->buffers.clear();
+    model->bufferViews.clear();
+    model->accessors.clear();
+    model->meshes.clear();
+    model->cameras.clear();
+    model->nodes.clear();
+    model->extensionsUsed.clear();
+    model->extensionsRequired.clear();
+    model->extensions.clear();
+    model->defaultScene = -1;
+    model->validated = false;
+  };
+
+  // Parsers for the elements of the top-level arrays. With streaming JSON
+  // parsing they are called while the JSON is being read, in document order.
+  // With parallel section parsing they run concurrently, so they must only
+  // write to `out` and `elem_err`.
+  auto ParseBufferElement = [&](Buffer *out, std::string *elem_err,
+                                const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`buffers' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Buffer buffer;
+    if (!ParseBuffer(&buffer, elem_err, o,
+                     store_original_json_for_extras_and_extensions_,
+                     store_data_uris_, load_fs, &uri_cb, base_dir,
+                     ctx.is_binary, ctx.bin_data, ctx.bin_size,
+                     ctx.bin_owner, ctx.metadata_only)) {
+      return false;
+    }
+
+    *out = std::move(buffer);
+    return true;
+  };
+
+  auto ParseBufferViewElement = [&](BufferView *out, std::string *elem_err,
+                                    const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`bufferViews' does not contain an JSON object.";
+      }
+      return false;
+    }
+    BufferView bufferView;
+    if (!ParseBufferView(&bufferView, elem_err, o,
+                         store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
+
+    *out = std::move(bufferView);
+    return true;
+  };
+
+  auto ParseAccessorElement = [&](Accessor *out, std::string *elem_err,
+                                  const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`accessors' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Accessor accessor;
+    if (!ParseAccessor(&accessor, elem_err, o,
+                       store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
+
+    *out = std::move(accessor);
+    return true;
+  };
+
+  auto ParseMeshElement = [&](Mesh *out, std::string *elem_err,
+                              const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`meshes' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Mesh mesh;
+    // Without buffer data there is nothing to decode Draco primitives from.
+    if (!ParseMesh(&mesh, ctx.metadata_only ? nullptr : model, elem_err, o,
+                   store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
+
+    *out = std::move(mesh);
+    return true;
+  };
+
+  auto ParseNodeElement = [&](Node *out, std::string *elem_err,
+                              const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`nodes' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Node node;
+    if (!ParseNode(&node, elem_err, o,
+                   store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
+
+    *out = std::move(node);
+    return true;
+  };
+
+  auto ParseSceneElement = [&](Scene *out, std::string *elem_err,
+                               const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`scenes' does not contain an JSON object.";
+      }
+      return false;
+    }
+    std::vector<int> nodes;
+    ParseIntegerArrayProperty(&nodes, elem_err, o, "nodes", false);
+
+    Scene scene;
+    scene.nodes = std::move(nodes);
+
+    ParseStringProperty(&scene.name, elem_err, o, "name", false);
+
+    ParseExtensionsProperty(&scene.extensions, elem_err, o);
+    ParseExtrasProperty(&scene.extras, o);
+
+    if (store_original_json_for_extras_and_extensions_) {
+      {
+        detail::json_const_iterator it;
+        if (detail::FindMember(o, "extensions", it)) {
+          scene.extensions_json_string = detail::JsonToString(detail::GetValue(it));
+        }
+      }
+      {
+        detail::json_const_iterator it;
+        if (detail::FindMember(o, "extras", it)) {
+          scene.extras_json_string = detail::JsonToString(detail::GetValue(it));
+        }
+      }
+    }
+
+    *out = std::move(scene);
+    return true;
+  };
+
+  auto ParseMaterialElement = [&](Material *out, std::string *elem_err,
+                                  const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`materials' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Material material;
+    ParseStringProperty(&material.name, elem_err, o, "name", false);
 
-  return true;
-}
+    if (!ParseMaterial(&material, elem_err, o,
+                       store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
 
-static bool ParseLight(Light *light, std::string *err, const detail::json &o,
-                       bool store_original_json_for_extras_and_extensions) {
-  if (!ParseStringProperty(&light->type, err, o, "type", true)) {
-    return false;
-  }
+    *out = std::move(material);
+    return true;
+  };
 
-  if (light->type == "spot") {
-    detail::json_const_iterator spotIt;
-    if (!detail::FindMember(o, "spot", spotIt)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "Spot light description not found." << std::endl;
-        (*err) += ss.str();
+  auto ParseTextureElement = [&](Texture *out, std::string *elem_err,
+                                 const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`textures' does not contain an JSON object.";
       }
       return false;
     }
+    Texture texture;
+    if (!ParseTexture(&texture, elem_err, o,
+                      store_original_json_for_extras_and_extensions_,
+                      base_dir)) {
+      return false;
+    }
 
-    const detail::json &v = detail::GetValue(spotIt);
-    if (!detail::IsObject(v)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "\"spot\" is not a JSON object." << std::endl;
-        (*err) += ss.str();
+    *out = std::move(texture);
+    return true;
+  };
+
+  auto ParseAnimationElement = [&](Animation *out, std::string *elem_err,
+                                   const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`animations' does not contain an JSON object.";
       }
       return false;
     }
-
-    if (!ParseSpotLight(&light->spot, err, v,
-                        store_original_json_for_extras_and_extensions)) {
+    Animation animation;
+    if (!ParseAnimation(&animation, elem_err, o,
+                        store_original_json_for_extras_and_extensions_)) {
       return false;
     }
-  }
 
-  ParseStringProperty(&light->name, err, o, "name", false);
-  ParseNumberArrayProperty(&light->color, err, o, "color", false);
-  ParseNumberProperty(&light->range, err, o, "range", false);
-  ParseNumberProperty(&light->intensity, err, o, "intensity", false);
-  ParseExtensionsProperty(&light->extensions, err, o);
-  ParseExtrasProperty(&(light->extras), o);
+    *out = std::move(animation);
+    return true;
+  };
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      detail::json_const_iterator it;
-      if (detail::FindMember(o, "extensions", it)) {
-        light->extensions_json_string = detail::JsonToString(detail::GetValue(it));
+  auto ParseSkinElement = [&](Skin *out, std::string *elem_err,
+                              const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`skins' does not contain an JSON object.";
       }
+      return false;
     }
-    {
-      detail::json_const_iterator it;
-      if (detail::FindMember(o, "extras", it)) {
-        light->extras_json_string = detail::JsonToString(detail::GetValue(it));
+    Skin skin;
+    if (!ParseSkin(&skin, elem_err, o,
+                   store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
+
+    *out = std::move(skin);
+    return true;
+  };
+
+  auto ParseSamplerElement = [&](Sampler *out, std::string *elem_err,
+                                 const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`samplers' does not contain an JSON object.";
       }
+      return false;
+    }
+    Sampler sampler;
+    if (!ParseSampler(&sampler, elem_err, o,
+                      store_original_json_for_extras_and_extensions_)) {
+      return false;
     }
-  }
 
-  return true;
-}
+    *out = std::move(sampler);
+    return true;
+  };
 
-bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
-                              const char *json_str,
-                              unsigned int json_str_length,
-                              const std::string &base_dir,
-                              unsigned int check_sections) {
-  if (json_str_length < 4) {
-    if (err) {
-      (*err) = "JSON string too short.\n";
+  auto ParseCameraElement = [&](Camera *out, std::string *elem_err,
+                                const detail::json &o) -> bool {
+    if (!detail::IsObject(o)) {
+      if (elem_err) {
+        (*elem_err) += "`cameras' does not contain an JSON object.";
+      }
+      return false;
     }
-    return false;
+    Camera camera;
+    if (!ParseCamera(&camera, elem_err, o,
+                     store_original_json_for_extras_and_extensions_)) {
+      return false;
+    }
+
+    *out = std::move(camera);
+    return true;
+  };
+
+  // A filtered load needs the whole DOM to find what is referenced.
+  const bool filtered_load = (skip_sections_ != SKIP_NONE) ||
+                             (scene_filter_ >= 0);
+  const unsigned int skip = skip_sections_;
+  detail::JsonKeyFilter drop_key;
+  if (skip != SKIP_NONE) {
+    drop_key = [skip](int depth, const std::string &key) {
+      if ((depth == 1) &&
+          (((skip & SKIP_IMAGES) && (key == "images")) ||
+           ((skip & SKIP_ANIMATIONS) && (key == "animations")) ||
+           ((skip & SKIP_SKINS) && (key == "skins")))) {
+        return true;
+      }
+      return (skip & SKIP_EXTRAS_AND_EXTENSIONS) &&
+             ((key == "extras") || (key == "extensions"));
+    };
   }
 
   detail::JsonDocument v;
+  bool streamed = false;
 
+#ifndef TINYGLTF_USE_RAPIDJSON
+  if (streaming_json_parse_ && !filtered_load) {
+    auto IsStreamedSection = [](const std::string &section) -> bool {
+      // Images are resolved against bufferViews once all of them are known,
+      // and Draco compressed meshes need the buffers, so both stay in the
+      // DOM.
+      return (section == "buffers") || (section == "bufferViews") ||
+             (section == "accessors") ||
+#ifndef TINYGLTF_ENABLE_DRACO
+             (section == "meshes") ||
+#endif
+             (section == "nodes") || (section == "scenes") ||
+             (section == "materials") || (section == "textures") ||
+             (section == "animations") || (section == "skins") ||
+             (section == "samplers") || (section == "cameras");
+    };
+    auto ParseStreamedElement = [&](const std::string &section,
+                                    const detail::json &o) -> bool {
+      if (section == "buffers") {
+        return AppendArrayElement(&model->buffers, err, o, ParseBufferElement);
+      }
+      if (section == "bufferViews") {
+        return AppendArrayElement(&model->bufferViews, err, o,
+                                  ParseBufferViewElement);
+      }
+      if (section == "accessors") {
+        return AppendArrayElement(&model->accessors, err, o,
+                                  ParseAccessorElement);
+      }
+      if (section == "meshes") {
+        return AppendArrayElement(&model->meshes, err, o, ParseMeshElement);
+      }
+      if (section == "nodes") {
+        return AppendArrayElement(&model->nodes, err, o, ParseNodeElement);
+      }
+      if (section == "scenes") {
+        return AppendArrayElement(&model->scenes, err, o, ParseSceneElement);
+      }
+      if (section == "materials") {
+        return AppendArrayElement(&model->materials, err, o,
+                                  ParseMaterialElement);
+      }
+      if (section == "textures") {
+        return AppendArrayElement(&model->textures, err, o,
+                                  ParseTextureElement);
+      }
+      if (section == "animations") {
+        return AppendArrayElement(&model->animations, err, o,
+                                  ParseAnimationElement);
+      }
+      if (section == "skins") {
+        return AppendArrayElement(&model->skins, err, o, ParseSkinElement);
+      }
+      if (section == "samplers") {
+        return AppendArrayElement(&model->samplers, err, o,
+                                  ParseSamplerElement);
+      }
+      return AppendArrayElement(&model->cameras, err, o, ParseCameraElement);
+    };
+
+    ResetModel();
+    detail::StreamingJsonParser parser(v, IsStreamedSection,
+                                       ParseStreamedElement);
+    if (!detail::json::sax_parse(json_str, json_str + json_str_length,
+                                 &parser)) {
+      if (err && parser.HasParseError()) {
+        (*err) = parser.GetParseError();
+      }
+      return false;
+    }
+    streamed = true;
+  } else
+#endif
+  {
 #if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
      defined(_CPPUNWIND)) &&                               \
     !defined(TINYGLTF_NOEXCEPTION)
-  try {
-    detail::JsonParse(v, json_str, json_str_length, true);
+    try {
+      detail::JsonParse(v, json_str, json_str_length, true, drop_key);
 
-  } catch (const std::exception &e) {
-    if (err) {
-      (*err) = e.what();
+    } catch (const std::exception &e) {
+      if (err) {
+        (*err) = e.what();
+      }
+      return false;
     }
-    return false;
-  }
 #else
-  {
-    detail::JsonParse(v, json_str, json_str_length);
+    detail::JsonParse(v, json_str, json_str_length, false, drop_key);
 
     if (!detail::IsObject(v)) {
       // Assume parsing was failed.
@@ -5645,8 +10320,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
       }
       return false;
     }
-  }
 #endif
+  }
 
   if (!detail::IsObject(v)) {
     // root is not an object.
@@ -5735,16 +10410,34 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     }
   }
 
-  model->buffers.clear();
-  model->bufferViews.clear();
-  model->accessors.clear();
-  model->meshes.clear();
-  model->cameras.clear();
-  model->nodes.clear();
-  model->extensionsUsed.clear();
-  model->extensionsRequired.clear();
-  model->extensions.clear();
-  model->defaultScene = -1;
+  if (!streamed) {
+    ResetModel();
+  }
+
+  SectionMasks masks;
+  if (filtered_load) {
+    if (scene_filter_ >= 0 &&
+        size_t(scene_filter_) >= ArraySize(FindArrayMember(v, "scenes"))) {
+      if (err) {
+        (*err) += "scene " + std::to_string(scene_filter_) +
+                  " selected by the scene filter not found in .gltf\n";
+      }
+      return false;
+    }
+    ComputeSectionMasks(v, scene_filter_, skip, &masks);
+  }
+  auto Keep = [&](const std::vector<char> &mask) {
+    return filtered_load ? &mask : nullptr;
+  };
+
+  ThreadPool *section_pool =
+      parallel_section_parsing_ ? GetThreadPool() : nullptr;
+#ifdef TINYGLTF_ENABLE_DRACO
+  // Draco decoding appends buffers, bufferViews and accessors to the model.
+  ThreadPool *mesh_pool = nullptr;
+#else
+  ThreadPool *mesh_pool = section_pool;
+#endif
 
   // 1. Parse Asset
   {
@@ -5801,23 +10494,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 3. Parse Buffer
   {
-    bool success = ForEachInArray(v, "buffers", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`buffers' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Buffer buffer;
-      if (!ParseBuffer(&buffer, err, o,
-                       store_original_json_for_extras_and_extensions_, &fs,
-                       &uri_cb, base_dir, is_binary_, bin_data_, bin_size_)) {
-        return false;
-      }
-
-      model->buffers.emplace_back(std::move(buffer));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->buffers, err, v, "buffers", nullptr,
+                          ParseBufferElement, Keep(masks.buffers));
 
     if (!success) {
       return false;
@@ -5825,22 +10504,10 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
   // 4. Parse BufferView
   {
-    bool success = ForEachInArray(v, "bufferViews", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`bufferViews' does not contain an JSON object.";
-        }
-        return false;
-      }
-      BufferView bufferView;
-      if (!ParseBufferView(&bufferView, err, o,
-                           store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->bufferViews.emplace_back(std::move(bufferView));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->bufferViews, err, v, "bufferViews",
+                          section_pool, ParseBufferViewElement,
+                          Keep(masks.bufferViews));
 
     if (!success) {
       return false;
@@ -5849,22 +10516,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 5. Parse Accessor
   {
-    bool success = ForEachInArray(v, "accessors", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`accessors' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Accessor accessor;
-      if (!ParseAccessor(&accessor, err, o,
-                         store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->accessors.emplace_back(std::move(accessor));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->accessors, err, v, "accessors", section_pool,
+                          ParseAccessorElement, Keep(masks.accessors));
 
     if (!success) {
       return false;
@@ -5873,22 +10527,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 6. Parse Mesh
   {
-    bool success = ForEachInArray(v, "meshes", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`meshes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Mesh mesh;
-      if (!ParseMesh(&mesh, model, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->meshes.emplace_back(std::move(mesh));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->meshes, err, v, "meshes", mesh_pool,
+                          ParseMeshElement, Keep(masks.meshes));
 
     if (!success) {
       return false;
@@ -5956,22 +10597,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 7. Parse Node
   {
-    bool success = ForEachInArray(v, "nodes", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`nodes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Node node;
-      if (!ParseNode(&node, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->nodes.emplace_back(std::move(node));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->nodes, err, v, "nodes", section_pool,
+                          ParseNodeElement, Keep(masks.nodes));
 
     if (!success) {
       return false;
@@ -5980,42 +10608,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 8. Parse scenes.
   {
-    bool success = ForEachInArray(v, "scenes", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`scenes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      std::vector<int> nodes;
-      ParseIntegerArrayProperty(&nodes, err, o, "nodes", false);
-
-      Scene scene;
-      scene.nodes = std::move(nodes);
-
-      ParseStringProperty(&scene.name, err, o, "name", false);
-
-      ParseExtensionsProperty(&scene.extensions, err, o);
-      ParseExtrasProperty(&scene.extras, o);
-
-      if (store_original_json_for_extras_and_extensions_) {
-        {
-          detail::json_const_iterator it;
-          if (detail::FindMember(o, "extensions", it)) {
-            scene.extensions_json_string = detail::JsonToString(detail::GetValue(it));
-          }
-        }
-        {
-          detail::json_const_iterator it;
-          if (detail::FindMember(o, "extras", it)) {
-            scene.extras_json_string = detail::JsonToString(detail::GetValue(it));
-          }
-        }
-      }
-
-      model->scenes.emplace_back(std::move(scene));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->scenes, err, v, "scenes", section_pool,
+                          ParseSceneElement, Keep(masks.scenes));
 
     if (!success) {
       return false;
@@ -6029,28 +10624,16 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     if (detail::FindMember(v, "scene", rootIt) && detail::GetInt(detail::GetValue(rootIt), iVal)) {
       model->defaultScene = iVal;
     }
+    if (scene_filter_ >= 0) {
+      model->defaultScene = scene_filter_;
+    }
   }
 
   // 10. Parse Material
   {
-    bool success = ForEachInArray(v, "materials", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`materials' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Material material;
-      ParseStringProperty(&material.name, err, o, "name", false);
-
-      if (!ParseMaterial(&material, err, o,
-                         store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->materials.emplace_back(std::move(material));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->materials, err, v, "materials", section_pool,
+                          ParseMaterialElement, Keep(masks.materials));
 
     if (!success) {
       return false;
@@ -6070,31 +10653,66 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     load_image_user_data = reinterpret_cast<void *>(&load_image_option);
   }
 
-  {
+  // With parallel decoding the images are parsed (and their encoded bytes
+  // fetched) first. Messages are collected per image so they can be reported
+  // in the same order as with the sequential decode.
+  ThreadPool *image_pool =
+      (parallel_image_decoding_ &&
+       (!user_image_loader_ || user_image_loader_thread_safe_))
+          ? GetThreadPool()
+          : nullptr;
+  const bool defer_image_decoding = lazy_image_decoding_ || image_pool;
+  std::vector<SharedBytes> encoded_images;
+  std::vector<std::string> image_errs;
+  std::vector<std::string> image_warns;
+
+  if (!(skip & SKIP_IMAGES)) {
     int idx = 0;
     bool success = ForEachInArray(v, "images", [&](const detail::json &o) {
+      std::string *image_err = err;
+      std::string *image_warn = warn;
+      SharedBytes *encoded = nullptr;
+      if (defer_image_decoding) {
+        encoded_images.emplace_back();
+        image_errs.emplace_back();
+        image_warns.emplace_back();
+        image_err = &image_errs.back();
+        image_warn = &image_warns.back();
+        encoded = &encoded_images.back();
+      }
+
+      if (filtered_load && (size_t(idx) < masks.images.size()) &&
+          !masks.images[size_t(idx)]) {
+        model->images.emplace_back();
+        ++idx;
+        return true;
+      }
+
       if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "image[" + std::to_string(idx) + "] is not a JSON object.";
+        if (image_err) {
+          (*image_err) +=
+              "image[" + std::to_string(idx) + "] is not a JSON object.";
         }
         return false;
       }
+
       Image image;
-      if (!ParseImage(&image, idx, err, warn, o,
-                      store_original_json_for_extras_and_extensions_, base_dir,
-                      &fs, &uri_cb, &this->LoadImageData,
-                      load_image_user_data)) {
+      if (!ParseImage(&image, idx, image_err, image_warn, o,
+                      store_original_json_for_extras_and_extensions_,
+                      store_data_uris_, base_dir, load_fs, &uri_cb,
+                      &this->LoadImageData, load_image_user_data, encoded,
+                      ctx.metadata_only)) {
         return false;
       }
 
-      if (image.bufferView != -1) {
+      if (image.bufferView != -1 && !ctx.metadata_only) {
         // Load image from the buffer view.
         if (size_t(image.bufferView) >= model->bufferViews.size()) {
-          if (err) {
+          if (image_err) {
             std::stringstream ss;
             ss << "image[" << idx << "] bufferView \"" << image.bufferView
                << "\" not found in the scene." << std::endl;
-            (*err) += ss.str();
+            (*image_err) += ss.str();
           }
           return false;
         }
@@ -6102,28 +10720,44 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
         const BufferView &bufferView =
             model->bufferViews[size_t(image.bufferView)];
         if (size_t(bufferView.buffer) >= model->buffers.size()) {
-          if (err) {
+          if (image_err) {
             std::stringstream ss;
             ss << "image[" << idx << "] buffer \"" << bufferView.buffer
                << "\" not found in the scene." << std::endl;
-            (*err) += ss.str();
+            (*image_err) += ss.str();
           }
           return false;
         }
         const Buffer &buffer = model->buffers[size_t(bufferView.buffer)];
-
-        if (*LoadImageData == nullptr) {
-          if (err) {
-            (*err) += "No LoadImageData callback specified.\n";
+        if (bufferView.byteOffset + bufferView.byteLength >
+            buffer.data.size()) {
+          if (image_err) {
+            std::stringstream ss;
+            ss << "image[" << idx << "] bufferView \"" << image.bufferView
+               << "\" exceeds the size of buffer \"" << bufferView.buffer
+               << "\"." << std::endl;
+            (*image_err) += ss.str();
           }
           return false;
         }
-        bool ret = LoadImageData(
-            &image, idx, err, warn, image.width, image.height,
-            &buffer.data[bufferView.byteOffset],
-            static_cast<int>(bufferView.byteLength), load_image_user_data);
-        if (!ret) {
-          return false;
+
+        if (encoded) {
+          (*encoded) =
+              buffer.data.Slice(bufferView.byteOffset, bufferView.byteLength);
+        } else {
+          if (*LoadImageData == nullptr) {
+            if (err) {
+              (*err) += "No LoadImageData callback specified.\n";
+            }
+            return false;
+          }
+          bool ret = LoadImageData(
+              &image, idx, err, warn, image.width, image.height,
+              &buffer.data[bufferView.byteOffset],
+              static_cast<int>(bufferView.byteLength), load_image_user_data);
+          if (!ret) {
+            return false;
+          }
         }
       }
 
@@ -6132,6 +10766,57 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
       return true;
     });
 
+    if (defer_image_decoding) {
+      // Decode (or, when lazy, just inspect) the successfully parsed images.
+      const size_t num_parsed = model->images.size();
+      std::vector<char> decoded(num_parsed, 1);
+      if (lazy_image_decoding_) {
+        for (size_t i = 0; i < num_parsed; i++) {
+          if (!encoded_images[i].empty()) {
+            model->images[i].image = std::move(encoded_images[i]);
+            model->images[i].as_is = true;
+            ReadImageInfo(&model->images[i], preserve_image_channels_);
+          }
+        }
+      } else if (*LoadImageData == nullptr) {
+        for (size_t i = 0; i < num_parsed; i++) {
+          if (!encoded_images[i].empty()) {
+            decoded[i] = 0;
+            image_errs[i] += "No LoadImageData callback specified.\n";
+            break;
+          }
+        }
+      } else {
+        image_pool->ParallelFor(num_parsed, [&](size_t i) {
+          const SharedBytes &bytes = encoded_images[i];
+          if (bytes.empty()) {
+            return;  // Nothing to decode, e.g. a missing external file.
+          }
+          Image &image = model->images[i];
+          const bool from_view = image.bufferView != -1;
+          bool ret = LoadImageData(
+              &image, int(i), &image_errs[i], &image_warns[i],
+              from_view ? image.width : 0, from_view ? image.height : 0,
+              bytes.data(), static_cast<int>(bytes.size()),
+              load_image_user_data);
+          decoded[i] = ret ? 1 : 0;
+        });
+      }
+
+      // Report messages in image order, up to the first failure.
+      for (size_t i = 0; i < image_errs.size(); i++) {
+        if (err) {
+          (*err) += image_errs[i];
+        }
+        if (warn) {
+          (*warn) += image_warns[i];
+        }
+        if ((i < num_parsed) && !decoded[i]) {
+          return false;
+        }
+      }
+    }
+
     if (!success) {
       return false;
     }
@@ -6139,47 +10824,21 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 12. Parse Texture
   {
-    bool success = ForEachInArray(v, "textures", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`textures' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Texture texture;
-      if (!ParseTexture(&texture, err, o,
-                        store_original_json_for_extras_and_extensions_,
-                        base_dir)) {
-        return false;
-      }
-
-      model->textures.emplace_back(std::move(texture));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->textures, err, v, "textures", section_pool,
+                          ParseTextureElement, Keep(masks.textures));
 
     if (!success) {
       return false;
     }
-  }
-
-  // 13. Parse Animation
-  {
-    bool success = ForEachInArray(v, "animations", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`animations' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Animation animation;
-      if (!ParseAnimation(&animation, err, o,
-                          store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
+  }
 
-      model->animations.emplace_back(std::move(animation));
-      return true;
-    });
+  // 13. Parse Animation
+  if (!(skip & SKIP_ANIMATIONS)) {
+    bool success =
+        ParseArraySection(&model->animations, err, v, "animations",
+                          section_pool, ParseAnimationElement,
+                          Keep(masks.animations));
 
     if (!success) {
       return false;
@@ -6187,23 +10846,10 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   // 14. Parse Skin
-  {
-    bool success = ForEachInArray(v, "skins", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`skins' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Skin skin;
-      if (!ParseSkin(&skin, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->skins.emplace_back(std::move(skin));
-      return true;
-    });
+  if (!(skip & SKIP_SKINS)) {
+    bool success =
+        ParseArraySection(&model->skins, err, v, "skins", section_pool,
+                          ParseSkinElement, Keep(masks.skins));
 
     if (!success) {
       return false;
@@ -6212,22 +10858,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 15. Parse Sampler
   {
-    bool success = ForEachInArray(v, "samplers", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`samplers' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Sampler sampler;
-      if (!ParseSampler(&sampler, err, o,
-                        store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->samplers.emplace_back(std::move(sampler));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->samplers, err, v, "samplers", section_pool,
+                          ParseSamplerElement, Keep(masks.samplers));
 
     if (!success) {
       return false;
@@ -6236,22 +10869,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 16. Parse Camera
   {
-    bool success = ForEachInArray(v, "cameras", [&](const detail::json &o) {
-      if (!detail::IsObject(o)) {
-        if (err) {
-          (*err) += "`cameras' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Camera camera;
-      if (!ParseCamera(&camera, err, o,
-                       store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->cameras.emplace_back(std::move(camera));
-      return true;
-    });
+    bool success =
+        ParseArraySection(&model->cameras, err, v, "cameras", section_pool,
+                          ParseCameraElement, Keep(masks.cameras));
 
     if (!success) {
       return false;
@@ -6281,15 +10901,14 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
               continue;
             }
 
-            auto arrayIt(detail::ArrayBegin(lights));
-            auto arrayItEnd(detail::ArrayEnd(lights));
-            for (; arrayIt != arrayItEnd; ++arrayIt) {
-              Light light;
-              if (!ParseLight(&light, err, *arrayIt,
-                              store_original_json_for_extras_and_extensions_)) {
-                return false;
-              }
-              model->lights.emplace_back(std::move(light));
+            auto ParseLightElement = [&](Light *out, std::string *elem_err,
+                                         const detail::json &o) -> bool {
+              return ParseLight(out, elem_err, o,
+                                store_original_json_for_extras_and_extensions_);
+            };
+            if (!ParseArrayElements(&model->lights, err, lights, section_pool,
+                                    ParseLightElement)) {
+              return false;
             }
           }
         }
@@ -6305,6 +10924,13 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     model->extensions_json_string = detail::JsonToString(v["extensions"]);
   }
 
+  // 20. Validate, leaving out what a filtered load did not load.
+  if (validate_on_load_ && !ctx.metadata_only &&
+      !ValidateModel(model, err, GetThreadPool(), Keep(masks.accessors),
+                     Keep(masks.bufferViews))) {
+    return false;
+  }
+
   return true;
 }
 
@@ -6313,12 +10939,8 @@ bool TinyGLTF::LoadASCIIFromString(Model *model, std::string *err,
                                    unsigned int length,
                                    const std::string &base_dir,
                                    unsigned int check_sections) {
-  is_binary_ = false;
-  bin_data_ = nullptr;
-  bin_size_ = 0;
-
   return LoadFromString(model, err, warn, str, length, base_dir,
-                        check_sections);
+                        check_sections, LoadContext());
 }
 
 bool TinyGLTF::LoadASCIIFromFile(Model *model, std::string *err,
@@ -6370,6 +10992,17 @@ bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
                                     unsigned int size,
                                     const std::string &base_dir,
                                     unsigned int check_sections) {
+  return LoadBinaryFromMemory(model, err, warn, bytes, size, base_dir,
+                              check_sections, LoadContext());
+}
+
+bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
+                                    std::string *warn,
+                                    const unsigned char *bytes,
+                                    unsigned int size,
+                                    const std::string &base_dir,
+                                    unsigned int check_sections,
+                                    LoadContext ctx) {
   if (size < 20) {
     if (err) {
       (*err) = "Too short data size for glTF Binary.";
@@ -6440,10 +11073,12 @@ bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
   // Chunk1(BIN) data
   // The spec says: When the binary buffer is empty or when it is stored by other means, this chunk SHOULD be omitted.
   // So when header + JSON data == binary size, Chunk1 is omitted.
+  ctx.is_binary = true;
+
   if (header_and_json_size == uint64_t(length)) {
 
-    bin_data_ = nullptr;
-    bin_size_ = 0;
+    ctx.bin_data = nullptr;
+    ctx.bin_size = 0;
   } else {
     // Read Chunk1 info(BIN data)
     // At least Chunk1 should have 12 bytes(8 bytes(header) + 4 bytes(bin payload could be 1~3 bytes, but need to be aligned to 4 bytes)
@@ -6493,21 +11128,15 @@ bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
 
     //std::cout << "chunk1_length = " << chunk1_length << "\n";
 
-    bin_data_ = bytes + header_and_json_size +
+    ctx.bin_data = bytes + header_and_json_size +
                 8;  // 4 bytes (bin_buffer_length) + 4 bytes(bin_buffer_format)
 
-    bin_size_ = size_t(chunk1_length);
+    ctx.bin_size = size_t(chunk1_length);
   }
 
-  // Extract JSON string.
-  std::string jsonString(reinterpret_cast<const char *>(&bytes[20]),
-                         chunk0_length);
-
-  is_binary_ = true;
-
   bool ret = LoadFromString(model, err, warn,
                             reinterpret_cast<const char *>(&bytes[20]),
-                            chunk0_length, base_dir, check_sections);
+                            chunk0_length, base_dir, check_sections, ctx);
   if (!ret) {
     return ret;
   }
@@ -6531,6 +11160,37 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
     return false;
   }
 
+#ifndef TINYGLTF_NO_FS
+  if (memory_map_binary_files_ && fs.ReadWholeFile == &tinygltf::ReadWholeFile) {
+    const unsigned char *mapped = nullptr;
+    size_t mapped_size = 0;
+    std::string maperr;
+    std::shared_ptr<const void> mapping =
+        MapWholeFile(&mapped, &mapped_size, &maperr, filename);
+    if (!mapping) {
+      ss << "Failed to map file: " << filename << ": " << maperr << std::endl;
+      if (err) {
+        (*err) = ss.str();
+      }
+      return false;
+    }
+
+    if (mapped_size > std::numeric_limits<unsigned int>::max()) {
+      if (err) {
+        (*err) = "Invalid glTF binary. GLB data exceeds 4GB.";
+      }
+      return false;
+    }
+
+    // Buffers borrowing from the BIN chunk share ownership of the mapping.
+    LoadContext ctx;
+    ctx.bin_owner = mapping;
+    return LoadBinaryFromMemory(model, err, warn, mapped,
+                                static_cast<unsigned int>(mapped_size),
+                                GetBaseDir(filename), check_sections, ctx);
+  }
+#endif
+
   std::vector<unsigned char> data;
   std::string fileerr;
   bool fileread = fs.ReadWholeFile(&data, &fileerr, filename, fs.user_data);
@@ -6542,12 +11202,483 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
     return false;
   }
 
-  std::string basedir = GetBaseDir(filename);
+  std::string basedir = GetBaseDir(filename);
+
+  bool ret = LoadBinaryFromMemory(model, err, warn, &data.at(0),
+                                  static_cast<unsigned int>(data.size()),
+                                  basedir, check_sections);
+
+  return ret;
+}
+
+// Checks a GLB header (the 12 byte file header and the JSON chunk header)
+// against the size of the whole file and returns the JSON chunk length.
+static bool ParseGlbHeader(const unsigned char *bytes, uint64_t file_size,
+                           unsigned int *json_length, std::string *err) {
+  if (file_size < 20) {
+    if (err) {
+      (*err) = "Too short data size for glTF Binary.";
+    }
+    return false;
+  }
+  if (bytes[0] != 'g' || bytes[1] != 'l' || bytes[2] != 'T' ||
+      bytes[3] != 'F') {
+    if (err) {
+      (*err) = "Invalid magic.";
+    }
+    return false;
+  }
+
+  unsigned int length;
+  unsigned int chunk0_length;
+  unsigned int chunk0_format;
+  memcpy(&length, bytes + 8, 4);
+  swap4(&length);
+  memcpy(&chunk0_length, bytes + 12, 4);
+  swap4(&chunk0_length);
+  memcpy(&chunk0_format, bytes + 16, 4);
+  swap4(&chunk0_format);
+
+  const uint64_t header_and_json_size = 20ull + uint64_t(chunk0_length);
+  if ((chunk0_length < 1) || (chunk0_format != 0x4E4F534A) ||
+      (header_and_json_size > uint64_t(length)) ||
+      (uint64_t(length) > file_size)) {
+    if (err) {
+      (*err) = "Invalid glTF binary.";
+    }
+    return false;
+  }
+  (*json_length) = chunk0_length;
+  return true;
+}
+
+#if !defined(TINYGLTF_NO_FS) && !defined(TINYGLTF_ANDROID_LOAD_FROM_ASSETS)
+// Reads the JSON chunk of the GLB file `filepath` with positioned reads: the
+// header together with the first few KB, and the rest of the JSON chunk only
+// if it is larger. The BIN chunk is never read.
+static bool ReadGlbJsonChunk(std::vector<unsigned char> *json,
+                             std::string *err, const std::string &filepath) {
+  const size_t kFirstRead = 16384;
+  std::vector<unsigned char> head;
+  uint64_t file_size = 0;
+  unsigned int json_length = 0;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileW(UTF8ToWchar(filepath).c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    if (err) {
+      (*err) += "File read error : " + filepath + "\n";
+    }
+    return false;
+  }
+  file_size = uint64_t(size.QuadPart);
+  auto ReadAt = [file](unsigned char *dst, size_t len, uint64_t offset) {
+    while (len > 0) {
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = DWORD(offset & 0xffffffffu);
+      overlapped.OffsetHigh = DWORD(offset >> 32);
+      const DWORD chunk = DWORD(std::min<size_t>(len, 1u << 30));
+      DWORD read = 0;
+      if (!ReadFile(file, dst, chunk, &read, &overlapped) || read == 0) {
+        return false;
+      }
+      dst += read;
+      len -= read;
+      offset += read;
+    }
+    return true;
+  };
+  auto Close = [file]() { CloseHandle(file); };
+#else
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return false;
+  }
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+    close(fd);
+    if (err) {
+      (*err) += "Invalid file : " + filepath +
+                " (does the path point to a directory?)";
+    }
+    return false;
+  }
+  file_size = uint64_t(st.st_size);
+  auto ReadAt = [fd](unsigned char *dst, size_t len, uint64_t offset) {
+    while (len > 0) {
+      const ssize_t n = pread(fd, dst, len, off_t(offset));
+      if (n <= 0) {
+        if (n < 0 && errno == EINTR) continue;
+        return false;
+      }
+      dst += n;
+      len -= size_t(n);
+      offset += uint64_t(n);
+    }
+    return true;
+  };
+  auto Close = [fd]() { close(fd); };
+#endif
+
+  head.resize(size_t(std::min<uint64_t>(file_size, kFirstRead)));
+  if (!ReadAt(head.data(), head.size(), 0)) {
+    Close();
+    if (err) {
+      (*err) += "File read error : " + filepath + "\n";
+    }
+    return false;
+  }
+  if (!ParseGlbHeader(head.data(), file_size, &json_length, err)) {
+    Close();
+    return false;
+  }
+
+  json->resize(json_length);
+  const size_t from_head = std::min<size_t>(json_length, head.size() - 20);
+  memcpy(json->data(), head.data() + 20, from_head);
+  const bool ok = ReadAt(json->data() + from_head, json_length - from_head,
+                         20 + uint64_t(from_head));
+  Close();
+  if (!ok) {
+    if (err) {
+      (*err) += "File read error : " + filepath + "\n";
+    }
+    return false;
+  }
+  return true;
+}
+#endif
+
+bool TinyGLTF::ProbeBinaryFromFile(Model *model, std::string *err,
+                                   std::string *warn,
+                                   const std::string &filename,
+                                   unsigned int check_sections) {
+  std::stringstream ss;
+
+  if (fs.ReadWholeFile == nullptr) {
+    // Programmer error, assert() ?
+    ss << "Failed to read file: " << filename
+       << ": one or more FS callback not set" << std::endl;
+    if (err) {
+      (*err) = ss.str();
+    }
+    return false;
+  }
+
+  std::vector<unsigned char> json;
+  std::string fileerr;
+#if !defined(TINYGLTF_NO_FS) && !defined(TINYGLTF_ANDROID_LOAD_FROM_ASSETS)
+  if (fs.ReadWholeFile == &tinygltf::ReadWholeFile) {
+    if (!ReadGlbJsonChunk(&json, &fileerr, filename)) {
+      ss << "Failed to probe file: " << filename << ": " << fileerr
+         << std::endl;
+      if (err) {
+        (*err) = ss.str();
+      }
+      return false;
+    }
+  } else
+#endif
+  {
+    // User FS callbacks can only read whole files.
+    std::vector<unsigned char> data;
+    unsigned int json_length = 0;
+    if (!fs.ReadWholeFile(&data, &fileerr, filename, fs.user_data) ||
+        !ParseGlbHeader(data.data(), data.size(), &json_length, &fileerr)) {
+      ss << "Failed to probe file: " << filename << ": " << fileerr
+         << std::endl;
+      if (err) {
+        (*err) = ss.str();
+      }
+      return false;
+    }
+    json.assign(data.begin() + 20, data.begin() + 20 + json_length);
+  }
+
+  LoadContext ctx;
+  ctx.is_binary = true;
+  ctx.metadata_only = true;
+  return LoadFromString(model, err, warn,
+                        reinterpret_cast<const char *>(json.data()),
+                        static_cast<unsigned int>(json.size()),
+                        GetBaseDir(filename), check_sections, ctx);
+}
+
+// FsCallbacks wrapper which counts the reads of one LoadMany() file.
+struct CountingFsData {
+  FsCallbacks *fs;
+  LoadResult *result;
+};
+
+static bool CountingFileExists(const std::string &abs_filename,
+                               void *user_data) {
+  FsCallbacks *fs = static_cast<CountingFsData *>(user_data)->fs;
+  return fs->FileExists(abs_filename, fs->user_data);
+}
+
+static std::string CountingExpandFilePath(const std::string &filepath,
+                                          void *user_data) {
+  FsCallbacks *fs = static_cast<CountingFsData *>(user_data)->fs;
+  return fs->ExpandFilePath(filepath, fs->user_data);
+}
+
+static bool CountingReadWholeFile(std::vector<unsigned char> *out,
+                                  std::string *err, const std::string &filepath,
+                                  void *user_data) {
+  CountingFsData *data = static_cast<CountingFsData *>(user_data);
+  const auto start = std::chrono::steady_clock::now();
+  bool ret = data->fs->ReadWholeFile(out, err, filepath, data->fs->user_data);
+  data->result->read_seconds += std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+  if (ret) {
+    data->result->files_read++;
+    data->result->bytes_read += out->size();
+  }
+  return ret;
+}
+
+static bool CountingWriteWholeFile(std::string *err,
+                                   const std::string &filepath,
+                                   const std::vector<unsigned char> &contents,
+                                   void *user_data) {
+  FsCallbacks *fs = static_cast<CountingFsData *>(user_data)->fs;
+  return fs->WriteWholeFile(err, filepath, contents, fs->user_data);
+}
+
+void TinyGLTF::LoadOne(LoadResult *result, unsigned int check_sections,
+                       FsCallbacks *file_fs) {
+  const std::string &filename = result->filename;
+  std::string *err = &result->err;
+  std::string *warn = &result->warn;
+  std::string basedir = GetBaseDir(filename);
+
+  LoadContext ctx;
+  ctx.fs = file_fs;
+
+#ifndef TINYGLTF_NO_FS
+  if (memory_map_binary_files_ && fs.ReadWholeFile == &tinygltf::ReadWholeFile) {
+    const auto start = std::chrono::steady_clock::now();
+    const unsigned char *mapped = nullptr;
+    size_t mapped_size = 0;
+    std::string maperr;
+    std::shared_ptr<const void> mapping =
+        MapWholeFile(&mapped, &mapped_size, &maperr, filename);
+    result->read_seconds += std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+    if (!mapping) {
+      (*err) = "Failed to map file: " + filename + ": " + maperr + "\n";
+      return;
+    }
+    result->files_read++;
+    result->bytes_read += mapped_size;
+
+    if (mapped_size > std::numeric_limits<unsigned int>::max()) {
+      (*err) = "Invalid glTF binary. GLB data exceeds 4GB.";
+      return;
+    }
+
+    if ((mapped_size >= 4) && (memcmp(mapped, "glTF", 4) == 0)) {
+      ctx.bin_owner = mapping;
+      result->success = LoadBinaryFromMemory(
+          &result->model, err, warn, mapped,
+          static_cast<unsigned int>(mapped_size), basedir, check_sections, ctx);
+    } else if (mapped_size == 0) {
+      (*err) = "Empty file.";
+    } else {
+      result->success = LoadFromString(
+          &result->model, err, warn, reinterpret_cast<const char *>(mapped),
+          static_cast<unsigned int>(mapped_size), basedir, check_sections,
+          ctx);
+    }
+    return;
+  }
+#endif
+
+  if (file_fs->ReadWholeFile == nullptr) {
+    (*err) = "Failed to read file: " + filename +
+             ": one or more FS callback not set\n";
+    return;
+  }
+
+  std::vector<unsigned char> data;
+  std::string fileerr;
+  if (!file_fs->ReadWholeFile(&data, &fileerr, filename,
+                              file_fs->user_data)) {
+    (*err) = "Failed to read file: " + filename + ": " + fileerr + "\n";
+    return;
+  }
+
+  if (data.empty()) {
+    (*err) = "Empty file.";
+    return;
+  }
+
+  if (data.size() > std::numeric_limits<unsigned int>::max()) {
+    (*err) = "File size exceeds 4GB.";
+    return;
+  }
+
+  if ((data.size() >= 4) && (memcmp(data.data(), "glTF", 4) == 0)) {
+    result->success = LoadBinaryFromMemory(
+        &result->model, err, warn, data.data(),
+        static_cast<unsigned int>(data.size()), basedir, check_sections, ctx);
+  } else {
+    result->success = LoadFromString(
+        &result->model, err, warn, reinterpret_cast<const char *>(data.data()),
+        static_cast<unsigned int>(data.size()), basedir, check_sections, ctx);
+  }
+}
+
+std::vector<std::future<LoadResult>> TinyGLTF::LoadMany(
+    const std::vector<std::string> &filenames, unsigned int check_sections,
+    ThreadPool *pool) {
+  if (!pool) {
+    pool = GetThreadPool();
+  }
+  if (pool && (pool->Size() == 0)) {
+    pool = nullptr;
+  }
+
+  const auto queued = std::chrono::steady_clock::now();
+  std::vector<std::future<LoadResult>> futures;
+  futures.reserve(filenames.size());
+
+  for (size_t i = 0; i < filenames.size(); i++) {
+    std::shared_ptr<std::promise<LoadResult>> promise =
+        std::make_shared<std::promise<LoadResult>>();
+    futures.emplace_back(promise->get_future());
+
+    const std::string filename = filenames[i];
+    auto task = [this, promise, filename, check_sections, queued]() {
+      LoadResult result;
+      result.filename = filename;
+
+      const auto start = std::chrono::steady_clock::now();
+      result.wait_seconds =
+          std::chrono::duration<double>(start - queued).count();
+
+      // Route every read of this file through the counters of `result`.
+      CountingFsData counting{&fs, &result};
+      FsCallbacks file_fs = fs;
+      file_fs.user_data = &counting;
+      if (fs.FileExists) file_fs.FileExists = &CountingFileExists;
+      if (fs.ExpandFilePath) file_fs.ExpandFilePath = &CountingExpandFilePath;
+      if (fs.ReadWholeFile) file_fs.ReadWholeFile = &CountingReadWholeFile;
+      if (fs.WriteWholeFile) file_fs.WriteWholeFile = &CountingWriteWholeFile;
+
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+      try {
+        LoadOne(&result, check_sections, &file_fs);
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+        return;
+      }
+#else
+      LoadOne(&result, check_sections, &file_fs);
+#endif
+
+      result.total_seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+      promise->set_value(std::move(result));
+    };
+
+    if (pool) {
+      pool->Enqueue(task);
+    } else {
+      task();
+    }
+  }
+
+  return futures;
+}
+
+bool TinyGLTF::DecodeImage(Model *model, int idx, std::string *err,
+                           std::string *warn) {
+  if ((idx < 0) || (size_t(idx) >= model->images.size())) {
+    if (err) {
+      (*err) += "image[" + std::to_string(idx) + "] not found in the model.\n";
+    }
+    return false;
+  }
+
+  Image &image = model->images[size_t(idx)];
+  if (!image.as_is || image.image.empty()) {
+    return true;
+  }
+
+  if (*LoadImageData == nullptr) {
+    if (err) {
+      (*err) += "No LoadImageData callback specified.\n";
+    }
+    return false;
+  }
+
+  LoadImageDataOption load_image_option;
+  load_image_option.preserve_channels = preserve_image_channels_;
+  void *load_image_user_data = user_image_loader_
+                                   ? load_image_user_data_
+                                   : reinterpret_cast<void *>(&load_image_option);
+
+  // Keep the encoded bytes alive while the loader replaces `image.image`.
+  const SharedBytes encoded = image.image;
+  image.as_is = false;
+  if (!LoadImageData(&image, idx, err, warn, 0, 0, encoded.data(),
+                     static_cast<int>(encoded.size()), load_image_user_data)) {
+    image.image = encoded;
+    image.as_is = true;
+    return false;
+  }
+
+  return true;
+}
 
-  bool ret = LoadBinaryFromMemory(model, err, warn, &data.at(0),
-                                  static_cast<unsigned int>(data.size()),
-                                  basedir, check_sections);
+bool TinyGLTF::DecodeAllImages(Model *model, std::string *err,
+                               std::string *warn, ThreadPool *pool) {
+  const size_t num_images = model->images.size();
+  if (!pool || (user_image_loader_ && !user_image_loader_thread_safe_)) {
+    bool ret = true;
+    for (size_t i = 0; i < num_images; i++) {
+      ret = DecodeImage(model, int(i), err, warn) && ret;
+    }
+    return ret;
+  }
+
+  std::vector<std::string> image_errs(num_images);
+  std::vector<std::string> image_warns(num_images);
+  std::vector<char> decoded(num_images, 1);
+  pool->ParallelFor(num_images, [&](size_t i) {
+    decoded[i] =
+        DecodeImage(model, int(i), &image_errs[i], &image_warns[i]) ? 1 : 0;
+  });
 
+  bool ret = true;
+  for (size_t i = 0; i < num_images; i++) {
+    if (err) {
+      (*err) += image_errs[i];
+    }
+    if (warn) {
+      (*warn) += image_warns[i];
+    }
+    ret = ret && decoded[i];
+  }
   return ret;
 }
 
@@ -6555,232 +11686,498 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
 // GLTF Serialization
 ///////////////////////
 namespace detail {
-detail::json JsonFromString(const char *s) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return detail::json(s, detail::GetAllocator());
-#else
-  return detail::json(s);
-#endif
-}
 
-void JsonAssign(detail::json &dest, const detail::json &src) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  dest.CopyFrom(src, detail::GetAllocator());
-#else
-  dest = src;
+// Writes JSON text into a buffered sink without building a DOM. The text is
+// byte for byte what nlohmann::json::dump() produces: minified for a negative
+// `indent`, pretty printed with `indent` spaces otherwise. Object members are
+// written in the order they are given, so callers emit them sorted by key
+// like the std::map based objects of nlohmann::json.
+class JsonWriter {
+ public:
+  // Appends to `out`.
+  JsonWriter(std::string *out, int indent) : indent_(indent), buffer_(out) {}
+  // Writes to `stream` in pieces of kFlushSize bytes.
+  JsonWriter(std::ostream *stream, int indent)
+      : indent_(indent), stream_(stream), buffer_(&own_buffer_) {
+    own_buffer_.reserve(2 * kFlushSize);
+  }
+#if !defined(_WIN32) && !defined(TINYGLTF_NO_FS)
+  // Writes to the file descriptor `fd` in pieces of kFlushSize bytes.
+  JsonWriter(int fd, int indent)
+      : indent_(indent), fd_(fd), buffer_(&own_buffer_) {
+    own_buffer_.reserve(2 * kFlushSize);
+  }
 #endif
-}
+  // Writes elements of the array which is open in `parent`, to be appended
+  // to it with SpliceElements(). This lets parts of an array be written
+  // concurrently.
+  JsonWriter(std::string *out, const JsonWriter &parent)
+      : indent_(parent.indent_), buffer_(out), stack_(parent.stack_) {
+    // Every element gets a separator. SpliceElements() drops the leading
+    // comma when the elements start the array.
+    stack_.back() |= kNotEmpty;
+  }
+  ~JsonWriter() { Flush(); }
+
+  JsonWriter(const JsonWriter &) = delete;
+  JsonWriter &operator=(const JsonWriter &) = delete;
+
+  void StartObject() { Start('{', kObject); }
+  // Like StartObject(), but an object without members is written as null,
+  // which is how a DOM value that nothing was added to is dumped.
+  void StartNullableObject() {
+    BeginValue();
+    stack_.push_back(kObject | kPending);
+  }
+  void EndObject() { End('}'); }
+  void StartArray() { Start('[', 0); }
+  void EndArray() { End(']'); }
+
+  void Key(const char *key) { Key(key, strlen(key)); }
+  void Key(const std::string &key) { Key(key.data(), key.size()); }
+  void Key(const char *key, size_t len) {
+    if (stack_.back() & kPending) {
+      stack_.back() = kObject;
+      Put('{');
+    }
+    Separator();
+    Put('"');
+    PutEscaped(key, len);
+    if (indent_ < 0) {
+      Put("\":", 2);
+    } else {
+      Put("\": ", 3);
+    }
+  }
 
-void JsonAddMember(detail::json &o, const char *key, detail::json &&value) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  if (!o.IsObject()) {
-    o.SetObject();
+  void Null() {
+    BeginValue();
+    Put("null", 4);
   }
-  o.AddMember(detail::json(key, detail::GetAllocator()), std::move(value), detail::GetAllocator());
-#else
-  o[key] = std::move(value);
-#endif
-}
+  void Bool(bool value) {
+    BeginValue();
+    if (value) {
+      Put("true", 4);
+    } else {
+      Put("false", 5);
+    }
+  }
+  void Number(int value) {
+    BeginValue();
+    long long v = value;
+    if (v < 0) {
+      Put('-');
+      v = -v;
+    }
+    PutUnsigned(static_cast<unsigned long long>(v));
+  }
+  void Number(unsigned int value) {
+    BeginValue();
+    PutUnsigned(value);
+  }
+  void Number(unsigned long value) {
+    BeginValue();
+    PutUnsigned(value);
+  }
+  void Number(unsigned long long value) {
+    BeginValue();
+    PutUnsigned(value);
+  }
+  void Number(double value);
 
-void JsonPushBack(detail::json &o, detail::json &&value) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  o.PushBack(std::move(value), detail::GetAllocator());
-#else
-  o.push_back(std::move(value));
-#endif
-}
+  void String(const char *s) { String(s, strlen(s)); }
+  void String(const std::string &s) { String(s.data(), s.size()); }
+  void String(const char *s, size_t len) {
+    BeginValue();
+    Put('"');
+    PutEscaped(s, len);
+    Put('"');
+  }
 
-bool JsonIsNull(const detail::json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.IsNull();
-#else
-  return o.is_null();
+  // A string written in pieces which need no escaping, e.g. a data URI.
+  void StartRawString() {
+    BeginValue();
+    Put('"');
+  }
+  void RawStringPart(const char *s, size_t len) { Put(s, len); }
+  // A piece of `len` bytes which `fill(char *)` writes in place.
+  template <typename Fn>
+  void RawStringPart(size_t len, const Fn &fill) {
+    const size_t size = buffer_->size();
+    buffer_->resize(size + len);
+    fill(&(*buffer_)[size]);
+    MaybeFlush();
+  }
+  void EndRawString() { Put('"'); }
+
+  // Text outside of the document, e.g. a trailing newline.
+  void Raw(const char *s, size_t len) { Put(s, len); }
+
+  // Appends the text of a writer created from this one.
+  void SpliceElements(const std::string &elements) {
+    if (elements.empty()) return;
+    const size_t skip = (stack_.back() & kNotEmpty) ? 0 : 1;
+    stack_.back() |= kNotEmpty;
+    Put(elements.data() + skip, elements.size() - skip);
+  }
+
+  // Hands the buffered text to the stream or file descriptor. Returns false
+  // if writing to it has failed.
+  bool Flush();
+
+ private:
+  static const size_t kFlushSize = 64 * 1024;
+  static const unsigned char kObject = 1;
+  static const unsigned char kNotEmpty = 2;
+  static const unsigned char kPending = 4;  // '{' not written yet.
+
+  void Start(char c, unsigned char flags) {
+    BeginValue();
+    Put(c);
+    stack_.push_back(flags);
+  }
+  void End(char c) {
+    const unsigned char flags = stack_.back();
+    stack_.pop_back();
+    if (flags & kPending) {
+      Put("null", 4);
+      return;
+    }
+    if ((flags & kNotEmpty) && (indent_ >= 0)) {
+      Put('\n');
+      PutIndent();
+    }
+    Put(c);
+  }
+  // Array elements are separated here, object members in Key().
+  void BeginValue() {
+    if (!stack_.empty() && !(stack_.back() & kObject)) {
+      Separator();
+    }
+  }
+  void Separator() {
+    unsigned char &flags = stack_.back();
+    if (flags & kNotEmpty) {
+      Put(',');
+    }
+    flags |= kNotEmpty;
+    if (indent_ >= 0) {
+      Put('\n');
+      PutIndent();
+    }
+  }
+  void PutIndent() { buffer_->append(stack_.size() * size_t(indent_), ' '); }
+  void Put(char c) {
+    buffer_->push_back(c);
+    MaybeFlush();
+  }
+  void Put(const char *s, size_t len) {
+    buffer_->append(s, len);
+    MaybeFlush();
+  }
+  void MaybeFlush() {
+    if ((buffer_ == &own_buffer_) && (own_buffer_.size() >= kFlushSize)) {
+      Flush();
+    }
+  }
+  void PutUnsigned(unsigned long long value);
+  void PutEscaped(const char *s, size_t len);
+
+  int indent_;
+  std::ostream *stream_ = nullptr;
+  int fd_ = -1;
+  std::string own_buffer_;
+  std::string *buffer_;
+  std::vector<unsigned char> stack_;
+  bool ok_ = true;
+};
+
+bool JsonWriter::Flush() {
+  if ((buffer_ != &own_buffer_) || own_buffer_.empty()) {
+    return ok_;
+  }
+  if (stream_) {
+    stream_->write(own_buffer_.data(), std::streamsize(own_buffer_.size()));
+    ok_ = ok_ && stream_->good();
+  }
+#if !defined(_WIN32) && !defined(TINYGLTF_NO_FS)
+  if (fd_ >= 0) {
+    const char *p = own_buffer_.data();
+    size_t left = own_buffer_.size();
+    while (ok_ && left > 0) {
+      const ssize_t written = write(fd_, p, left);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        ok_ = false;
+        break;
+      }
+      p += written;
+      left -= size_t(written);
+    }
+  }
 #endif
+  own_buffer_.clear();
+  return ok_;
 }
 
-void JsonSetObject(detail::json &o) {
+void JsonWriter::Number(double value) {
+  BeginValue();
+  if (!std::isfinite(value)) {
+    Put("null", 4);
+    return;
+  }
+  char buf[64];
 #ifdef TINYGLTF_USE_RAPIDJSON
-  o.SetObject();
+  const char *end = rapidjson::internal::dtoa(value, buf);
 #else
-  o = o.object({});
+  // The shortest representation which reads back as `value` (Grisu2).
+  const char *end = ::nlohmann::detail::to_chars(buf, buf + sizeof(buf), value);
 #endif
-}
+  Put(buf, size_t(end - buf));
+}
+
+void JsonWriter::PutUnsigned(unsigned long long value) {
+  char buf[24];
+  char *p = buf + sizeof(buf);
+  do {
+    *(--p) = char('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  Put(p, size_t(buf + sizeof(buf) - p));
+}
+
+// Escapes like nlohmann::json. Bytes above 0x7f are copied as is, i.e. `s`
+// is expected to be UTF-8.
+void JsonWriter::PutEscaped(const char *s, size_t len) {
+  static const char kHex[] = "0123456789abcdef";
+  size_t start = 0;  // First byte not written yet.
+  for (size_t i = 0; i < len; i++) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+      continue;
+    }
+    buffer_->append(s + start, i - start);
+    start = i + 1;
+    switch (c) {
+      case '"':
+        Put("\\\"", 2);
+        break;
+      case '\\':
+        Put("\\\\", 2);
+        break;
+      case '\b':
+        Put("\\b", 2);
+        break;
+      case '\t':
+        Put("\\t", 2);
+        break;
+      case '\n':
+        Put("\\n", 2);
+        break;
+      case '\f':
+        Put("\\f", 2);
+        break;
+      case '\r':
+        Put("\\r", 2);
+        break;
+      default: {
+        const char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4],
+                                 kHex[c & 0xf]};
+        Put(escaped, sizeof(escaped));
+        break;
+      }
+    }
+  }
+  Put(s + start, len - start);
+}
+}  // namespace detail
+
+// The serializers below write the members of each object sorted by key, see
+// detail::JsonWriter.
 
-void JsonReserveArray(detail::json &o, size_t s) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  o.SetArray();
-  o.Reserve(static_cast<rapidjson::SizeType>(s), detail::GetAllocator());
-#endif
-  (void)(o);
-  (void)(s);
+template <typename T>
+static void SerializeNumberProperty(const char *key, T number,
+                                    detail::JsonWriter &o) {
+  o.Key(key);
+  o.Number(number);
 }
-}  // namespace
-
-// typedef std::pair<std::string, detail::json> json_object_pair;
 
 template <typename T>
-static void SerializeNumberProperty(const std::string &key, T number,
-                                    detail::json &obj) {
-  // obj.insert(
-  //    json_object_pair(key, detail::json(static_cast<double>(number))));
-  // obj[key] = static_cast<double>(number);
-  detail::JsonAddMember(obj, key.c_str(), detail::json(number));
+static void SerializeNumberArrayProperty(const char *key,
+                                         const std::vector<T> &value,
+                                         detail::JsonWriter &o) {
+  if (value.empty()) return;
+
+  o.Key(key);
+  o.StartArray();
+  for (const auto &s : value) {
+    o.Number(s);
+  }
+  o.EndArray();
 }
 
-#ifdef TINYGLTF_USE_RAPIDJSON
-template <>
-void SerializeNumberProperty(const std::string &key, size_t number, detail::json &obj) {
-  detail::JsonAddMember(obj, key.c_str(), detail::json(static_cast<uint64_t>(number)));
+#ifdef TINYGLTF_COMPACT_NODE
+#ifdef TINYGLTF_COMPACT_NODE_FLOAT
+// Widens `value` to the double with the shortest decimal representation that
+// still reads back as `value`, so a float 0.1f is written as 0.1 rather than
+// 0.10000000149011612.
+static double ToSerializedNumber(float value) {
+  char buf[32];
+  for (int precision = 6; precision < 9; precision++) {
+    snprintf(buf, sizeof(buf), "%.*g", precision, double(value));
+    if (strtof(buf, nullptr) == value) {
+      return strtod(buf, nullptr);
+    }
+  }
+  return double(value);
 }
+#else
+static double ToSerializedNumber(double value) { return value; }
 #endif
 
-template <typename T>
-static void SerializeNumberArrayProperty(const std::string &key,
-                                         const std::vector<T> &value,
-                                         detail::json &obj) {
+template <typename T, size_t N>
+static void SerializeNumberArrayProperty(const char *key,
+                                         const InlineArray<T, N> &value,
+                                         detail::JsonWriter &o) {
   if (value.empty()) return;
 
-  detail::json ary;
-  detail::JsonReserveArray(ary, value.size());
+  o.Key(key);
+  o.StartArray();
   for (const auto &s : value) {
-    detail::JsonPushBack(ary, detail::json(s));
+    o.Number(ToSerializedNumber(s));
   }
-  detail::JsonAddMember(obj, key.c_str(), std::move(ary));
+  o.EndArray();
+}
+#endif
+
+static void SerializeStringProperty(const char *key, const std::string &value,
+                                    detail::JsonWriter &o) {
+  o.Key(key);
+  o.String(value.c_str());
 }
 
-static void SerializeStringProperty(const std::string &key,
-                                    const std::string &value, detail::json &obj) {
-  detail::JsonAddMember(obj, key.c_str(), detail::JsonFromString(value.c_str()));
+#ifdef TINYGLTF_USE_ARENA
+static void SerializeStringProperty(const char *key, const NameString &value,
+                                    detail::JsonWriter &o) {
+  o.Key(key);
+  o.String(value.c_str());
 }
+#endif
 
-static void SerializeStringArrayProperty(const std::string &key,
+static void SerializeStringArrayProperty(const char *key,
                                          const std::vector<std::string> &value,
-                                         detail::json &obj) {
-  detail::json ary;
-  detail::JsonReserveArray(ary, value.size());
+                                         detail::JsonWriter &o) {
+  o.Key(key);
+  o.StartArray();
   for (auto &s : value) {
-    detail::JsonPushBack(ary, detail::JsonFromString(s.c_str()));
+    o.String(s.c_str());
   }
-  detail::JsonAddMember(obj, key.c_str(), std::move(ary));
+  o.EndArray();
 }
 
-static bool ValueToJson(const Value &value, detail::json *ret) {
-  detail::json obj;
-#ifdef TINYGLTF_USE_RAPIDJSON
+// Null and binary values are not written at all.
+static bool HasJsonValue(const Value &value) {
   switch (value.Type()) {
     case REAL_TYPE:
-      obj.SetDouble(value.Get<double>());
-      break;
     case INT_TYPE:
-      obj.SetInt(value.Get<int>());
-      break;
     case BOOL_TYPE:
-      obj.SetBool(value.Get<bool>());
-      break;
     case STRING_TYPE:
-      obj.SetString(value.Get<std::string>().c_str(), detail::GetAllocator());
-      break;
-    case ARRAY_TYPE: {
-      obj.SetArray();
-      obj.Reserve(static_cast<rapidjson::SizeType>(value.ArrayLen()),
-                  detail::GetAllocator());
-      for (unsigned int i = 0; i < value.ArrayLen(); ++i) {
-        Value elementValue = value.Get(int(i));
-        detail::json elementJson;
-        if (ValueToJson(value.Get(int(i)), &elementJson))
-          obj.PushBack(std::move(elementJson), detail::GetAllocator());
-      }
-      break;
-    }
-    case BINARY_TYPE:
-      // TODO
-      // obj = detail::json(value.Get<std::vector<unsigned char>>());
-      return false;
-      break;
-    case OBJECT_TYPE: {
-      obj.SetObject();
-      Value::Object objMap = value.Get<Value::Object>();
-      for (auto &it : objMap) {
-        detail::json elementJson;
-        if (ValueToJson(it.second, &elementJson)) {
-          obj.AddMember(detail::json(it.first.c_str(), detail::GetAllocator()),
-                        std::move(elementJson), detail::GetAllocator());
-        }
-      }
-      break;
-    }
-    case NULL_TYPE:
+    case ARRAY_TYPE:
+    case OBJECT_TYPE:
+      return true;
     default:
       return false;
   }
-#else
+}
+
+// An array or object without any element that is written is written as null.
+static bool IsNullJsonValue(const Value &value) {
+  if (value.IsArray()) {
+    for (const Value &v : value.Get<Value::Array>()) {
+      if (HasJsonValue(v)) return false;
+    }
+    return true;
+  }
+  if (value.IsObject()) {
+    for (const auto &it : value.Get<Value::Object>()) {
+      if (HasJsonValue(it.second)) return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+// `value` must satisfy HasJsonValue().
+static void ValueToJson(const Value &value, detail::JsonWriter &o) {
+  if (IsNullJsonValue(value)) {
+    o.Null();
+    return;
+  }
   switch (value.Type()) {
     case REAL_TYPE:
-      obj = detail::json(value.Get<double>());
+      o.Number(value.Get<double>());
       break;
     case INT_TYPE:
-      obj = detail::json(value.Get<int>());
+      o.Number(value.Get<int>());
       break;
     case BOOL_TYPE:
-      obj = detail::json(value.Get<bool>());
+      o.Bool(value.Get<bool>());
       break;
     case STRING_TYPE:
-      obj = detail::json(value.Get<std::string>());
+      o.String(value.Get<std::string>());
       break;
     case ARRAY_TYPE: {
-      for (unsigned int i = 0; i < value.ArrayLen(); ++i) {
-        Value elementValue = value.Get(int(i));
-        detail::json elementJson;
-        if (ValueToJson(value.Get(int(i)), &elementJson))
-          obj.push_back(elementJson);
+      o.StartArray();
+      for (const Value &v : value.Get<Value::Array>()) {
+        if (HasJsonValue(v)) ValueToJson(v, o);
       }
+      o.EndArray();
       break;
     }
-    case BINARY_TYPE:
-      // TODO
-      // obj = json(value.Get<std::vector<unsigned char>>());
-      return false;
-      break;
     case OBJECT_TYPE: {
-      Value::Object objMap = value.Get<Value::Object>();
-      for (auto &it : objMap) {
-        detail::json elementJson;
-        if (ValueToJson(it.second, &elementJson)) obj[it.first] = elementJson;
+      o.StartObject();
+      for (const auto &it : value.Get<Value::Object>()) {
+        if (HasJsonValue(it.second)) {
+          o.Key(it.first);
+          ValueToJson(it.second, o);
+        }
       }
+      o.EndObject();
       break;
     }
-    case NULL_TYPE:
     default:
-      return false;
+      break;
   }
-#endif
-  if (ret) *ret = std::move(obj);
-  return true;
 }
 
-static void SerializeValue(const std::string &key, const Value &value,
-                           detail::json &obj) {
-  detail::json ret;
-  if (ValueToJson(value, &ret)) {
-    detail::JsonAddMember(obj, key.c_str(), std::move(ret));
+static void SerializeValue(const char *key, const Value &value,
+                           detail::JsonWriter &o) {
+  if (HasJsonValue(value)) {
+    o.Key(key);
+    ValueToJson(value, o);
   }
 }
 
-static void SerializeGltfBufferData(const std::vector<unsigned char> &data,
-                                    detail::json &o) {
-  std::string header = "data:application/octet-stream;base64,";
-  if (data.size() > 0) {
-    std::string encodedData =
-        base64_encode(&data[0], static_cast<unsigned int>(data.size()));
-    SerializeStringProperty("uri", header + encodedData, o);
-  } else {
-    // Issue #229
-    // size 0 is allowed. Just emit mime header.
-    SerializeStringProperty("uri", header, o);
+static void SerializeGltfBufferData(const SharedBytes &data, ThreadPool *pool,
+                                    detail::JsonWriter &o) {
+  static const char kHeader[] = "data:application/octet-stream;base64,";
+  // Encoded in pieces straight into the writer, so the data URI never exists
+  // as a whole string. The pieces are split further on `pool` if set.
+  // Issue #229: size 0 is allowed, which just emits the mime header.
+  const size_t kPieceSize = 3 * 1024 * 1024;
+  o.Key("uri");
+  o.StartRawString();
+  o.RawStringPart(kHeader, sizeof(kHeader) - 1);
+  for (size_t offset = 0; offset < data.size(); offset += kPieceSize) {
+    const size_t n = (std::min)(kPieceSize, data.size() - offset);
+    o.RawStringPart(base64_encoded_size(n), [&](char *out) {
+      base64_encode(data.data() + offset, n, out, pool);
+    });
   }
+  o.EndRawString();
 }
 
-static bool SerializeGltfBufferData(const std::vector<unsigned char> &data,
+static bool SerializeGltfBufferData(const SharedBytes &data,
                                     const std::string &binFilename) {
 #ifdef _WIN32
 #if defined(__GLIBCXX__)  // mingw
@@ -6812,64 +12209,70 @@ static bool SerializeGltfBufferData(const std::vector<unsigned char> &data,
   return true;
 }
 
-#if 0  // FIXME(syoyo): not used. will be removed in the future release.
-static void SerializeParameterMap(ParameterMap &param, detail::json &o) {
-  for (ParameterMap::iterator paramIt = param.begin(); paramIt != param.end();
-       ++paramIt) {
-    if (paramIt->second.number_array.size()) {
-      SerializeNumberArrayProperty<double>(paramIt->first,
-                                           paramIt->second.number_array, o);
-    } else if (paramIt->second.json_double_value.size()) {
-      detail::json json_double_value;
-      for (std::map<std::string, double>::iterator it =
-               paramIt->second.json_double_value.begin();
-           it != paramIt->second.json_double_value.end(); ++it) {
-        if (it->first == "index") {
-          json_double_value[it->first] = paramIt->second.TextureIndex();
-        } else {
-          json_double_value[it->first] = it->second;
-        }
-      }
+static const char kKhrLightsPunctual[] = "KHR_lights_punctual";
 
-      o[paramIt->first] = json_double_value;
-    } else if (!paramIt->second.string_value.empty()) {
-      SerializeStringProperty(paramIt->first, paramIt->second.string_value, o);
-    } else if (paramIt->second.has_number_value) {
-      o[paramIt->first] = paramIt->second.number_value;
-    } else {
-      o[paramIt->first] = paramIt->second.bool_value;
-    }
+static void SerializeGltfLight(const Light &light, detail::JsonWriter &o);
+
+// With `lights` the map is written with "KHR_lights_punctual" set to them.
+static void SerializeExtensionMap(const ExtensionMap &extensions,
+                                  detail::JsonWriter &o,
+                                  const std::vector<Light> *lights = nullptr) {
+  if (!extensions.size() && !lights) return;
+
+  // Allow an empty object for extension(#97): an extension without a value
+  // is written as {} so that its name is still included in json.
+  bool has_members = (lights != nullptr);
+  for (const auto &it : extensions) {
+    has_members = has_members || !it.first.empty() || HasJsonValue(it.second);
+  }
+  o.Key("extensions");
+  if (!has_members) {
+    o.Null();
+    return;
   }
-}
-#endif
 
-static void SerializeExtensionMap(const ExtensionMap &extensions, detail::json &o) {
-  if (!extensions.size()) return;
+  bool lights_written = (lights == nullptr);
+  auto write_lights = [&]() {
+    o.Key(kKhrLightsPunctual);
+    o.StartObject();
+    o.Key("lights");
+    o.StartArray();
+    for (const Light &light : *lights) {
+      SerializeGltfLight(light, o);
+    }
+    o.EndArray();
+    o.EndObject();
+    lights_written = true;
+  };
 
-  detail::json extMap;
-  for (ExtensionMap::const_iterator extIt = extensions.begin();
-       extIt != extensions.end(); ++extIt) {
-    // Allow an empty object for extension(#97)
-    detail::json ret;
-    bool isNull = true;
-    if (ValueToJson(extIt->second, &ret)) {
-      isNull = detail::JsonIsNull(ret);
-      detail::JsonAddMember(extMap, extIt->first.c_str(), std::move(ret));
+  o.StartObject();
+  for (const auto &it : extensions) {
+    if (!lights_written && (it.first.compare(kKhrLightsPunctual) >= 0)) {
+      write_lights();
+      if (it.first == kKhrLightsPunctual) continue;
     }
-    if (isNull) {
-      if (!(extIt->first.empty())) {  // name should not be empty, but for sure
-        // create empty object so that an extension name is still included in
-        // json.
-        detail::json empty;
-        detail::JsonSetObject(empty);
-        detail::JsonAddMember(extMap, extIt->first.c_str(), std::move(empty));
-      }
+    const bool has_value = HasJsonValue(it.second);
+    if (has_value && !IsNullJsonValue(it.second)) {
+      o.Key(it.first);
+      ValueToJson(it.second, o);
+    } else if (!it.first.empty()) {
+      o.Key(it.first);
+      o.StartObject();
+      o.EndObject();
+    } else if (has_value) {
+      o.Key(it.first);
+      o.Null();
     }
   }
-  detail::JsonAddMember(o, "extensions", std::move(extMap));
+  if (!lights_written) {
+    write_lights();
+  }
+  o.EndObject();
 }
 
-static void SerializeGltfAccessor(const Accessor &accessor, detail::json &o) {
+static void SerializeGltfAccessor(const Accessor &accessor,
+                                  detail::JsonWriter &o) {
+  o.StartObject();
   if (accessor.bufferView >= 0)
     SerializeNumberProperty<int>("bufferView", accessor.bufferView, o);
 
@@ -6879,35 +12282,68 @@ static void SerializeGltfAccessor(const Accessor &accessor, detail::json &o) {
   SerializeNumberProperty<int>("componentType", accessor.componentType, o);
   SerializeNumberProperty<size_t>("count", accessor.count, o);
 
+  if (accessor.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", accessor.extras, o);
+  }
+
   if ((accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) ||
       (accessor.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE)) {
-    SerializeNumberArrayProperty<double>("min", accessor.minValues, o);
     SerializeNumberArrayProperty<double>("max", accessor.maxValues, o);
+    SerializeNumberArrayProperty<double>("min", accessor.minValues, o);
   } else {
     // Issue #301. Serialize as integer.
     // Assume int value is within [-2**31-1, 2**31-1]
     {
       std::vector<int> values;
-      std::transform(accessor.minValues.begin(), accessor.minValues.end(),
+      std::transform(accessor.maxValues.begin(), accessor.maxValues.end(),
                      std::back_inserter(values),
                      [](double v) { return static_cast<int>(v); });
 
-      SerializeNumberArrayProperty<int>("min", values, o);
+      SerializeNumberArrayProperty<int>("max", values, o);
     }
 
     {
       std::vector<int> values;
-      std::transform(accessor.maxValues.begin(), accessor.maxValues.end(),
+      std::transform(accessor.minValues.begin(), accessor.minValues.end(),
                      std::back_inserter(values),
                      [](double v) { return static_cast<int>(v); });
 
-      SerializeNumberArrayProperty<int>("max", values, o);
+      SerializeNumberArrayProperty<int>("min", values, o);
     }
   }
 
-  if (accessor.normalized)
-    SerializeValue("normalized", Value(accessor.normalized), o);
-  std::string type;
+  if (!accessor.name.empty()) SerializeStringProperty("name", accessor.name, o);
+
+  if (accessor.normalized) {
+    o.Key("normalized");
+    o.Bool(true);
+  }
+
+  // sparse
+  if (accessor.sparse.isSparse) {
+    o.Key("sparse");
+    o.StartObject();
+    SerializeNumberProperty<int>("count", accessor.sparse.count, o);
+    o.Key("indices");
+    o.StartObject();
+    SerializeNumberProperty<int>("bufferView",
+                                 accessor.sparse.indices.bufferView, o);
+    SerializeNumberProperty<int>("byteOffset",
+                                 accessor.sparse.indices.byteOffset, o);
+    SerializeNumberProperty<int>("componentType",
+                                 accessor.sparse.indices.componentType, o);
+    o.EndObject();
+    o.Key("values");
+    o.StartObject();
+    SerializeNumberProperty<int>("bufferView",
+                                 accessor.sparse.values.bufferView, o);
+    SerializeNumberProperty<int>("byteOffset",
+                                 accessor.sparse.values.byteOffset, o);
+    o.EndObject();
+    o.EndObject();
+  }
+
+  const char *type = "";
   switch (accessor.type) {
     case TINYGLTF_TYPE_SCALAR:
       type = "SCALAR";
@@ -6931,311 +12367,326 @@ static void SerializeGltfAccessor(const Accessor &accessor, detail::json &o) {
       type = "MAT4";
       break;
   }
-
-  SerializeStringProperty("type", type, o);
-  if (!accessor.name.empty()) SerializeStringProperty("name", accessor.name, o);
-
-  if (accessor.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", accessor.extras, o);
-  }
-
-  // sparse
-  if (accessor.sparse.isSparse)
-  {
-      detail::json sparse;
-      SerializeNumberProperty<int>("count", accessor.sparse.count, sparse);
-      {
-          detail::json indices;
-          SerializeNumberProperty<int>("bufferView", accessor.sparse.indices.bufferView, indices);
-          SerializeNumberProperty<int>("byteOffset", accessor.sparse.indices.byteOffset, indices);
-          SerializeNumberProperty<int>("componentType", accessor.sparse.indices.componentType, indices);
-          detail::JsonAddMember(sparse, "indices", std::move(indices));
-      }
-      {
-          detail::json values;
-          SerializeNumberProperty<int>("bufferView", accessor.sparse.values.bufferView, values);
-          SerializeNumberProperty<int>("byteOffset", accessor.sparse.values.byteOffset, values);
-          detail::JsonAddMember(sparse, "values", std::move(values));
-      }
-      detail::JsonAddMember(o, "sparse", std::move(sparse));
-  }
+  o.Key("type");
+  o.String(type);
+  o.EndObject();
 }
 
 static void SerializeGltfAnimationChannel(const AnimationChannel &channel,
-                                          detail::json &o) {
-  SerializeNumberProperty("sampler", channel.sampler, o);
-  {
-    detail::json target;
-
-    if (channel.target_node > 0) {
-      SerializeNumberProperty("node", channel.target_node, target);
-    }
-
-    SerializeStringProperty("path", channel.target_path, target);
-
-    SerializeExtensionMap(channel.target_extensions, target);
-
-    detail::JsonAddMember(o, "target", std::move(target));
-  }
+                                          detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeExtensionMap(channel.extensions, o);
 
   if (channel.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", channel.extras, o);
   }
 
-  SerializeExtensionMap(channel.extensions, o);
+  SerializeNumberProperty("sampler", channel.sampler, o);
+
+  o.Key("target");
+  o.StartObject();
+  SerializeExtensionMap(channel.target_extensions, o);
+  if (channel.target_node > 0) {
+    SerializeNumberProperty("node", channel.target_node, o);
+  }
+  SerializeStringProperty("path", channel.target_path, o);
+  o.EndObject();
+
+  o.EndObject();
 }
 
 static void SerializeGltfAnimationSampler(const AnimationSampler &sampler,
-                                          detail::json &o) {
-  SerializeNumberProperty("input", sampler.input, o);
-  SerializeNumberProperty("output", sampler.output, o);
-  SerializeStringProperty("interpolation", sampler.interpolation, o);
-
+                                          detail::JsonWriter &o) {
+  o.StartObject();
   if (sampler.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", sampler.extras, o);
   }
-}
-
-static void SerializeGltfAnimation(const Animation &animation, detail::json &o) {
-  if (!animation.name.empty())
-    SerializeStringProperty("name", animation.name, o);
 
-  {
-    detail::json channels;
-    detail::JsonReserveArray(channels, animation.channels.size());
-    for (unsigned int i = 0; i < animation.channels.size(); ++i) {
-      detail::json channel;
-      AnimationChannel gltfChannel = animation.channels[i];
-      SerializeGltfAnimationChannel(gltfChannel, channel);
-      detail::JsonPushBack(channels, std::move(channel));
-    }
+  SerializeNumberProperty("input", sampler.input, o);
+  SerializeStringProperty("interpolation", sampler.interpolation, o);
+  SerializeNumberProperty("output", sampler.output, o);
+  o.EndObject();
+}
 
-    detail::JsonAddMember(o, "channels", std::move(channels));
+static void SerializeGltfAnimation(const Animation &animation,
+                                   detail::JsonWriter &o) {
+  o.StartObject();
+  o.Key("channels");
+  o.StartArray();
+  for (const AnimationChannel &channel : animation.channels) {
+    SerializeGltfAnimationChannel(channel, o);
   }
+  o.EndArray();
 
-  {
-    detail::json samplers;
-    detail::JsonReserveArray(samplers, animation.samplers.size());
-    for (unsigned int i = 0; i < animation.samplers.size(); ++i) {
-      detail::json sampler;
-      AnimationSampler gltfSampler = animation.samplers[i];
-      SerializeGltfAnimationSampler(gltfSampler, sampler);
-      detail::JsonPushBack(samplers, std::move(sampler));
-    }
-    detail::JsonAddMember(o, "samplers", std::move(samplers));
-  }
+  SerializeExtensionMap(animation.extensions, o);
 
   if (animation.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", animation.extras, o);
   }
 
-  SerializeExtensionMap(animation.extensions, o);
-}
+  if (!animation.name.empty())
+    SerializeStringProperty("name", animation.name, o);
 
-static void SerializeGltfAsset(const Asset &asset, detail::json &o) {
-  if (!asset.generator.empty()) {
-    SerializeStringProperty("generator", asset.generator, o);
+  o.Key("samplers");
+  if (animation.samplers.empty()) {
+    o.Null();
+  } else {
+    o.StartArray();
+    for (const AnimationSampler &sampler : animation.samplers) {
+      SerializeGltfAnimationSampler(sampler, o);
+    }
+    o.EndArray();
   }
+  o.EndObject();
+}
 
+static void SerializeGltfAsset(const Asset &asset, detail::JsonWriter &o) {
+  o.StartObject();
   if (!asset.copyright.empty()) {
     SerializeStringProperty("copyright", asset.copyright, o);
   }
 
-  auto version = asset.version;
-  if (version.empty()) {
-    // Just in case
-    // `version` must be defined
-    version = "2.0";
-  }
-
-  // TODO(syoyo): Do we need to check if `version` is greater or equal to 2.0?
-  SerializeStringProperty("version", version, o);
+  SerializeExtensionMap(asset.extensions, o);
 
   if (asset.extras.Keys().size()) {
     SerializeValue("extras", asset.extras, o);
   }
 
-  SerializeExtensionMap(asset.extensions, o);
+  if (!asset.generator.empty()) {
+    SerializeStringProperty("generator", asset.generator, o);
+  }
+
+  // TODO(syoyo): Do we need to check if `version` is greater or equal to 2.0?
+  // `version` must be defined, so "2.0" is written if it is empty.
+  SerializeStringProperty("version",
+                          asset.version.empty() ? "2.0" : asset.version, o);
+  o.EndObject();
 }
 
-static void SerializeGltfBufferBin(const Buffer &buffer, detail::json &o,
-                                   std::vector<unsigned char> &binBuffer) {
+// The buffer stored in the BIN chunk of a GLB has no uri.
+static void SerializeGltfBufferBin(const Buffer &buffer,
+                                   detail::JsonWriter &o) {
+  o.StartObject();
   SerializeNumberProperty("byteLength", buffer.data.size(), o);
-  binBuffer = buffer.data;
-
-  if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
   if (buffer.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", buffer.extras, o);
   }
+
+  if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
+  o.EndObject();
 }
 
-static void SerializeGltfBuffer(const Buffer &buffer, detail::json &o) {
+static void SerializeGltfBuffer(const Buffer &buffer, ThreadPool *pool,
+                                detail::JsonWriter &o) {
+  o.StartObject();
   SerializeNumberProperty("byteLength", buffer.data.size(), o);
-  SerializeGltfBufferData(buffer.data, o);
-
-  if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
   if (buffer.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", buffer.extras, o);
   }
+
+  if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
+
+  SerializeGltfBufferData(buffer.data, pool, o);
+  o.EndObject();
 }
 
-static bool SerializeGltfBuffer(const Buffer &buffer, detail::json &o,
-                                const std::string &binFilename,
+static void SerializeGltfBuffer(const Buffer &buffer, detail::JsonWriter &o,
                                 const std::string &binUri) {
-  if (!SerializeGltfBufferData(buffer.data, binFilename)) return false;
+  o.StartObject();
   SerializeNumberProperty("byteLength", buffer.data.size(), o);
-  SerializeStringProperty("uri", binUri, o);
-
-  if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
   if (buffer.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", buffer.extras, o);
   }
-  return true;
+
+  if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
+
+  SerializeStringProperty("uri", binUri, o);
+  o.EndObject();
 }
 
-static void SerializeGltfBufferView(const BufferView &bufferView, detail::json &o) {
+static void SerializeGltfBufferView(const BufferView &bufferView,
+                                    detail::JsonWriter &o) {
+  o.StartObject();
   SerializeNumberProperty("buffer", bufferView.buffer, o);
   SerializeNumberProperty<size_t>("byteLength", bufferView.byteLength, o);
 
-  // byteStride is optional, minimum allowed is 4
-  if (bufferView.byteStride >= 4) {
-    SerializeNumberProperty<size_t>("byteStride", bufferView.byteStride, o);
-  }
   // byteOffset is optional, default is 0
   if (bufferView.byteOffset > 0) {
     SerializeNumberProperty<size_t>("byteOffset", bufferView.byteOffset, o);
   }
-  // Target is optional, check if it contains a valid value
-  if (bufferView.target == TINYGLTF_TARGET_ARRAY_BUFFER ||
-      bufferView.target == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER) {
-    SerializeNumberProperty("target", bufferView.target, o);
+  // byteStride is optional, minimum allowed is 4
+  if (bufferView.byteStride >= 4) {
+    SerializeNumberProperty<size_t>("byteStride", bufferView.byteStride, o);
+  }
+
+  SerializeExtensionMap(bufferView.extensions, o);
+
+  if (bufferView.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", bufferView.extras, o);
   }
+
   if (bufferView.name.size()) {
     SerializeStringProperty("name", bufferView.name, o);
   }
 
-  if (bufferView.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", bufferView.extras, o);
+  // Target is optional, check if it contains a valid value
+  if (bufferView.target == TINYGLTF_TARGET_ARRAY_BUFFER ||
+      bufferView.target == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER) {
+    SerializeNumberProperty("target", bufferView.target, o);
   }
+  o.EndObject();
 }
 
 static void SerializeGltfImage(const Image &image, const std::string &uri,
-                               detail::json &o) {
+                               detail::JsonWriter &o) {
+  o.StartObject();
   // From 2.7.0, we look for `uri` parameter, not `Image.uri`
   // if uri is empty, the mimeType and bufferview should be set
   if (uri.empty()) {
-    SerializeStringProperty("mimeType", image.mimeType, o);
     SerializeNumberProperty<int>("bufferView", image.bufferView, o);
-  } else {
-    SerializeStringProperty("uri", uri, o);
   }
 
-  if (image.name.size()) {
-    SerializeStringProperty("name", image.name, o);
-  }
+  SerializeExtensionMap(image.extensions, o);
 
   if (image.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", image.extras, o);
   }
 
-  SerializeExtensionMap(image.extensions, o);
-}
+  if (uri.empty()) {
+    SerializeStringProperty("mimeType", image.mimeType, o);
+  }
 
-static void SerializeGltfTextureInfo(const TextureInfo &texinfo, detail::json &o) {
-  SerializeNumberProperty("index", texinfo.index, o);
+  if (image.name.size()) {
+    SerializeStringProperty("name", image.name, o);
+  }
 
-  if (texinfo.texCoord != 0) {
-    SerializeNumberProperty("texCoord", texinfo.texCoord, o);
+  if (!uri.empty()) {
+    SerializeStringProperty("uri", uri, o);
   }
+  o.EndObject();
+}
+
+static void SerializeGltfTextureInfo(const TextureInfo &texinfo,
+                                     detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeExtensionMap(texinfo.extensions, o);
 
   if (texinfo.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", texinfo.extras, o);
   }
 
-  SerializeExtensionMap(texinfo.extensions, o);
-}
-
-static void SerializeGltfNormalTextureInfo(const NormalTextureInfo &texinfo,
-                                           detail::json &o) {
   SerializeNumberProperty("index", texinfo.index, o);
 
   if (texinfo.texCoord != 0) {
     SerializeNumberProperty("texCoord", texinfo.texCoord, o);
   }
+  o.EndObject();
+}
 
-  if (!TINYGLTF_DOUBLE_EQUAL(texinfo.scale, 1.0)) {
-    SerializeNumberProperty("scale", texinfo.scale, o);
-  }
+static void SerializeGltfNormalTextureInfo(const NormalTextureInfo &texinfo,
+                                           detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeExtensionMap(texinfo.extensions, o);
 
   if (texinfo.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", texinfo.extras, o);
   }
 
-  SerializeExtensionMap(texinfo.extensions, o);
-}
-
-static void SerializeGltfOcclusionTextureInfo(
-    const OcclusionTextureInfo &texinfo, detail::json &o) {
   SerializeNumberProperty("index", texinfo.index, o);
 
+  if (!TINYGLTF_DOUBLE_EQUAL(texinfo.scale, 1.0)) {
+    SerializeNumberProperty("scale", texinfo.scale, o);
+  }
+
   if (texinfo.texCoord != 0) {
     SerializeNumberProperty("texCoord", texinfo.texCoord, o);
   }
+  o.EndObject();
+}
+
+static void SerializeGltfOcclusionTextureInfo(
+    const OcclusionTextureInfo &texinfo, detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeExtensionMap(texinfo.extensions, o);
+
+  if (texinfo.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", texinfo.extras, o);
+  }
+
+  SerializeNumberProperty("index", texinfo.index, o);
 
   if (!TINYGLTF_DOUBLE_EQUAL(texinfo.strength, 1.0)) {
     SerializeNumberProperty("strength", texinfo.strength, o);
   }
 
-  if (texinfo.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", texinfo.extras, o);
+  if (texinfo.texCoord != 0) {
+    SerializeNumberProperty("texCoord", texinfo.texCoord, o);
   }
+  o.EndObject();
+}
 
-  SerializeExtensionMap(texinfo.extensions, o);
+static bool IsDefaultBaseColorFactor(const std::vector<double> &factor) {
+  static const std::vector<double> default_baseColorFactor = {1.0, 1.0, 1.0,
+                                                              1.0};
+  return Equals(factor, default_baseColorFactor);
+}
+
+// Issue 204
+// `pbrMetallicRoughness` is not serialized if it has all default values.
+// Otherwise it would serialize to `pbrMetallicRoughness : null`, which cannot
+// be read by other glTF importers (and validators).
+static bool HasPbrMetallicRoughnessMembers(const PbrMetallicRoughness &pbr) {
+  return !IsDefaultBaseColorFactor(pbr.baseColorFactor) ||
+         !TINYGLTF_DOUBLE_EQUAL(pbr.metallicFactor, 1.0) ||
+         !TINYGLTF_DOUBLE_EQUAL(pbr.roughnessFactor, 1.0) ||
+         (pbr.baseColorTexture.index > -1) ||
+         (pbr.metallicRoughnessTexture.index > -1) ||
+         pbr.extensions.size() || HasJsonValue(pbr.extras);
 }
 
 static void SerializeGltfPbrMetallicRoughness(const PbrMetallicRoughness &pbr,
-                                              detail::json &o) {
-  std::vector<double> default_baseColorFactor = {1.0, 1.0, 1.0, 1.0};
-  if (!Equals(pbr.baseColorFactor, default_baseColorFactor)) {
+                                              detail::JsonWriter &o) {
+  o.StartObject();
+  if (!IsDefaultBaseColorFactor(pbr.baseColorFactor)) {
     SerializeNumberArrayProperty<double>("baseColorFactor", pbr.baseColorFactor,
                                          o);
   }
 
-  if (!TINYGLTF_DOUBLE_EQUAL(pbr.metallicFactor, 1.0)) {
-    SerializeNumberProperty("metallicFactor", pbr.metallicFactor, o);
+  if (pbr.baseColorTexture.index > -1) {
+    o.Key("baseColorTexture");
+    SerializeGltfTextureInfo(pbr.baseColorTexture, o);
   }
 
-  if (!TINYGLTF_DOUBLE_EQUAL(pbr.roughnessFactor, 1.0)) {
-    SerializeNumberProperty("roughnessFactor", pbr.roughnessFactor, o);
+  SerializeExtensionMap(pbr.extensions, o);
+
+  if (pbr.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", pbr.extras, o);
   }
 
-  if (pbr.baseColorTexture.index > -1) {
-    detail::json texinfo;
-    SerializeGltfTextureInfo(pbr.baseColorTexture, texinfo);
-    detail::JsonAddMember(o, "baseColorTexture", std::move(texinfo));
+  if (!TINYGLTF_DOUBLE_EQUAL(pbr.metallicFactor, 1.0)) {
+    SerializeNumberProperty("metallicFactor", pbr.metallicFactor, o);
   }
 
   if (pbr.metallicRoughnessTexture.index > -1) {
-    detail::json texinfo;
-    SerializeGltfTextureInfo(pbr.metallicRoughnessTexture, texinfo);
-    detail::JsonAddMember(o, "metallicRoughnessTexture", std::move(texinfo));
+    o.Key("metallicRoughnessTexture");
+    SerializeGltfTextureInfo(pbr.metallicRoughnessTexture, o);
   }
 
-  SerializeExtensionMap(pbr.extensions, o);
-
-  if (pbr.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", pbr.extras, o);
+  if (!TINYGLTF_DOUBLE_EQUAL(pbr.roughnessFactor, 1.0)) {
+    SerializeNumberProperty("roughnessFactor", pbr.roughnessFactor, o);
   }
+  o.EndObject();
 }
 
-static void SerializeGltfMaterial(const Material &material, detail::json &o) {
-  if (material.name.size()) {
-    SerializeStringProperty("name", material.name, o);
-  }
-
+// Issue 294.
+// `material` does not have any required parameters, so a material with all
+// default values is written as an empty JSON object.
+static void SerializeGltfMaterial(const Material &material,
+                                  detail::JsonWriter &o) {
+  o.StartObject();
   // QUESTION(syoyo): Write material parameters regardless of its default value?
 
   if (!TINYGLTF_DOUBLE_EQUAL(material.alphaCutoff, 0.5)) {
@@ -7246,205 +12697,198 @@ static void SerializeGltfMaterial(const Material &material, detail::json &o) {
     SerializeStringProperty("alphaMode", material.alphaMode, o);
   }
 
-  if (material.doubleSided != false)
-    detail::JsonAddMember(o, "doubleSided", detail::json(material.doubleSided));
-
-  if (material.normalTexture.index > -1) {
-    detail::json texinfo;
-    SerializeGltfNormalTextureInfo(material.normalTexture, texinfo);
-    detail::JsonAddMember(o, "normalTexture", std::move(texinfo));
+  if (material.doubleSided != false) {
+    o.Key("doubleSided");
+    o.Bool(material.doubleSided);
   }
 
-  if (material.occlusionTexture.index > -1) {
-    detail::json texinfo;
-    SerializeGltfOcclusionTextureInfo(material.occlusionTexture, texinfo);
-    detail::JsonAddMember(o, "occlusionTexture", std::move(texinfo));
+  std::vector<double> default_emissiveFactor = {0.0, 0.0, 0.0};
+  if (!Equals(material.emissiveFactor, default_emissiveFactor)) {
+    SerializeNumberArrayProperty<double>("emissiveFactor",
+                                         material.emissiveFactor, o);
   }
 
   if (material.emissiveTexture.index > -1) {
-    detail::json texinfo;
-    SerializeGltfTextureInfo(material.emissiveTexture, texinfo);
-    detail::JsonAddMember(o, "emissiveTexture", std::move(texinfo));
+    o.Key("emissiveTexture");
+    SerializeGltfTextureInfo(material.emissiveTexture, o);
   }
 
-  std::vector<double> default_emissiveFactor = {0.0, 0.0, 0.0};
-  if (!Equals(material.emissiveFactor, default_emissiveFactor)) {
-    SerializeNumberArrayProperty<double>("emissiveFactor",
-                                         material.emissiveFactor, o);
+  SerializeExtensionMap(material.extensions, o);
+
+  if (material.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", material.extras, o);
   }
 
-  {
-    detail::json pbrMetallicRoughness;
-    SerializeGltfPbrMetallicRoughness(material.pbrMetallicRoughness,
-                                      pbrMetallicRoughness);
-    // Issue 204
-    // Do not serialize `pbrMetallicRoughness` if pbrMetallicRoughness has all
-    // default values(json is null). Otherwise it will serialize to
-    // `pbrMetallicRoughness : null`, which cannot be read by other glTF
-    // importers (and validators).
-    //
-    if (!detail::JsonIsNull(pbrMetallicRoughness)) {
-      detail::JsonAddMember(o, "pbrMetallicRoughness", std::move(pbrMetallicRoughness));
-    }
+  if (material.name.size()) {
+    SerializeStringProperty("name", material.name, o);
   }
 
-#if 0  // legacy way. just for the record.
-  if (material.values.size()) {
-    detail::json pbrMetallicRoughness;
-    SerializeParameterMap(material.values, pbrMetallicRoughness);
-    detail::JsonAddMember(o, "pbrMetallicRoughness", std::move(pbrMetallicRoughness));
+  if (material.normalTexture.index > -1) {
+    o.Key("normalTexture");
+    SerializeGltfNormalTextureInfo(material.normalTexture, o);
   }
 
-  SerializeParameterMap(material.additionalValues, o);
-#else
+  if (material.occlusionTexture.index > -1) {
+    o.Key("occlusionTexture");
+    SerializeGltfOcclusionTextureInfo(material.occlusionTexture, o);
+  }
 
-#endif
+  if (HasPbrMetallicRoughnessMembers(material.pbrMetallicRoughness)) {
+    o.Key("pbrMetallicRoughness");
+    SerializeGltfPbrMetallicRoughness(material.pbrMetallicRoughness, o);
+  }
+  o.EndObject();
+}
 
-  SerializeExtensionMap(material.extensions, o);
+// AttributeMap is ordered by AttributeKey, not by name. An empty map is
+// written as null.
+static void SerializeAttributeMap(const AttributeMap &attributes,
+                                  detail::JsonWriter &o) {
+  std::vector<std::pair<std::string, int>> sorted;
+  sorted.reserve(attributes.size());
+  for (const auto &attr : attributes) {
+    sorted.emplace_back(attr.first.Name(), attr.second);
+  }
+  std::sort(sorted.begin(), sorted.end());
 
-  if (material.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", material.extras, o);
+  o.StartNullableObject();
+  for (const auto &attr : sorted) {
+    o.Key(attr.first);
+    o.Number(attr.second);
   }
+  o.EndObject();
 }
 
-static void SerializeGltfMesh(const Mesh &mesh, detail::json &o) {
-  detail::json primitives;
-  detail::JsonReserveArray(primitives, mesh.primitives.size());
-  for (unsigned int i = 0; i < mesh.primitives.size(); ++i) {
-    detail::json primitive;
-    const Primitive &gltfPrimitive = mesh.primitives[i];  // don't make a copy
-    {
-      detail::json attributes;
-      for (auto attrIt = gltfPrimitive.attributes.begin();
-           attrIt != gltfPrimitive.attributes.end(); ++attrIt) {
-        SerializeNumberProperty<int>(attrIt->first, attrIt->second, attributes);
-      }
+static void SerializeGltfMesh(const Mesh &mesh, detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeExtensionMap(mesh.extensions, o);
+  if (mesh.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", mesh.extras, o);
+  }
+
+  if (mesh.name.size()) {
+    SerializeStringProperty("name", mesh.name, o);
+  }
+
+  o.Key("primitives");
+  if (mesh.primitives.empty()) {
+    o.Null();
+  } else {
+    o.StartArray();
+  }
+  for (const Primitive &gltfPrimitive : mesh.primitives) {
+    o.StartObject();
+    o.Key("attributes");
+    SerializeAttributeMap(gltfPrimitive.attributes, o);
 
-      detail::JsonAddMember(primitive, "attributes", std::move(attributes));
+    SerializeExtensionMap(gltfPrimitive.extensions, o);
+
+    if (gltfPrimitive.extras.Type() != NULL_TYPE) {
+      SerializeValue("extras", gltfPrimitive.extras, o);
     }
 
     // Indices is optional
     if (gltfPrimitive.indices > -1) {
-      SerializeNumberProperty<int>("indices", gltfPrimitive.indices, primitive);
+      SerializeNumberProperty<int>("indices", gltfPrimitive.indices, o);
     }
     // Material is optional
     if (gltfPrimitive.material > -1) {
-      SerializeNumberProperty<int>("material", gltfPrimitive.material,
-                                   primitive);
+      SerializeNumberProperty<int>("material", gltfPrimitive.material, o);
     }
-    SerializeNumberProperty<int>("mode", gltfPrimitive.mode, primitive);
+    SerializeNumberProperty<int>("mode", gltfPrimitive.mode, o);
 
     // Morph targets
     if (gltfPrimitive.targets.size()) {
-      detail::json targets;
-      detail::JsonReserveArray(targets, gltfPrimitive.targets.size());
-      for (unsigned int k = 0; k < gltfPrimitive.targets.size(); ++k) {
-        detail::json targetAttributes;
-        std::map<std::string, int> targetData = gltfPrimitive.targets[k];
-        for (std::map<std::string, int>::iterator attrIt = targetData.begin();
-             attrIt != targetData.end(); ++attrIt) {
-          SerializeNumberProperty<int>(attrIt->first, attrIt->second,
-                                       targetAttributes);
-        }
-        detail::JsonPushBack(targets, std::move(targetAttributes));
+      o.Key("targets");
+      o.StartArray();
+      for (const AttributeMap &targetData : gltfPrimitive.targets) {
+        SerializeAttributeMap(targetData, o);
       }
-      detail::JsonAddMember(primitive, "targets", std::move(targets));
-    }
-
-    SerializeExtensionMap(gltfPrimitive.extensions, primitive);
-
-    if (gltfPrimitive.extras.Type() != NULL_TYPE) {
-      SerializeValue("extras", gltfPrimitive.extras, primitive);
+      o.EndArray();
     }
-
-    detail::JsonPushBack(primitives, std::move(primitive));
+    o.EndObject();
+  }
+  if (mesh.primitives.size()) {
+    o.EndArray();
   }
-
-  detail::JsonAddMember(o, "primitives", std::move(primitives));
 
   if (mesh.weights.size()) {
     SerializeNumberArrayProperty<double>("weights", mesh.weights, o);
   }
-
-  if (mesh.name.size()) {
-    SerializeStringProperty("name", mesh.name, o);
-  }
-
-  SerializeExtensionMap(mesh.extensions, o);
-  if (mesh.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", mesh.extras, o);
-  }
+  o.EndObject();
 }
 
-static void SerializeSpotLight(const SpotLight &spot, detail::json &o) {
-  SerializeNumberProperty("innerConeAngle", spot.innerConeAngle, o);
-  SerializeNumberProperty("outerConeAngle", spot.outerConeAngle, o);
+static void SerializeSpotLight(const SpotLight &spot, detail::JsonWriter &o) {
+  o.StartObject();
   SerializeExtensionMap(spot.extensions, o);
   if (spot.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", spot.extras, o);
   }
+  SerializeNumberProperty("innerConeAngle", spot.innerConeAngle, o);
+  SerializeNumberProperty("outerConeAngle", spot.outerConeAngle, o);
+  o.EndObject();
 }
 
-static void SerializeGltfLight(const Light &light, detail::json &o) {
-  if (!light.name.empty()) SerializeStringProperty("name", light.name, o);
+static void SerializeGltfLight(const Light &light, detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeNumberArrayProperty("color", light.color, o);
+  SerializeExtensionMap(light.extensions, o);
+  if (light.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", light.extras, o);
+  }
   SerializeNumberProperty("intensity", light.intensity, o);
+  if (!light.name.empty()) SerializeStringProperty("name", light.name, o);
   if (light.range > 0.0) {
     SerializeNumberProperty("range", light.range, o);
   }
-  SerializeNumberArrayProperty("color", light.color, o);
-  SerializeStringProperty("type", light.type, o);
   if (light.type == "spot") {
-    detail::json spot;
-    SerializeSpotLight(light.spot, spot);
-    detail::JsonAddMember(o, "spot", std::move(spot));
-  }
-  SerializeExtensionMap(light.extensions, o);
-  if (light.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", light.extras, o);
+    o.Key("spot");
+    SerializeSpotLight(light.spot, o);
   }
+  SerializeStringProperty("type", light.type, o);
+  o.EndObject();
 }
 
-static void SerializeGltfNode(const Node &node, detail::json &o) {
-  if (node.translation.size() > 0) {
-    SerializeNumberArrayProperty<double>("translation", node.translation, o);
-  }
-  if (node.rotation.size() > 0) {
-    SerializeNumberArrayProperty<double>("rotation", node.rotation, o);
+static void SerializeGltfNode(const Node &node, detail::JsonWriter &o) {
+  o.StartNullableObject();
+  if (node.camera != -1) {
+    SerializeNumberProperty<int>("camera", node.camera, o);
   }
-  if (node.scale.size() > 0) {
-    SerializeNumberArrayProperty<double>("scale", node.scale, o);
+  SerializeNumberArrayProperty<int>("children", node.children, o);
+  SerializeExtensionMap(node.extensions, o);
+  if (node.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", node.extras, o);
   }
   if (node.matrix.size() > 0) {
-    SerializeNumberArrayProperty<double>("matrix", node.matrix, o);
+    SerializeNumberArrayProperty("matrix", node.matrix, o);
   }
   if (node.mesh != -1) {
     SerializeNumberProperty<int>("mesh", node.mesh, o);
   }
-
+  if (!node.name.empty()) SerializeStringProperty("name", node.name, o);
+  if (node.rotation.size() > 0) {
+    SerializeNumberArrayProperty("rotation", node.rotation, o);
+  }
+  if (node.scale.size() > 0) {
+    SerializeNumberArrayProperty("scale", node.scale, o);
+  }
   if (node.skin != -1) {
     SerializeNumberProperty<int>("skin", node.skin, o);
   }
-
-  if (node.camera != -1) {
-    SerializeNumberProperty<int>("camera", node.camera, o);
+  if (node.translation.size() > 0) {
+    SerializeNumberArrayProperty("translation", node.translation, o);
   }
-
   if (node.weights.size() > 0) {
     SerializeNumberArrayProperty<double>("weights", node.weights, o);
   }
-
-  if (node.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", node.extras, o);
-  }
-
-  SerializeExtensionMap(node.extensions, o);
-  if (!node.name.empty()) SerializeStringProperty("name", node.name, o);
-  SerializeNumberArrayProperty<int>("children", node.children, o);
+  o.EndObject();
 }
 
-static void SerializeGltfSampler(const Sampler &sampler, detail::json &o) {
-  if (!sampler.name.empty()) {
-    SerializeStringProperty("name", sampler.name, o);
+static void SerializeGltfSampler(const Sampler &sampler,
+                                 detail::JsonWriter &o) {
+  o.StartObject();
+  if (sampler.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", sampler.extras, o);
   }
   if (sampler.magFilter != -1) {
     SerializeNumberProperty("magFilter", sampler.magFilter, o);
@@ -7452,339 +12896,450 @@ static void SerializeGltfSampler(const Sampler &sampler, detail::json &o) {
   if (sampler.minFilter != -1) {
     SerializeNumberProperty("minFilter", sampler.minFilter, o);
   }
+  if (!sampler.name.empty()) {
+    SerializeStringProperty("name", sampler.name, o);
+  }
   // SerializeNumberProperty("wrapR", sampler.wrapR, o);
   SerializeNumberProperty("wrapS", sampler.wrapS, o);
   SerializeNumberProperty("wrapT", sampler.wrapT, o);
-
-  if (sampler.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", sampler.extras, o);
-  }
+  o.EndObject();
 }
 
 static void SerializeGltfOrthographicCamera(const OrthographicCamera &camera,
-                                            detail::json &o) {
-  SerializeNumberProperty("zfar", camera.zfar, o);
-  SerializeNumberProperty("znear", camera.znear, o);
-  SerializeNumberProperty("xmag", camera.xmag, o);
-  SerializeNumberProperty("ymag", camera.ymag, o);
-
+                                            detail::JsonWriter &o) {
+  o.StartObject();
   if (camera.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", camera.extras, o);
   }
-}
 
-static void SerializeGltfPerspectiveCamera(const PerspectiveCamera &camera,
-                                           detail::json &o) {
+  SerializeNumberProperty("xmag", camera.xmag, o);
+  SerializeNumberProperty("ymag", camera.ymag, o);
   SerializeNumberProperty("zfar", camera.zfar, o);
   SerializeNumberProperty("znear", camera.znear, o);
+  o.EndObject();
+}
+
+static void SerializeGltfPerspectiveCamera(const PerspectiveCamera &camera,
+                                           detail::JsonWriter &o) {
+  o.StartObject();
   if (camera.aspectRatio > 0) {
     SerializeNumberProperty("aspectRatio", camera.aspectRatio, o);
   }
 
+  if (camera.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", camera.extras, o);
+  }
+
   if (camera.yfov > 0) {
     SerializeNumberProperty("yfov", camera.yfov, o);
   }
 
+  SerializeNumberProperty("zfar", camera.zfar, o);
+  SerializeNumberProperty("znear", camera.znear, o);
+  o.EndObject();
+}
+
+static void SerializeGltfCamera(const Camera &camera, detail::JsonWriter &o) {
+  o.StartObject();
+  SerializeExtensionMap(camera.extensions, o);
   if (camera.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", camera.extras, o);
   }
-}
 
-static void SerializeGltfCamera(const Camera &camera, detail::json &o) {
-  SerializeStringProperty("type", camera.type, o);
   if (!camera.name.empty()) {
     SerializeStringProperty("name", camera.name, o);
   }
 
   if (camera.type.compare("orthographic") == 0) {
-    detail::json orthographic;
-    SerializeGltfOrthographicCamera(camera.orthographic, orthographic);
-    detail::JsonAddMember(o, "orthographic", std::move(orthographic));
+    o.Key("orthographic");
+    SerializeGltfOrthographicCamera(camera.orthographic, o);
   } else if (camera.type.compare("perspective") == 0) {
-    detail::json perspective;
-    SerializeGltfPerspectiveCamera(camera.perspective, perspective);
-    detail::JsonAddMember(o, "perspective", std::move(perspective));
+    o.Key("perspective");
+    SerializeGltfPerspectiveCamera(camera.perspective, o);
   } else {
     // ???
   }
 
-  if (camera.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", camera.extras, o);
-  }
-  SerializeExtensionMap(camera.extensions, o);
+  SerializeStringProperty("type", camera.type, o);
+  o.EndObject();
 }
 
-static void SerializeGltfScene(const Scene &scene, detail::json &o) {
-  SerializeNumberArrayProperty<int>("nodes", scene.nodes, o);
-
-  if (scene.name.size()) {
-    SerializeStringProperty("name", scene.name, o);
-  }
+static void SerializeGltfScene(const Scene &scene, detail::JsonWriter &o) {
+  o.StartNullableObject();
+  SerializeExtensionMap(scene.extensions, o);
   if (scene.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", scene.extras, o);
   }
-  SerializeExtensionMap(scene.extensions, o);
+  if (scene.name.size()) {
+    SerializeStringProperty("name", scene.name, o);
+  }
+  SerializeNumberArrayProperty<int>("nodes", scene.nodes, o);
+  o.EndObject();
 }
 
-static void SerializeGltfSkin(const Skin &skin, detail::json &o) {
+static void SerializeGltfSkin(const Skin &skin, detail::JsonWriter &o) {
+  o.StartNullableObject();
+  if (skin.inverseBindMatrices >= 0) {
+    SerializeNumberProperty("inverseBindMatrices", skin.inverseBindMatrices, o);
+  }
+
   // required
   SerializeNumberArrayProperty<int>("joints", skin.joints, o);
 
-  if (skin.inverseBindMatrices >= 0) {
-    SerializeNumberProperty("inverseBindMatrices", skin.inverseBindMatrices, o);
+  if (skin.name.size()) {
+    SerializeStringProperty("name", skin.name, o);
   }
 
   if (skin.skeleton >= 0) {
     SerializeNumberProperty("skeleton", skin.skeleton, o);
   }
-
-  if (skin.name.size()) {
-    SerializeStringProperty("name", skin.name, o);
-  }
+  o.EndObject();
 }
 
-static void SerializeGltfTexture(const Texture &texture, detail::json &o) {
+static void SerializeGltfTexture(const Texture &texture,
+                                 detail::JsonWriter &o) {
+  o.StartNullableObject();
+  SerializeExtensionMap(texture.extensions, o);
+  if (texture.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", texture.extras, o);
+  }
+  if (texture.name.size()) {
+    SerializeStringProperty("name", texture.name, o);
+  }
   if (texture.sampler > -1) {
     SerializeNumberProperty("sampler", texture.sampler, o);
   }
   if (texture.source > -1) {
     SerializeNumberProperty("source", texture.source, o);
   }
-  if (texture.name.size()) {
-    SerializeStringProperty("name", texture.name, o);
+  o.EndObject();
+}
+
+// How SerializeGltfModel writes buffers and images.
+struct SerializeOptions {
+  // Write each buffer as a base64 data URI. Otherwise buffer i refers to
+  // `buffer_uris[i]`.
+  bool embed_buffers = true;
+  std::vector<std::string> buffer_uris;
+  // Index of the buffer stored in the BIN chunk of a GLB, or -1.
+  int bin_buffer = -1;
+  // With `merged_buffer_offsets`, buffer i is written at that offset of a
+  // single merged buffer of `merged_buffer_size` bytes (the BIN chunk of
+  // WriteGlbSceneToFile) and the bufferViews are rebased onto buffer 0.
+  const std::vector<size_t> *merged_buffer_offsets = nullptr;
+  uint64_t merged_buffer_size = 0;
+  // Image i is written with the uri `image_uris[i]` (see UpdateImageObject).
+  std::vector<std::string> image_uris;
+  // Large arrays and embedded buffers are written in parallel pieces on
+  // `pool`, if set.
+  ThreadPool *pool = nullptr;
+};
+
+// The only bufferView extension with a buffer reference which a merged GLB
+// rebases. It keeps the compressed data in a buffer of its own.
+static const char kMeshoptCompression[] = "EXT_meshopt_compression";
+
+// True if `value` has a member named "buffer" at any depth.
+static bool HasBufferMemberDeep(const Value &value) {
+  if (value.IsArray()) {
+    for (const Value &element : value.Get<Value::Array>()) {
+      if (HasBufferMemberDeep(element)) return true;
+    }
+  } else if (value.IsObject()) {
+    for (const auto &member : value.Get<Value::Object>()) {
+      if (member.first == "buffer" || HasBufferMemberDeep(member.second)) {
+        return true;
+      }
+    }
   }
-  if (texture.extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", texture.extras, o);
+  return false;
+}
+
+// Checks that the buffer references in the extensions of bufferView `i` can
+// be rebased onto the merged buffer at `offsets`: the EXT_meshopt_compression
+// range has to fit in its buffer, other extensions must not reference any.
+static bool CheckMergedBufferViewExtensions(const Model &model, size_t i,
+                                            const std::vector<size_t> &offsets,
+                                            std::string *err) {
+  const std::string prefix = "bufferView[" + std::to_string(i) + "] ";
+  for (const auto &extension : model.bufferViews[i].extensions) {
+    if (extension.first != kMeshoptCompression) {
+      if (HasBufferMemberDeep(extension.second)) {
+        if (err) {
+          (*err) += prefix + "extension " + extension.first +
+                    " references a buffer, which a merged GLB cannot "
+                    "rebase.\n";
+        }
+        return false;
+      }
+      continue;
+    }
+    const Value &meshopt = extension.second;
+    const bool valid = meshopt.IsObject() && meshopt.Get("buffer").IsInt() &&
+                       meshopt.Get("byteLength").IsNumber();
+    const int buffer = valid ? meshopt.Get("buffer").GetNumberAsInt() : -1;
+    const double offset =
+        valid ? meshopt.Get("byteOffset").GetNumberAsDouble() : 0.0;
+    const double length =
+        valid ? meshopt.Get("byteLength").GetNumberAsDouble() : 0.0;
+    if (buffer < 0 || size_t(buffer) >= model.buffers.size() || offset < 0 ||
+        length < 0 ||
+        offset + length > double(model.buffers[size_t(buffer)].data.size())) {
+      if (err) {
+        (*err) += prefix + kMeshoptCompression +
+                  " range does not fit in its buffer.\n";
+      }
+      return false;
+    }
+    if (double(offsets[size_t(buffer)]) + offset >
+        double(std::numeric_limits<int>::max())) {
+      if (err) {
+        (*err) += prefix + kMeshoptCompression +
+                  " data is past the first 2 GB of the merged buffer.\n";
+      }
+      return false;
+    }
   }
-  SerializeExtensionMap(texture.extensions, o);
+  return true;
 }
 
-///
-/// Serialize all properties except buffers and images.
-///
-static void SerializeGltfModel(const Model *model, detail::json &o) {
-  // ACCESSORS
-  if (model->accessors.size()) {
-    detail::json accessors;
-    detail::JsonReserveArray(accessors, model->accessors.size());
-    for (unsigned int i = 0; i < model->accessors.size(); ++i) {
-      detail::json accessor;
-      SerializeGltfAccessor(model->accessors[i], accessor);
-      detail::JsonPushBack(accessors, std::move(accessor));
+// `view` with its buffer and the buffer of its EXT_meshopt_compression
+// extension rebased onto the merged buffer at `offsets`. The references were
+// checked by CheckMergedBufferViewExtensions().
+static BufferView RebaseMergedBufferView(const BufferView &view,
+                                         const std::vector<size_t> &offsets) {
+  BufferView rebased = view;
+  rebased.byteOffset += offsets[size_t(rebased.buffer)];
+  rebased.buffer = 0;
+  auto meshopt = rebased.extensions.find(kMeshoptCompression);
+  if (meshopt != rebased.extensions.end()) {
+    Value::Object &o = meshopt->second.Get<Value::Object>();
+    const size_t buffer = size_t(o["buffer"].GetNumberAsInt());
+    const double offset = o["byteOffset"].GetNumberAsDouble();
+    o["buffer"] = Value(0);
+    o["byteOffset"] = Value(int(double(offsets[buffer]) + offset));
+  }
+  return rebased;
+}
+
+// Writes `items` with `serialize` into the array open in `o`. With a `pool`,
+// large arrays are written in chunks in parallel, which are spliced in order,
+// so the output is the same as for the sequential write.
+template <typename T, typename Fn>
+static void SerializeArrayElements(const std::vector<T> &items,
+                                   ThreadPool *pool, detail::JsonWriter &o,
+                                   const Fn &serialize) {
+  const size_t kChunkSize = 512;
+
+  const size_t n = items.size();
+  if (!pool || (n <= kChunkSize)) {
+    for (const T &item : items) {
+      serialize(item, o);
+    }
+    return;
+  }
+
+  // The chunks are written in batches, which bounds the text held in memory
+  // and lets `o` flush it to the sink in between.
+  const size_t num_chunks = (n + kChunkSize - 1) / kChunkSize;
+  std::vector<std::string> chunks(
+      std::min(num_chunks, 4 * (size_t(pool->Size()) + 1)));
+  for (size_t first = 0; first < num_chunks; first += chunks.size()) {
+    const size_t count = std::min(chunks.size(), num_chunks - first);
+    pool->ParallelFor(count, [&](size_t c) {
+      chunks[c].clear();
+      detail::JsonWriter writer(&chunks[c], o);
+      const size_t begin = (first + c) * kChunkSize;
+      const size_t end = std::min(n, begin + kChunkSize);
+      for (size_t i = begin; i < end; i++) {
+        serialize(items[i], writer);
+      }
+    });
+    for (size_t c = 0; c < count; c++) {
+      o.SpliceElements(chunks[c]);
     }
-    detail::JsonAddMember(o, "accessors", std::move(accessors));
   }
+}
+
+template <typename T, typename Fn>
+static void SerializeArrayProperty(const char *key, const std::vector<T> &items,
+                                   ThreadPool *pool, detail::JsonWriter &o,
+                                   const Fn &serialize) {
+  if (items.empty()) return;
+
+  o.Key(key);
+  o.StartArray();
+  SerializeArrayElements(items, pool, o, serialize);
+  o.EndArray();
+}
+
+static void SerializeGltfModel(const Model *model,
+                               const SerializeOptions &options,
+                               detail::JsonWriter &o) {
+  o.StartObject();
+  // ACCESSORS
+  SerializeArrayProperty("accessors", model->accessors, options.pool, o,
+                         SerializeGltfAccessor);
 
   // ANIMATIONS
   if (model->animations.size()) {
-    detail::json animations;
-    detail::JsonReserveArray(animations, model->animations.size());
-    for (unsigned int i = 0; i < model->animations.size(); ++i) {
-      if (model->animations[i].channels.size()) {
-        detail::json animation;
-        SerializeGltfAnimation(model->animations[i], animation);
-        detail::JsonPushBack(animations, std::move(animation));
-      }
+    // Animations without channels are left out, which leaves a null array
+    // when none has any.
+    bool has_channels = false;
+    for (const Animation &animation : model->animations) {
+      has_channels = has_channels || animation.channels.size();
+    }
+    o.Key("animations");
+    if (has_channels) {
+      o.StartArray();
+      SerializeArrayElements(
+          model->animations, options.pool, o,
+          [](const Animation &animation, detail::JsonWriter &w) {
+            if (animation.channels.size()) {
+              SerializeGltfAnimation(animation, w);
+            }
+          });
+      o.EndArray();
+    } else {
+      o.Null();
     }
-
-    detail::JsonAddMember(o, "animations", std::move(animations));
   }
 
   // ASSET
-  detail::json asset;
-  SerializeGltfAsset(model->asset, asset);
-  detail::JsonAddMember(o, "asset", std::move(asset));
+  o.Key("asset");
+  SerializeGltfAsset(model->asset, o);
 
   // BUFFERVIEWS
-  if (model->bufferViews.size()) {
-    detail::json bufferViews;
-    detail::JsonReserveArray(bufferViews, model->bufferViews.size());
-    for (unsigned int i = 0; i < model->bufferViews.size(); ++i) {
-      detail::json bufferView;
-      SerializeGltfBufferView(model->bufferViews[i], bufferView);
-      detail::JsonPushBack(bufferViews, std::move(bufferView));
+  if (options.merged_buffer_offsets) {
+    SerializeArrayProperty(
+        "bufferViews", model->bufferViews, options.pool, o,
+        [&](const BufferView &view, detail::JsonWriter &w) {
+          SerializeGltfBufferView(
+              RebaseMergedBufferView(view, *options.merged_buffer_offsets),
+              w);
+        });
+  } else {
+    SerializeArrayProperty("bufferViews", model->bufferViews, options.pool, o,
+                           SerializeGltfBufferView);
+  }
+
+  // BUFFERS
+  if (options.merged_buffer_offsets) {
+    if (options.merged_buffer_size > 0) {
+      o.Key("buffers");
+      o.StartArray();
+      o.StartObject();
+      SerializeNumberProperty("byteLength", options.merged_buffer_size, o);
+      o.EndObject();
+      o.EndArray();
+    }
+  } else if (model->buffers.size()) {
+    o.Key("buffers");
+    o.StartArray();
+    for (size_t i = 0; i < model->buffers.size(); ++i) {
+      if (int(i) == options.bin_buffer) {
+        SerializeGltfBufferBin(model->buffers[i], o);
+      } else if (options.embed_buffers) {
+        SerializeGltfBuffer(model->buffers[i], options.pool, o);
+      } else {
+        SerializeGltfBuffer(model->buffers[i], o, options.buffer_uris[i]);
+      }
     }
-    detail::JsonAddMember(o, "bufferViews", std::move(bufferViews));
+    o.EndArray();
   }
 
+  // CAMERAS
+  SerializeArrayProperty("cameras", model->cameras, options.pool, o,
+                         SerializeGltfCamera);
+
+  // EXTENSIONS, with LIGHTS as KHR_lights_punctual
+  SerializeExtensionMap(model->extensions, o,
+                        model->lights.size() ? &model->lights : nullptr);
+
   // Extensions required
   if (model->extensionsRequired.size()) {
     SerializeStringArrayProperty("extensionsRequired",
                                  model->extensionsRequired, o);
   }
 
-  // MATERIALS
-  if (model->materials.size()) {
-    detail::json materials;
-    detail::JsonReserveArray(materials, model->materials.size());
-    for (unsigned int i = 0; i < model->materials.size(); ++i) {
-      detail::json material;
-      SerializeGltfMaterial(model->materials[i], material);
-
-      if (detail::JsonIsNull(material)) {
-        // Issue 294.
-        // `material` does not have any required parameters
-        // so the result may be null(unmodified) when all material parameters
-        // have default value.
-        //
-        // null is not allowed thus we create an empty JSON object.
-        detail::JsonSetObject(material);
-      }
-      detail::JsonPushBack(materials, std::move(material));
+  // Extensions used
+  auto extensionsUsed = model->extensionsUsed;
+  if (model->lights.size()) {
+    // Also add "KHR_lights_punctual" to `extensionsUsed`
+    if (std::find(extensionsUsed.begin(), extensionsUsed.end(),
+                  kKhrLightsPunctual) == extensionsUsed.end()) {
+      extensionsUsed.push_back(kKhrLightsPunctual);
     }
-    detail::JsonAddMember(o, "materials", std::move(materials));
+  }
+  if (extensionsUsed.size()) {
+    SerializeStringArrayProperty("extensionsUsed", extensionsUsed, o);
   }
 
-  // MESHES
-  if (model->meshes.size()) {
-    detail::json meshes;
-    detail::JsonReserveArray(meshes, model->meshes.size());
-    for (unsigned int i = 0; i < model->meshes.size(); ++i) {
-      detail::json mesh;
-      SerializeGltfMesh(model->meshes[i], mesh);
-      detail::JsonPushBack(meshes, std::move(mesh));
-    }
-    detail::JsonAddMember(o, "meshes", std::move(meshes));
+  // EXTRAS
+  if (model->extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", model->extras, o);
   }
 
-  // NODES
-  if (model->nodes.size()) {
-    detail::json nodes;
-    detail::JsonReserveArray(nodes, model->nodes.size());
-    for (unsigned int i = 0; i < model->nodes.size(); ++i) {
-      detail::json node;
-      SerializeGltfNode(model->nodes[i], node);
-      detail::JsonPushBack(nodes, std::move(node));
+  // IMAGES
+  if (model->images.size()) {
+    o.Key("images");
+    o.StartArray();
+    for (size_t i = 0; i < model->images.size(); ++i) {
+      SerializeGltfImage(model->images[i], options.image_uris[i], o);
     }
-    detail::JsonAddMember(o, "nodes", std::move(nodes));
+    o.EndArray();
   }
 
+  // MATERIALS
+  SerializeArrayProperty("materials", model->materials, options.pool, o,
+                         SerializeGltfMaterial);
+
+  // MESHES
+  SerializeArrayProperty("meshes", model->meshes, options.pool, o,
+                         SerializeGltfMesh);
+
+  // NODES
+  SerializeArrayProperty("nodes", model->nodes, options.pool, o,
+                         SerializeGltfNode);
+
+  // SAMPLERS
+  SerializeArrayProperty("samplers", model->samplers, options.pool, o,
+                         SerializeGltfSampler);
+
   // SCENE
   if (model->defaultScene > -1) {
     SerializeNumberProperty<int>("scene", model->defaultScene, o);
   }
 
   // SCENES
-  if (model->scenes.size()) {
-    detail::json scenes;
-    detail::JsonReserveArray(scenes, model->scenes.size());
-    for (unsigned int i = 0; i < model->scenes.size(); ++i) {
-      detail::json currentScene;
-      SerializeGltfScene(model->scenes[i], currentScene);
-      detail::JsonPushBack(scenes, std::move(currentScene));
-    }
-    detail::JsonAddMember(o, "scenes", std::move(scenes));
-  }
+  SerializeArrayProperty("scenes", model->scenes, options.pool, o,
+                         SerializeGltfScene);
 
   // SKINS
-  if (model->skins.size()) {
-    detail::json skins;
-    detail::JsonReserveArray(skins, model->skins.size());
-    for (unsigned int i = 0; i < model->skins.size(); ++i) {
-      detail::json skin;
-      SerializeGltfSkin(model->skins[i], skin);
-      detail::JsonPushBack(skins, std::move(skin));
-    }
-    detail::JsonAddMember(o, "skins", std::move(skins));
-  }
+  SerializeArrayProperty("skins", model->skins, options.pool, o,
+                         SerializeGltfSkin);
 
   // TEXTURES
-  if (model->textures.size()) {
-    detail::json textures;
-    detail::JsonReserveArray(textures, model->textures.size());
-    for (unsigned int i = 0; i < model->textures.size(); ++i) {
-      detail::json texture;
-      SerializeGltfTexture(model->textures[i], texture);
-      detail::JsonPushBack(textures, std::move(texture));
-    }
-    detail::JsonAddMember(o, "textures", std::move(textures));
-  }
-
-  // SAMPLERS
-  if (model->samplers.size()) {
-    detail::json samplers;
-    detail::JsonReserveArray(samplers, model->samplers.size());
-    for (unsigned int i = 0; i < model->samplers.size(); ++i) {
-      detail::json sampler;
-      SerializeGltfSampler(model->samplers[i], sampler);
-      detail::JsonPushBack(samplers, std::move(sampler));
-    }
-    detail::JsonAddMember(o, "samplers", std::move(samplers));
-  }
-
-  // CAMERAS
-  if (model->cameras.size()) {
-    detail::json cameras;
-    detail::JsonReserveArray(cameras, model->cameras.size());
-    for (unsigned int i = 0; i < model->cameras.size(); ++i) {
-      detail::json camera;
-      SerializeGltfCamera(model->cameras[i], camera);
-      detail::JsonPushBack(cameras, std::move(camera));
-    }
-    detail::JsonAddMember(o, "cameras", std::move(cameras));
-  }
-
-  // EXTENSIONS
-  SerializeExtensionMap(model->extensions, o);
-
-  auto extensionsUsed = model->extensionsUsed;
-
-  // LIGHTS as KHR_lights_punctual
-  if (model->lights.size()) {
-    detail::json lights;
-    detail::JsonReserveArray(lights, model->lights.size());
-    for (unsigned int i = 0; i < model->lights.size(); ++i) {
-      detail::json light;
-      SerializeGltfLight(model->lights[i], light);
-      detail::JsonPushBack(lights, std::move(light));
-    }
-    detail::json khr_lights_cmn;
-    detail::JsonAddMember(khr_lights_cmn, "lights", std::move(lights));
-    detail::json ext_j;
-
-    {
-      detail::json_const_iterator it;
-      if (detail::FindMember(o, "extensions", it)) {
-        detail::JsonAssign(ext_j, detail::GetValue(it));
-      }
-    }
-
-    detail::JsonAddMember(ext_j, "KHR_lights_punctual", std::move(khr_lights_cmn));
-
-    detail::JsonAddMember(o, "extensions", std::move(ext_j));
-
-    // Also add "KHR_lights_punctual" to `extensionsUsed`
-    {
-      auto has_khr_lights_punctual =
-          std::find_if(extensionsUsed.begin(), extensionsUsed.end(),
-                       [](const std::string &s) {
-                         return (s.compare("KHR_lights_punctual") == 0);
-                       });
-
-      if (has_khr_lights_punctual == extensionsUsed.end()) {
-        extensionsUsed.push_back("KHR_lights_punctual");
-      }
-    }
-  }
-
-  // Extensions used
-  if (extensionsUsed.size()) {
-    SerializeStringArrayProperty("extensionsUsed", extensionsUsed, o);
-  }
-
-  // EXTRAS
-  if (model->extras.Type() != NULL_TYPE) {
-    SerializeValue("extras", model->extras, o);
-  }
+  SerializeArrayProperty("textures", model->textures, options.pool, o,
+                         SerializeGltfTexture);
+  o.EndObject();
 }
 
-static bool WriteGltfStream(std::ostream &stream, const std::string &content) {
-  stream << content << std::endl;
-  return stream.good();
+static bool WriteGltfStream(std::ostream &stream, const Model *model,
+                            const SerializeOptions &options, int indent) {
+  bool ok;
+  {
+    detail::JsonWriter writer(&stream, indent);
+    SerializeGltfModel(model, options, writer);
+    writer.Raw("\n", 1);
+    ok = writer.Flush();
+  }
+  stream.flush();
+  return ok && stream.good();
 }
 
-static bool WriteGltfFile(const std::string &output,
-                          const std::string &content) {
+static bool WriteGltfFile(const std::string &output, const Model *model,
+                          const SerializeOptions &options, int indent) {
 #ifdef _WIN32
 #if defined(_MSC_VER)
   std::ofstream gltfFile(UTF8ToWchar(output).c_str());
@@ -7799,16 +13354,28 @@ static bool WriteGltfFile(const std::string &output,
   std::ofstream gltfFile(output.c_str());
   if (!gltfFile.is_open()) return false;
 #endif
-#else
+  return WriteGltfStream(gltfFile, model, options, indent);
+#elif defined(TINYGLTF_NO_FS)
   std::ofstream gltfFile(output.c_str());
   if (!gltfFile.is_open()) return false;
+  return WriteGltfStream(gltfFile, model, options, indent);
+#else
+  int fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) return false;
+  bool ok;
+  {
+    detail::JsonWriter writer(fd, indent);
+    SerializeGltfModel(model, options, writer);
+    writer.Raw("\n", 1);
+    ok = writer.Flush();
+  }
+  return (close(fd) == 0) && ok;
 #endif
-  return WriteGltfStream(gltfFile, content);
 }
 
 static bool WriteBinaryGltfStream(std::ostream &stream,
                                   const std::string &content,
-                                  const std::vector<unsigned char> &binBuffer) {
+                                  const SharedBytes &binBuffer) {
   const std::string header = "glTF";
   const int version = 2;
 
@@ -7869,7 +13436,7 @@ static bool WriteBinaryGltfStream(std::ostream &stream,
 
 static bool WriteBinaryGltfFile(const std::string &output,
                                 const std::string &content,
-                                const std::vector<unsigned char> &binBuffer) {
+                                const SharedBytes &binBuffer) {
 #ifdef _WIN32
 #if defined(_MSC_VER)
   std::ofstream gltfFile(UTF8ToWchar(output).c_str(), std::ios::binary);
@@ -7891,55 +13458,38 @@ static bool WriteBinaryGltfFile(const std::string &output,
 bool TinyGLTF::WriteGltfSceneToStream(const Model *model, std::ostream &stream,
                                       bool prettyPrint = true,
                                       bool writeBinary = false) {
-  detail::JsonDocument output;
-
-  /// Serialize all properties except buffers and images.
-  SerializeGltfModel(model, output);
-
-  // BUFFERS
-  std::vector<unsigned char> binBuffer;
-  if (model->buffers.size()) {
-    detail::json buffers;
-    detail::JsonReserveArray(buffers, model->buffers.size());
-    for (unsigned int i = 0; i < model->buffers.size(); ++i) {
-      detail::json buffer;
-      if (writeBinary && i == 0 && model->buffers[i].uri.empty()) {
-        SerializeGltfBufferBin(model->buffers[i], buffer, binBuffer);
-      } else {
-        SerializeGltfBuffer(model->buffers[i], buffer);
-      }
-      detail::JsonPushBack(buffers, std::move(buffer));
-    }
-    detail::JsonAddMember(output, "buffers", std::move(buffers));
+  SerializeOptions options;
+  options.pool = parallel_serialization_ ? GetThreadPool() : nullptr;
+  if (writeBinary && model->buffers.size() && model->buffers[0].uri.empty()) {
+    options.bin_buffer = 0;
   }
 
   // IMAGES
-  if (model->images.size()) {
-    detail::json images;
-    detail::JsonReserveArray(images, model->images.size());
-    for (unsigned int i = 0; i < model->images.size(); ++i) {
-      detail::json image;
-
-      std::string dummystring = "";
-      // UpdateImageObject need baseDir but only uses it if embeddedImages is
-      // enabled, since we won't write separate images when writing to a stream
-      // we
-      std::string uri;
-      if (!UpdateImageObject(model->images[i], dummystring, int(i), true,
-                             &uri_cb, &this->WriteImageData,
-                             this->write_image_user_data_, &uri)) {
-        return false;
-      }
-      SerializeGltfImage(model->images[i], uri, image);
-      detail::JsonPushBack(images, std::move(image));
+  options.image_uris.resize(model->images.size());
+  for (unsigned int i = 0; i < model->images.size(); ++i) {
+    std::string dummystring = "";
+    // UpdateImageObject need baseDir but only uses it if embeddedImages is
+    // enabled, since we won't write separate images when writing to a stream
+    // we
+    if (!UpdateImageObject(model->images[i], dummystring, int(i), true,
+                           &uri_cb, &this->WriteImageData,
+                           this->write_image_user_data_,
+                           &options.image_uris[i])) {
+      return false;
     }
-    detail::JsonAddMember(output, "images", std::move(images));
   }
 
   if (writeBinary) {
-    return WriteBinaryGltfStream(stream, detail::JsonToString(output), binBuffer);
+    std::string content;
+    {
+      detail::JsonWriter writer(&content, -1);
+      SerializeGltfModel(model, options, writer);
+    }
+    return WriteBinaryGltfStream(
+        stream, content,
+        options.bin_buffer == 0 ? model->buffers[0].data : SharedBytes());
   } else {
-    return WriteGltfStream(stream, detail::JsonToString(output, prettyPrint ? 2 : -1));
+    return WriteGltfStream(stream, model, options, prettyPrint ? 2 : -1);
   }
 }
 
@@ -7949,7 +13499,6 @@ bool TinyGLTF::WriteGltfSceneToFile(const Model *model,
                                     bool embedBuffers = false,
                                     bool prettyPrint = true,
                                     bool writeBinary = false) {
-  detail::JsonDocument output;
   std::string defaultBinFilename = GetBaseFilename(filename);
   std::string defaultBinFileExt = ".bin";
   std::string::size_type pos =
@@ -7962,91 +13511,306 @@ bool TinyGLTF::WriteGltfSceneToFile(const Model *model,
   if (baseDir.empty()) {
     baseDir = "./";
   }
-  /// Serialize all properties except buffers and images.
-  SerializeGltfModel(model, output);
+
+  SerializeOptions options;
+  options.embed_buffers = embedBuffers;
+  options.pool = parallel_serialization_ ? GetThreadPool() : nullptr;
+  if (writeBinary && model->buffers.size() && model->buffers[0].uri.empty()) {
+    options.bin_buffer = 0;
+  }
 
   // BUFFERS
   std::vector<std::string> usedFilenames;
-  std::vector<unsigned char> binBuffer;
-  if (model->buffers.size()) {
-    detail::json buffers;
-    detail::JsonReserveArray(buffers, model->buffers.size());
-    for (unsigned int i = 0; i < model->buffers.size(); ++i) {
-      detail::json buffer;
-      if (writeBinary && i == 0 && model->buffers[i].uri.empty()) {
-        SerializeGltfBufferBin(model->buffers[i], buffer, binBuffer);
-      } else if (embedBuffers) {
-        SerializeGltfBuffer(model->buffers[i], buffer);
-      } else {
-        std::string binSavePath;
-        std::string binFilename;
-        std::string binUri;
-        if (!model->buffers[i].uri.empty() &&
-            !IsDataURI(model->buffers[i].uri)) {
-          binUri = model->buffers[i].uri;
-          if (!uri_cb.decode(binUri, &binFilename, uri_cb.user_data)) {
-            return false;
-          }
-        } else {
-          binFilename = defaultBinFilename + defaultBinFileExt;
-          bool inUse = true;
-          int numUsed = 0;
-          while (inUse) {
-            inUse = false;
-            for (const std::string &usedName : usedFilenames) {
-              if (binFilename.compare(usedName) != 0) continue;
-              inUse = true;
-              binFilename = defaultBinFilename + std::to_string(numUsed++) +
-                            defaultBinFileExt;
-              break;
-            }
-          }
-
-          if (uri_cb.encode) {
-            if (!uri_cb.encode(binFilename, "buffer", &binUri,
-                               uri_cb.user_data)) {
-              return false;
-            }
-          } else {
-            binUri = binFilename;
-          }
+  options.buffer_uris.resize(model->buffers.size());
+  for (unsigned int i = 0; i < model->buffers.size(); ++i) {
+    if (int(i) == options.bin_buffer || embedBuffers) {
+      continue;
+    }
+    std::string binSavePath;
+    std::string binFilename;
+    std::string &binUri = options.buffer_uris[i];
+    if (!model->buffers[i].uri.empty() && !IsDataURI(model->buffers[i].uri)) {
+      binUri = model->buffers[i].uri;
+      if (!uri_cb.decode(binUri, &binFilename, uri_cb.user_data)) {
+        return false;
+      }
+    } else {
+      binFilename = defaultBinFilename + defaultBinFileExt;
+      bool inUse = true;
+      int numUsed = 0;
+      while (inUse) {
+        inUse = false;
+        for (const std::string &usedName : usedFilenames) {
+          if (binFilename.compare(usedName) != 0) continue;
+          inUse = true;
+          binFilename = defaultBinFilename + std::to_string(numUsed++) +
+                        defaultBinFileExt;
+          break;
         }
-        usedFilenames.push_back(binFilename);
-        binSavePath = JoinPath(baseDir, binFilename);
-        if (!SerializeGltfBuffer(model->buffers[i], buffer, binSavePath,
-                                 binUri)) {
+      }
+
+      if (uri_cb.encode) {
+        if (!uri_cb.encode(binFilename, "buffer", &binUri, uri_cb.user_data)) {
           return false;
         }
+      } else {
+        binUri = binFilename;
       }
-      detail::JsonPushBack(buffers, std::move(buffer));
     }
-    detail::JsonAddMember(output, "buffers", std::move(buffers));
+    usedFilenames.push_back(binFilename);
+    binSavePath = JoinPath(baseDir, binFilename);
+    if (!SerializeGltfBufferData(model->buffers[i].data, binSavePath)) {
+      return false;
+    }
   }
 
   // IMAGES
-  if (model->images.size()) {
-    detail::json images;
-    detail::JsonReserveArray(images, model->images.size());
-    for (unsigned int i = 0; i < model->images.size(); ++i) {
-      detail::json image;
-
-      std::string uri;
-      if (!UpdateImageObject(model->images[i], baseDir, int(i), embedImages,
-                             &uri_cb, &this->WriteImageData,
-                             this->write_image_user_data_, &uri)) {
-        return false;
-      }
-      SerializeGltfImage(model->images[i], uri, image);
-      detail::JsonPushBack(images, std::move(image));
+  options.image_uris.resize(model->images.size());
+  for (unsigned int i = 0; i < model->images.size(); ++i) {
+    if (!UpdateImageObject(model->images[i], baseDir, int(i), embedImages,
+                           &uri_cb, &this->WriteImageData,
+                           this->write_image_user_data_,
+                           &options.image_uris[i])) {
+      return false;
     }
-    detail::JsonAddMember(output, "images", std::move(images));
   }
 
   if (writeBinary) {
-    return WriteBinaryGltfFile(filename, detail::JsonToString(output), binBuffer);
+    std::string content;
+    {
+      detail::JsonWriter writer(&content, -1);
+      SerializeGltfModel(model, options, writer);
+    }
+    return WriteBinaryGltfFile(
+        filename, content,
+        options.bin_buffer == 0 ? model->buffers[0].data : SharedBytes());
   } else {
-    return WriteGltfFile(filename, detail::JsonToString(output, (prettyPrint ? 2 : -1)));
+    return WriteGltfFile(filename, model, options, prettyPrint ? 2 : -1);
+  }
+}
+
+// A GLB file as the byte ranges to write in order. Most of them point into
+// the Model's buffers, the rest into the members below.
+struct TinyGLTF::GlbSegments {
+  struct Segment {
+    const unsigned char *data;
+    size_t size;
+  };
+
+  std::string json;
+  unsigned char header[20];
+  unsigned char bin_header[8];
+  std::vector<Segment> segments;
+
+  void Add(const void *data, size_t size) {
+    if (size > 0) {
+      segments.push_back({static_cast<const unsigned char *>(data), size});
+    }
+  }
+};
+
+static void PutU32(unsigned char *dst, unsigned int value) {
+  swap4(&value);
+  memcpy(dst, &value, 4);
+}
+
+bool TinyGLTF::BuildMergedGlb(const Model *model, GlbSegments *glb,
+                              std::string *err) {
+  static const unsigned char kZeros[4] = {0, 0, 0, 0};
+  static const char kSpaces[4] = {' ', ' ', ' ', ' '};
+
+  // Buffers follow each other at 4 byte aligned offsets, which keeps the
+  // alignment of every accessor.
+  std::vector<size_t> offsets(model->buffers.size());
+  uint64_t bin_size = 0;
+  for (size_t i = 0; i < model->buffers.size(); i++) {
+    bin_size = (bin_size + 3) & ~uint64_t(3);
+    offsets[i] = size_t(bin_size);
+    bin_size += model->buffers[i].data.size();
+  }
+  for (size_t i = 0; i < model->bufferViews.size(); i++) {
+    const BufferView &view = model->bufferViews[i];
+    if (view.buffer < 0 || size_t(view.buffer) >= model->buffers.size() ||
+        view.byteOffset + view.byteLength >
+            model->buffers[size_t(view.buffer)].data.size()) {
+      if (err) {
+        (*err) += "bufferView[" + std::to_string(i) +
+                  "] does not fit in its buffer.\n";
+      }
+      return false;
+    }
+    if (!CheckMergedBufferViewExtensions(*model, i, offsets, err)) {
+      return false;
+    }
+  }
+
+  SerializeOptions options;
+  options.merged_buffer_offsets = &offsets;
+  options.merged_buffer_size = bin_size;
+  options.pool = parallel_serialization_ ? GetThreadPool() : nullptr;
+  options.image_uris.resize(model->images.size());
+  for (unsigned int i = 0; i < model->images.size(); ++i) {
+    std::string dummystring = "";
+    if (!UpdateImageObject(model->images[i], dummystring, int(i), true,
+                           &uri_cb, &this->WriteImageData,
+                           this->write_image_user_data_,
+                           &options.image_uris[i])) {
+      if (err) {
+        (*err) += "Failed to embed image[" + std::to_string(i) + "].\n";
+      }
+      return false;
+    }
+  }
+
+  {
+    detail::JsonWriter writer(&glb->json, -1);
+    SerializeGltfModel(model, options, writer);
+  }
+  const uint64_t json_size = glb->json.size();
+  const uint64_t json_padded = (json_size + 3) & ~uint64_t(3);
+  const uint64_t bin_padded = (bin_size + 3) & ~uint64_t(3);
+  const uint64_t length =
+      20 + json_padded + (bin_size > 0 ? 8 + bin_padded : 0);
+  if (length > std::numeric_limits<uint32_t>::max()) {
+    if (err) {
+      (*err) += "GLB data exceeds 4GB.\n";
+    }
+    return false;
+  }
+
+  memcpy(glb->header, "glTF", 4);
+  PutU32(glb->header + 4, 2);
+  PutU32(glb->header + 8, static_cast<unsigned int>(length));
+  PutU32(glb->header + 12, static_cast<unsigned int>(json_padded));
+  PutU32(glb->header + 16, 0x4E4F534A);  // JSON
+  glb->segments.clear();
+  glb->Add(glb->header, sizeof(glb->header));
+  glb->Add(glb->json.data(), glb->json.size());
+  glb->Add(kSpaces, size_t(json_padded - json_size));
+
+  if (bin_size > 0) {
+    PutU32(glb->bin_header, static_cast<unsigned int>(bin_padded));
+    PutU32(glb->bin_header + 4, 0x004E4942);  // BIN
+    glb->Add(glb->bin_header, sizeof(glb->bin_header));
+    for (size_t i = 0; i < model->buffers.size(); i++) {
+      const SharedBytes &data = model->buffers[i].data;
+      glb->Add(data.data(), data.size());
+      const uint64_t end = offsets[i] + data.size();
+      const uint64_t next =
+          (i + 1 < model->buffers.size()) ? offsets[i + 1] : bin_padded;
+      glb->Add(kZeros, size_t(next - end));
+    }
+  }
+  return true;
+}
+
+bool TinyGLTF::WriteGlbSceneToStream(const Model *model, std::ostream &stream,
+                                     std::string *err) {
+  GlbSegments glb;
+  if (!BuildMergedGlb(model, &glb, err)) {
+    return false;
+  }
+  for (const GlbSegments::Segment &segment : glb.segments) {
+    stream.write(reinterpret_cast<const char *>(segment.data),
+                 std::streamsize(segment.size));
+  }
+  stream.flush();
+  if (!stream.good()) {
+    if (err) {
+      (*err) += "Failed to write the GLB stream.\n";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool TinyGLTF::WriteGlbSceneToFile(const Model *model,
+                                   const std::string &filename,
+                                   std::string *err) {
+#ifdef TINYGLTF_NO_FS
+  (void)model;
+  if (err) {
+    (*err) += "File system access is disabled (TINYGLTF_NO_FS) : " +
+              filename + "\n";
+  }
+  return false;
+#else
+  GlbSegments glb;
+  if (!BuildMergedGlb(model, &glb, err)) {
+    return false;
+  }
+
+  bool ok = true;
+#ifdef _WIN32
+  HANDLE file = CreateFileW(UTF8ToWchar(filename).c_str(), GENERIC_WRITE, 0,
+                            nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (err) {
+      (*err) += "File open error for writing : " + filename + "\n";
+    }
+    return false;
   }
+  for (const GlbSegments::Segment &segment : glb.segments) {
+    const unsigned char *p = segment.data;
+    size_t left = segment.size;
+    while (ok && left > 0) {
+      const DWORD chunk = DWORD(std::min<size_t>(left, 1u << 30));
+      DWORD written = 0;
+      if (!WriteFile(file, p, chunk, &written, nullptr) || written == 0) {
+        ok = false;
+      }
+      p += written;
+      left -= written;
+    }
+  }
+  if (!CloseHandle(file)) ok = false;
+#else
+  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    if (err) {
+      (*err) += "File open error for writing : " + filename + "\n";
+    }
+    return false;
+  }
+  // _XOPEN_IOV_MAX, the smallest IOV_MAX POSIX allows.
+  const int kMaxIov = 16;
+  size_t seg = 0;
+  size_t seg_offset = 0;  // Bytes of segments[seg] already written.
+  while (ok && seg < glb.segments.size()) {
+    struct iovec iov[kMaxIov];
+    int n = 0;
+    for (size_t s = seg; s < glb.segments.size() && n < kMaxIov; s++, n++) {
+      const size_t skip = (s == seg) ? seg_offset : 0;
+      iov[n].iov_base =
+          const_cast<unsigned char *>(glb.segments[s].data + skip);
+      iov[n].iov_len = glb.segments[s].size - skip;
+    }
+    const ssize_t written = writev(fd, iov, n);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      ok = false;
+      break;
+    }
+    size_t left = size_t(written);
+    while (left > 0) {
+      const size_t remaining = glb.segments[seg].size - seg_offset;
+      if (left < remaining) {
+        seg_offset += left;
+        break;
+      }
+      left -= remaining;
+      seg++;
+      seg_offset = 0;
+    }
+  }
+  if (close(fd) != 0) ok = false;
+#endif
+  if (!ok && err) {
+    (*err) += "File write error : " + filename + "\n";
+  }
+  return ok;
+#endif
 }
 
 }  // namespace tinygltf
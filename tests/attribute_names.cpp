@@ -0,0 +1,124 @@
+// Custom attribute names are kept by the AttributeKey itself. Many unique
+// names, including two whose hashes collide, have to stay distinct and
+// round-trip through serialization and loading.
+//
+// Build and run from the repository root:
+//   g++ -std=c++11 -O2 -Ilibs tests/attribute_names.cpp
+//       libs/tinygltf/tinygltf.cpp libs/tinygltf/stb.cpp -lpthread
+//       -o attribute_names
+//   ./attribute_names
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        std::printf("%s\n", what);
+        failures++;
+    }
+}
+
+// Both names have the same 31 bit hash, so their keys only differ by name.
+static const char* kCollidingA = "_A96579";
+static const char* kCollidingB = "_A377234";
+static const int kCustomNames = 5000;
+
+static tinygltf::Accessor MakeAccessor()
+{
+    tinygltf::Accessor accessor;
+    accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+    accessor.count = 1;
+    accessor.type = TINYGLTF_TYPE_VEC3;
+    return accessor;
+}
+
+int main()
+{
+    using tinygltf::AttributeKey;
+
+    const AttributeKey key("_FOO");
+    const AttributeKey copy = key;
+    Check(copy == key && !(copy < key) && !(key < copy), "copy differs");
+    Check(AttributeKey::Find("_FOO") == key, "Find differs from the key");
+    Check(copy.Name() == "_FOO", "custom name lost");
+    Check(key.GetSemantic() == AttributeKey::CUSTOM, "custom key not CUSTOM");
+    Check(AttributeKey("TEXCOORD_1") == AttributeKey(AttributeKey::TEXCOORD, 1),
+          "standard name not parsed");
+    Check(AttributeKey("TEXCOORD_01").GetSemantic() == AttributeKey::CUSTOM,
+          "non-canonical standard name parsed");
+    Check(AttributeKey(kCollidingA).Id() == AttributeKey(kCollidingB).Id(),
+          "test names do not collide");
+    Check(AttributeKey(kCollidingA) != AttributeKey(kCollidingB),
+          "colliding names compare equal");
+
+    tinygltf::Model model;
+    model.asset.version = "2.0";
+    model.accessors.push_back(MakeAccessor());
+    model.accessors.push_back(MakeAccessor());
+    tinygltf::Primitive primitive;
+    primitive.attributes["POSITION"] = 0;
+    for (int i = 0; i < kCustomNames; ++i)
+        primitive.attributes["_NAME_" + std::to_string(i)] = 0;
+    primitive.attributes[kCollidingA] = 0;
+    primitive.attributes[kCollidingB] = 1;
+    tinygltf::Mesh mesh;
+    mesh.primitives.push_back(primitive);
+    model.meshes.push_back(mesh);
+
+    const tinygltf::AttributeMap& attributes = primitive.attributes;
+    Check(attributes.size() == size_t(kCustomNames) + 3, "names merged");
+    Check(attributes.count(kCollidingA) && attributes.at(kCollidingA) == 0 &&
+              attributes.at(kCollidingB) == 1,
+          "colliding names not told apart");
+    Check(!attributes.count("_MISSING"), "unknown name found");
+
+    tinygltf::TinyGLTF gltf;
+    std::ostringstream stream;
+    if (!gltf.WriteGltfSceneToStream(&model, stream, false, false))
+    {
+        std::printf("writing the glTF failed\n");
+        return 1;
+    }
+    const std::string json = stream.str();
+    tinygltf::Model loaded;
+    std::string err;
+    std::string warn;
+    if (!gltf.LoadASCIIFromString(&loaded, &err, &warn, json.data(),
+                                  static_cast<unsigned int>(json.size()), ""))
+    {
+        std::printf("loading the glTF failed: %s\n", err.c_str());
+        return 1;
+    }
+    Check(loaded.meshes.size() == 1 && loaded.meshes[0].primitives.size() == 1,
+          "mesh lost");
+    if (!failures)
+    {
+        const tinygltf::AttributeMap& reloaded =
+            loaded.meshes[0].primitives[0].attributes;
+        Check(reloaded == attributes, "attributes changed by the round-trip");
+        Check(reloaded.count("_NAME_4999") == 1, "custom name not found");
+        for (const auto& attribute : reloaded)
+        {
+            if (AttributeKey(attribute.first.Name()) != attribute.first)
+            {
+                Check(false, "name does not round-trip through the key");
+                break;
+            }
+        }
+    }
+
+    if (failures)
+    {
+        std::printf("FAILED: %d checks\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
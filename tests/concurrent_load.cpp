@@ -0,0 +1,195 @@
+// Stress test for concurrent loads: several threads share one configured
+// TinyGLTF (with a ThreadPool for image decoding) and load the same assets
+// over and over. Every result has to equal a load made on a single thread.
+//
+// Build and run from the repository root:
+//   g++ -std=c++11 -O2 -Ilibs tests/concurrent_load.cpp
+//       libs/tinygltf/tinygltf.cpp libs/tinygltf/stb.cpp -lpthread
+//       -o concurrent_load
+//   ./concurrent_load [threads, default 8] [loads per thread, default 25]
+//
+// Building with -fsanitize=thread also checks the loads for data races.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+
+enum class SourceType
+{
+    AsciiFile,
+    AsciiString,
+    Binary,
+};
+
+struct Source
+{
+    std::string name;
+    SourceType type;
+    std::string data; // File name for AsciiFile, the asset otherwise
+    tinygltf::Model reference;
+};
+
+static bool Load(tinygltf::TinyGLTF& loader, const Source& source,
+                 tinygltf::Model* model, std::string* err)
+{
+    std::string warn;
+    switch (source.type)
+    {
+    case SourceType::AsciiFile:
+        return loader.LoadASCIIFromFile(model, err, &warn, source.data);
+    case SourceType::AsciiString:
+        return loader.LoadASCIIFromString(
+            model, err, &warn, source.data.data(),
+            static_cast<unsigned int>(source.data.size()), "");
+    case SourceType::Binary:
+        return loader.LoadBinaryFromMemory(
+            model, err, &warn,
+            reinterpret_cast<const unsigned char*>(source.data.data()),
+            static_cast<unsigned int>(source.data.size()));
+    }
+    return false;
+}
+
+// The triangle with a 16x16 PNG texture and some extras, so that the loads
+// decode images and build Value trees too.
+static void AddTexture(tinygltf::Model* model)
+{
+    tinygltf::Image image;
+    image.name = "checker";
+    image.width = 16;
+    image.height = 16;
+    image.component = 4;
+    image.bits = 8;
+    image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+    image.mimeType = "image/png";
+    std::vector<unsigned char> pixels(16 * 16 * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = ((i / 4 + i / 64) % 2) ? 255 : 0;
+    image.image = std::move(pixels);
+    model->images.push_back(image);
+
+    tinygltf::Texture texture;
+    texture.source = static_cast<int>(model->images.size()) - 1;
+    model->textures.push_back(texture);
+
+    tinygltf::Material material;
+    material.name = "checker";
+    material.pbrMetallicRoughness.baseColorTexture.index =
+        static_cast<int>(model->textures.size()) - 1;
+    model->materials.push_back(material);
+    for (tinygltf::Mesh& mesh : model->meshes)
+    {
+        for (tinygltf::Primitive& primitive : mesh.primitives)
+            primitive.material = static_cast<int>(model->materials.size()) - 1;
+    }
+
+    tinygltf::Value::Object extras;
+    extras["author"] = tinygltf::Value(std::string("concurrent_load"));
+    extras["revision"] = tinygltf::Value(3);
+    extras["scale"] = tinygltf::Value(0.25);
+    model->extras = tinygltf::Value(std::move(extras));
+}
+
+static bool MakeSources(const std::string& file, std::vector<Source>* sources)
+{
+    tinygltf::TinyGLTF loader;
+    tinygltf::Model model;
+    std::string err;
+    std::string warn;
+    if (!loader.LoadASCIIFromFile(&model, &err, &warn, file))
+    {
+        std::printf("%s: %s\n", file.c_str(), err.c_str());
+        return false;
+    }
+    sources->push_back({file, SourceType::AsciiFile, file, {}});
+
+    AddTexture(&model);
+    std::ostringstream ascii;
+    if (!loader.WriteGltfSceneToStream(&model, ascii, false, false))
+    {
+        std::printf("writing the textured glTF failed\n");
+        return false;
+    }
+    sources->push_back({"textured.gltf", SourceType::AsciiString, ascii.str(),
+                        {}});
+
+    std::ostringstream binary;
+    if (!loader.WriteGlbSceneToStream(&model, binary, &err))
+    {
+        std::printf("writing the textured GLB failed: %s\n", err.c_str());
+        return false;
+    }
+    sources->push_back({"textured.glb", SourceType::Binary, binary.str(), {}});
+
+    // The references are loaded one after another with a fresh loader.
+    for (Source& source : *sources)
+    {
+        tinygltf::TinyGLTF referenceLoader;
+        if (!Load(referenceLoader, source, &source.reference, &err))
+        {
+            std::printf("%s: %s\n", source.name.c_str(), err.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const int threadCount = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int loadsPerThread = argc > 2 ? std::atoi(argv[2]) : 25;
+
+    std::vector<Source> sources;
+    if (!MakeSources("assets/Triangle.gltf", &sources))
+        return 1;
+
+    tinygltf::ThreadPool pool(4);
+    tinygltf::TinyGLTF loader;
+    loader.SetThreadPool(&pool);
+    loader.SetParallelImageDecoding(true);
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < loadsPerThread; ++i)
+            {
+                const Source& source = sources[(t + i) % sources.size()];
+                tinygltf::Model model;
+                std::string err;
+                if (!Load(loader, source, &model, &err))
+                {
+                    std::printf("thread %d, load %d of %s failed: %s\n", t, i,
+                                source.name.c_str(), err.c_str());
+                    failures++;
+                }
+                else if (!(model == source.reference))
+                {
+                    std::printf("thread %d, load %d of %s differs from the "
+                                "reference\n",
+                                t, i, source.name.c_str());
+                    failures++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const int loads = threadCount * loadsPerThread;
+    if (failures)
+    {
+        std::printf("FAILED: %d of %d loads\n", failures.load(), loads);
+        return 1;
+    }
+    std::printf("OK: %d loads on %d threads matched the references\n", loads,
+                threadCount);
+    return 0;
+}
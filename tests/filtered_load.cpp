@@ -0,0 +1,133 @@
+// Loads with a section skip or a scene filter together with validation on
+// load. The load has to succeed even though the elements it leaves out are
+// default constructed, and accessors referenced only by an extension of a
+// loaded node (EXT_mesh_gpu_instancing) have to be loaded.
+//
+// Build and run from the repository root:
+//   g++ -std=c++11 -O2 -Ilibs tests/filtered_load.cpp
+//       libs/tinygltf/tinygltf.cpp libs/tinygltf/stb.cpp -lpthread
+//       -o filtered_load
+//   ./filtered_load
+
+#include <cstdio>
+#include <string>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+
+// One triangle instanced by EXT_mesh_gpu_instancing, plus an accessor and a
+// bufferView nothing uses. The buffer is 48 zero bytes.
+static const char* kScene = R"({
+  "asset": {"version": "2.0"},
+  "extensionsUsed": ["EXT_mesh_gpu_instancing"],
+  "buffers": [{
+    "byteLength": 48,
+    "uri": "data:application/octet-stream;base64,)"
+                            "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+                            "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+                            R"("
+  }],
+  "bufferViews": [
+    {"buffer": 0, "byteLength": 36},
+    {"buffer": 0, "byteOffset": 36, "byteLength": 12},
+    {"buffer": 0, "byteOffset": 36, "byteLength": 12}
+  ],
+  "accessors": [
+    {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3"},
+    {"bufferView": 1, "componentType": 5126, "count": 1, "type": "VEC3"},
+    {"bufferView": 2, "componentType": 5126, "count": 3, "type": "SCALAR"}
+  ],
+  "meshes": [{"primitives": [{"attributes": {"POSITION": 0}}]}],
+  "nodes": [{
+    "mesh": 0,
+    "extensions": {
+      "EXT_mesh_gpu_instancing": {"attributes": {"TRANSLATION": 1}}
+    }
+  }],
+  "scenes": [{"nodes": [0]}],
+  "scene": 0
+})";
+
+static int failures = 0;
+
+static void Check(bool ok, const char* test, const char* what)
+{
+    if (!ok)
+    {
+        std::printf("%s: %s\n", test, what);
+        failures++;
+    }
+}
+
+static bool Load(const char* test, int sceneFilter, unsigned int skip,
+                 tinygltf::Model* model)
+{
+    tinygltf::TinyGLTF loader;
+    loader.SetValidateOnLoad(true);
+    loader.SetSceneFilter(sceneFilter);
+    loader.SetSkipSections(skip);
+    std::string err;
+    std::string warn;
+    const std::string json = kScene;
+    if (!loader.LoadASCIIFromString(model, &err, &warn, json.data(),
+                                    static_cast<unsigned int>(json.size()), ""))
+    {
+        std::printf("%s: load failed: %s\n", test, err.c_str());
+        failures++;
+        return false;
+    }
+    return true;
+}
+
+// The instancing accessor and its bufferView are loaded, the unused ones are
+// left default constructed.
+static void CheckFiltered(const char* test, int sceneFilter, unsigned int skip,
+                          const tinygltf::Model& reference)
+{
+    tinygltf::Model model;
+    if (!Load(test, sceneFilter, skip, &model))
+        return;
+    Check(model.accessors.size() == 3, test, "accessor count changed");
+    Check(model.bufferViews.size() == 3, test, "bufferView count changed");
+    if (failures)
+        return;
+    Check(model.accessors[0] == reference.accessors[0], test,
+          "POSITION accessor not loaded");
+    Check(model.accessors[1] == reference.accessors[1], test,
+          "instancing accessor not loaded");
+    Check(model.bufferViews[1] == reference.bufferViews[1], test,
+          "instancing bufferView not loaded");
+    Check(model.accessors[2].componentType == -1, test,
+          "unused accessor loaded");
+    Check(model.bufferViews[2].buffer == -1, test, "unused bufferView loaded");
+    Check(!model.nodes[0].extensions.empty(), test, "node extension dropped");
+    Check(model.validated, test, "model not marked as validated");
+}
+
+int main()
+{
+    tinygltf::Model reference;
+    if (!Load("unfiltered", -1, tinygltf::SKIP_NONE, &reference))
+        return 1;
+
+    CheckFiltered("scene filter", 0, tinygltf::SKIP_NONE, reference);
+    CheckFiltered("skip animations", -1, tinygltf::SKIP_ANIMATIONS, reference);
+    CheckFiltered("skip images", -1, tinygltf::SKIP_IMAGES, reference);
+
+    // Without extensions nothing references the instancing accessor.
+    tinygltf::Model model;
+    const char* test = "skip extras and extensions";
+    if (Load(test, -1, tinygltf::SKIP_EXTRAS_AND_EXTENSIONS, &model))
+    {
+        Check(model.nodes[0].extensions.empty(), test, "node extension kept");
+        Check(model.accessors[1].componentType == -1, test,
+              "instancing accessor loaded");
+    }
+
+    if (failures)
+    {
+        std::printf("FAILED: %d checks\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,140 @@
+// WriteGlbSceneToStream merges all buffers into the BIN chunk. The buffer
+// references of EXT_meshopt_compression have to be rebased with the
+// bufferViews, and bufferViews with other extensions referencing a buffer
+// have to be rejected instead of being written with a dangling index.
+//
+// Build and run from the repository root:
+//   g++ -std=c++11 -O2 -Ilibs tests/merged_glb.cpp
+//       libs/tinygltf/tinygltf.cpp libs/tinygltf/stb.cpp -lpthread
+//       -o merged_glb
+//   ./merged_glb
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        std::printf("%s\n", what);
+        failures++;
+    }
+}
+
+static tinygltf::Value MakeObject(const std::string& key, int value)
+{
+    tinygltf::Value::Object o;
+    o[key] = tinygltf::Value(value);
+    return tinygltf::Value(std::move(o));
+}
+
+// Two buffers of 10 and 24 bytes. bufferView 1 has its fallback data in
+// buffer 1 and its compressed data 8 bytes further into the same buffer.
+static tinygltf::Model MakeModel()
+{
+    tinygltf::Model model;
+    model.asset.version = "2.0";
+    model.extensionsUsed.push_back("EXT_meshopt_compression");
+    for (size_t size : {10, 24})
+    {
+        tinygltf::Buffer buffer;
+        buffer.data = std::vector<unsigned char>(size, 7);
+        model.buffers.push_back(buffer);
+    }
+
+    tinygltf::BufferView first;
+    first.buffer = 0;
+    first.byteLength = 10;
+    model.bufferViews.push_back(first);
+
+    tinygltf::BufferView compressed;
+    compressed.buffer = 1;
+    compressed.byteOffset = 4;
+    compressed.byteLength = 4;
+    tinygltf::Value::Object meshopt;
+    meshopt["buffer"] = tinygltf::Value(1);
+    meshopt["byteOffset"] = tinygltf::Value(8);
+    meshopt["byteLength"] = tinygltf::Value(16);
+    meshopt["byteStride"] = tinygltf::Value(4);
+    meshopt["count"] = tinygltf::Value(4);
+    meshopt["mode"] = tinygltf::Value(std::string("ATTRIBUTES"));
+    compressed.extensions["EXT_meshopt_compression"] =
+        tinygltf::Value(std::move(meshopt));
+    model.bufferViews.push_back(compressed);
+    return model;
+}
+
+int main()
+{
+    tinygltf::TinyGLTF gltf;
+    std::string err;
+    std::string warn;
+
+    // Buffer 1 starts at offset 12 of the merged buffer.
+    const tinygltf::Model model = MakeModel();
+    std::ostringstream glb;
+    if (!gltf.WriteGlbSceneToStream(&model, glb, &err))
+    {
+        std::printf("writing the GLB failed: %s\n", err.c_str());
+        return 1;
+    }
+    const std::string bytes = glb.str();
+    tinygltf::Model loaded;
+    if (!gltf.LoadBinaryFromMemory(
+            &loaded, &err, &warn,
+            reinterpret_cast<const unsigned char*>(bytes.data()),
+            static_cast<unsigned int>(bytes.size())))
+    {
+        std::printf("loading the GLB failed: %s\n", err.c_str());
+        return 1;
+    }
+    Check(loaded.buffers.size() == 1, "buffers were not merged");
+    Check(loaded.bufferViews.size() == 2, "bufferView count changed");
+    if (!failures)
+    {
+        const tinygltf::BufferView& view = loaded.bufferViews[1];
+        Check(view.buffer == 0 && view.byteOffset == 16,
+              "bufferView not rebased");
+        const tinygltf::Value& meshopt =
+            view.extensions.at("EXT_meshopt_compression");
+        Check(meshopt.Get("buffer").GetNumberAsInt() == 0,
+              "EXT_meshopt_compression buffer not rebased");
+        Check(meshopt.Get("byteOffset").GetNumberAsInt() == 20,
+              "EXT_meshopt_compression byteOffset not rebased");
+        Check(meshopt.Get("byteLength").GetNumberAsInt() == 16,
+              "EXT_meshopt_compression byteLength changed");
+    }
+
+    // An extension the writer does not know cannot be rebased.
+    tinygltf::Model unknown = MakeModel();
+    unknown.bufferViews[0].extensions["EXT_unknown"] =
+        MakeObject("buffer", 1);
+    std::ostringstream rejected;
+    err.clear();
+    Check(!gltf.WriteGlbSceneToStream(&unknown, rejected, &err),
+          "bufferView with an unknown buffer reference was written");
+    Check(err.find("EXT_unknown") != std::string::npos,
+          "error does not name the extension");
+
+    // Neither can a compressed range outside of its buffer.
+    tinygltf::Model outside = MakeModel();
+    outside.bufferViews[1]
+        .extensions["EXT_meshopt_compression"]
+        .Get<tinygltf::Value::Object>()["byteLength"] = tinygltf::Value(17);
+    std::ostringstream overflow;
+    Check(!gltf.WriteGlbSceneToStream(&outside, overflow, &err),
+          "EXT_meshopt_compression range past its buffer was written");
+
+    if (failures)
+    {
+        std::printf("FAILED: %d checks\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}
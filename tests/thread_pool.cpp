@@ -0,0 +1,85 @@
+// Exceptions thrown inside ThreadPool::ParallelFor: whichever thread runs the
+// throwing call, ParallelFor has to wait for the other calls and rethrow the
+// exception on the calling thread, also when it is nested in a pool task.
+//
+// Build and run from the repository root:
+//   g++ -std=c++11 -O2 -Ilibs tests/thread_pool.cpp
+//       libs/tinygltf/tinygltf.cpp libs/tinygltf/stb.cpp -lpthread
+//       -o thread_pool
+//   ./thread_pool
+//
+// Building with -fsanitize=thread or -fsanitize=address also checks that no
+// call runs after ParallelFor has returned.
+
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+#include "../libs/tinygltf/tinygltf.hpp"
+
+int main()
+{
+    tinygltf::ThreadPool pool(4);
+    const int rounds = 1000;
+    const size_t items = 100;
+    int failures = 0;
+
+    // The throwing item moves through the range, so that it runs on the
+    // calling thread in some rounds and on a worker in others.
+    for (int round = 0; round < rounds; ++round)
+    {
+        const size_t throwing = size_t(round) % items;
+        std::atomic<int> running{0};
+        bool caught = false;
+        try
+        {
+            pool.ParallelFor(items, [&](size_t i) {
+                running++;
+                std::this_thread::yield();
+                running--;
+                if (i == throwing)
+                    throw std::runtime_error("item failed");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        if (!caught || running != 0)
+        {
+            std::printf("round %d: %s\n", round,
+                        caught ? "calls still running after the rethrow"
+                               : "exception not rethrown");
+            failures++;
+        }
+    }
+
+    bool caught = false;
+    try
+    {
+        pool.ParallelFor(8, [&](size_t) {
+            pool.ParallelFor(8, [](size_t j) {
+                if (j == 3)
+                    throw std::logic_error("nested item failed");
+            });
+        });
+    }
+    catch (const std::logic_error&)
+    {
+        caught = true;
+    }
+    if (!caught)
+    {
+        std::printf("nested: exception not rethrown\n");
+        failures++;
+    }
+
+    if (failures)
+    {
+        std::printf("FAILED: %d checks\n", failures);
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}